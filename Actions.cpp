@@ -21,12 +21,22 @@
 
 #include "Actions.h"
 #include "FastLED_Action.h"
-
-
-#define sp(txt, vlu) Serial.print(txt);Serial.print(vlu);
-#define spl(txt,vlu) Serial.print(txt);Serial.println(vlu)
-
-uint32_t cRgbToUInt(CRGB &rgb){
+#include "Memory.h"
+
+
+// trace on Serial, a print each add, remove and switch is too slow for
+// programs that changes actions all the time
+#ifdef FASTLED_ACTION_TRACE
+# define sp(txt, vlu) Serial.print(txt);Serial.print(vlu);
+# define spl(txt,vlu) Serial.print(txt);Serial.println(vlu)
+# define sl(txt) Serial.println(txt)
+#else
+# define sp(txt, vlu)
+# define spl(txt, vlu)
+# define sl(txt)
+#endif
+
+uint32_t cRgbToUInt(const CRGB &rgb){
   uint32_t col = rgb.r;
   col <<= 8;
   col |= rgb.g;
@@ -37,7 +47,7 @@ uint32_t cRgbToUInt(CRGB &rgb){
 
 
 ActionsContainer::ActionsContainer() :
-  m_currentIdx(0)
+  m_currentIdx(0), m_transitionMs(0)
 {
 }
 
@@ -55,7 +65,8 @@ size_t ActionsContainer::actionsSize() const
 void ActionsContainer::addAction(ActionBase *action)
 {
   m_actions.push(action);
-  Serial.print("add action length:");Serial.println(m_actions.length());
+  MemoryStats::allocated(MemoryStats::Lists, MemoryStats::LIST_NODE);
+  spl("add action length:", m_actions.length());
 }
 
 void ActionsContainer::addAction(ActionBase &action)
@@ -65,16 +76,16 @@ void ActionsContainer::addAction(ActionBase &action)
 
 void ActionsContainer::removeAction(ActionBase *action)
 {
-  Serial.println("remove action");
-  for(uint16_t i = 0; i < m_actions.length(); ++i) {
-    if (m_actions[i] == action) {
-      m_actions.remove(i);
-      if (m_currentIdx == i) {
-        if (m_actions.length() -1 <= i)
-          setCurrentActionIdx(0);
-      } else if (m_currentIdx > i)
-        --m_currentIdx;
-    }
+  sl("remove action");
+  // each occurrence, search starts over as list has changed
+  for(int32_t i = _indexOf(action); i > -1; i = _indexOf(action)) {
+    m_actions.remove(i);
+    MemoryStats::freed(MemoryStats::Lists, MemoryStats::LIST_NODE);
+    if (m_currentIdx == i) {
+      if (m_actions.length() -1 <= (size_t)i)
+        setCurrentActionIdx(0);
+    } else if (m_currentIdx > i)
+      --m_currentIdx;
   }
 }
 
@@ -96,8 +107,8 @@ void ActionsContainer::nextAction()
   if (m_actions.length() == m_currentIdx)
     m_currentIdx = 0;
 
-  Serial.print("next action:");Serial.print(m_currentIdx);
-  Serial.print(" actions.length:");Serial.println(m_actions.length());
+  sp("next action:", m_currentIdx);
+  spl(" actions.length:", m_actions.length());
 }
 
 uint16_t ActionsContainer::currentActionIdx()
@@ -120,6 +131,19 @@ ActionBase* ActionsContainer::currentAction()
   return nullptr; // when empty
 }
 
+int32_t ActionsContainer::_indexOf(ActionBase *action)
+{
+  // walk once, operator [] walks from first each call
+  int32_t idx = 0;
+  for(ActionBase *act = m_actions.first(); m_actions.canMove();
+      act = m_actions.next(), ++idx)
+  {
+    if (act == action)
+      return idx;
+  }
+  return -1;
+}
+
 
 // -------------------------------------------------------
 
@@ -127,6 +151,7 @@ ActionBase::ActionBase(uint32_t duration) :
   m_singleShot(false), m_endTime(0),
   m_nextIterTime(0),
   m_duration(duration), m_updateTime(DefaultTickMs),
+  m_transitionMs(OWNER_TRANSITION),
   m_eventCB(nullptr)
 {
 }
@@ -148,6 +173,18 @@ uint16_t ActionBase::tickCount() const
   return (millis() - startTime()) / m_updateTime;
 }
 
+fract8 ActionBase::progress() const
+{
+  if (m_duration == 0 || m_endTime == 0)
+    return 0;
+  uint32_t elapsed = millis() - startTime();
+  if (elapsed >= m_duration)
+    return 255;
+  if (elapsed < 0x01000000) // elapsed * 255 fits
+    return (elapsed * 255) / m_duration;
+  return elapsed / (m_duration / 255);
+}
+
 bool ActionBase::isRunning() const
 {
   return m_endTime > 0;
@@ -161,7 +198,7 @@ bool ActionBase::isFinished() const
 
 void ActionBase::reset()
 {
-  Serial.println("reset");
+  sl("reset");
   m_endTime = m_nextIterTime = 0;
 }
 
@@ -184,7 +221,7 @@ void ActionBase::loop(SegmentCommon *owner)
     reset();
 
     if (m_singleShot) {
-      Serial.println("remove");
+      sl("remove");
       owner->removeAction(this); // caution, deletes this,
                                   // no code execution after this line
     } else
@@ -192,6 +229,12 @@ void ActionBase::loop(SegmentCommon *owner)
   }
 }
 
+void ActionBase::scheduleIn(SegmentCommon *owner, uint32_t ms)
+{
+  uint8_t frameMs = owner->engine()->frameTime();
+  m_nextIterTime = millis() + (ms > frameMs ? ms : frameMs);
+}
+
 void ActionBase::eventDelegate(SegmentCommon *owner, EvtType evtType)
 {
   if(m_eventCB)
@@ -202,56 +245,88 @@ void ActionBase::eventDelegate(SegmentCommon *owner, EvtType evtType)
 
 // --------------------------------------------------
 
-ActionWait::ActionWait(uint32_t duration) :
-    ActionBase(duration)
+static void fillRun(const LedRun &run, uint16_t logicalIdx, void *ctx)
 {
+  (void)logicalIdx;
+  run.fill(*static_cast<const CRGB*>(ctx));
 }
 
-ActionWait::~ActionWait()
+void TweenColor::begin(SegmentCommon *owner)
+{
+  if (m_fromCurrent && owner->size() > 0)
+    m_from = *(*owner)[0];
+  m_emitted.invalidate();
+}
+
+void TweenColor::apply(SegmentCommon *owner, fract8 progress)
+{
+  CRGB rgb = blend(m_from, m_to, progress);
+  if (!m_emitted.changed(cRgbToUInt(rgb)))
+    return; // slow fades, same color many ticks in a row
+  owner->forEachRun(fillRun, &rgb);
+  owner->dirty();
+}
+
+void TweenBrightness::begin(SegmentCommon *owner)
+{
+  m_from = owner->brightness();
+}
+
+void TweenBrightness::apply(SegmentCommon *owner, fract8 progress)
 {
+  // only one byte changes, leds are scaled when rendered
+  owner->setBrightness(lerp8by8(m_from, m_to, progress));
 }
 
-// static
-void ActionWait::eventCB(ActionBase *self, SegmentCommon *owner, EvtType evtType)
+static void scaleRun(const LedRun &run, uint16_t logicalIdx, void *ctx)
 {
-  reinterpret_cast<ActionWait*>(self)->onEvent(owner, evtType);
+  (void)logicalIdx;
+  uint8_t scale = *static_cast<const uint8_t*>(ctx);
+  for (uint16_t i = 0; i < run.size; ++i)
+    run[i].nscale8(scale);
 }
 
-void ActionWait::onEvent(SegmentCommon *owner, EvtType evtType)
+void TweenBrightness::end(SegmentCommon *owner, fract8 progress)
 {
-  // do nothing but wait, and that is done in baseclass
-  (void)owner; // squelsh compiler warnings
-  (void)evtType;
+  uint8_t level = lerp8by8(m_from, m_to, progress);
+  if (m_keep || level >= m_from) {
+    owner->setBrightness(level); // kept, or brighter than leds can hold
+    return;
+  }
+  // leds takes the dimmed level, it looks the same with brightness back
+  uint8_t scale = (uint16_t)level * 255 / m_from;
+  owner->forEachRun(scaleRun, &scale);
+  owner->setBrightness(m_from);
+  owner->dirty();
 }
 
 // --------------------------------------------------
 
-ActionColor::ActionColor(CRGB color, uint32_t duration) :
-    ActionBase(duration),
-    m_color(color)
+ActionWait::ActionWait(uint32_t duration) :
+    Action<ActionWait>(duration)
 {
-  m_eventCB = &ActionColor::eventCB;
 }
 
-ActionColor::~ActionColor()
+ActionWait::~ActionWait()
 {
 }
 
-// static
-void ActionColor::eventCB(ActionBase *self, SegmentCommon *owner, EvtType evtType)
+// --------------------------------------------------
+
+ActionColor::ActionColor(CRGB color, uint32_t duration) :
+    Action<ActionColor>(duration),
+    m_color(color)
 {
-  reinterpret_cast<ActionColor*>(self)->onEvent(owner, evtType);
 }
 
-void ActionColor::onEvent(SegmentCommon *owner, EvtType evtType)
+ActionColor::~ActionColor()
 {
-  if (evtType == Start) {
-    for(uint16_t i = 0, end = owner->size(); i < end; ++i) {
-      CRGB *rgb = (*owner)[i];
-      *rgb = m_color;
-    }
-    owner->dirty();
-  }
+}
+
+void ActionColor::onStart(SegmentCommon *owner)
+{
+  owner->forEachRun(fillRun, &m_color);
+  owner->dirty();
 }
 
 // -----------------------------------------------
@@ -267,7 +342,7 @@ ActionDark::~ActionDark()
 
 // -----------------------------------------------
 ActionColorLadder::ActionColorLadder(CRGB leftColor, CRGB rightColor, uint32_t duration) :
-    ActionBase(duration),
+    Action<ActionColorLadder>(duration),
     m_leftColor(leftColor), m_rightColor(rightColor)
 {
 }
@@ -276,42 +351,49 @@ ActionColorLadder::~ActionColorLadder()
 {
 }
 
-// static
-void ActionColorLadder::eventCB(ActionBase *self, SegmentCommon *owner, EvtType evtType)
-{
-  reinterpret_cast<ActionColorLadder*>(self)->onEvent(owner, evtType);
-}
+struct LadderCtx {
+  FastLED_Action *engine;
+  CRGB left, right;
+  uint16_t last; // steps from left to right
+};
 
-void ActionColorLadder::onEvent(SegmentCommon *owner, EvtType evtType)
+static void ladderRun(const LedRun &run, uint16_t logicalIdx, void *ctx)
 {
-  if (evtType == Start) {
-    int16_t diff[] = {
-        m_leftColor.red   - m_rightColor.red,
-        m_leftColor.green - m_rightColor.green,
-        m_leftColor.blue  - m_rightColor.blue
-    };
-
-    uint16_t sz = owner->size();
+  const LadderCtx *ladder = static_cast<const LadderCtx*>(ctx);
+  uint16_t last = ladder->last;
+  for (uint16_t i = 0; i < run.size; ++i) {
+    uint32_t idx = logicalIdx + i;
+    CRGB &rgb = run[i];
     for (uint8_t c = 0; c < 3; ++c) {
-      // iterate for each color
-      float color = (float)diff[c] / (sz-1);
-
-      for(uint16_t i = 0; i < sz; ++i) {
-        float col = m_leftColor.raw[c] - (color * i);
-        CRGB *rgb = (*owner)[i];
-        rgb->raw[c] = round(col);
-      }
+      // rounded, left * (last - idx) + right * idx over last
+      uint32_t sum = (uint32_t)ladder->left.raw[c] * (last - idx) +
+                     (uint32_t)ladder->right.raw[c] * idx;
+      rgb.raw[c] = (sum * 2 + last) / (last * 2);
     }
+  }
+  ladder->engine->setLedControllerHasChanges(run.controller, run.firstLedIdx(),
+                                             run.span());
+}
+
+void ActionColorLadder::onStart(SegmentCommon *owner)
+{
+  uint16_t sz = owner->size();
+  if (sz <= 1) {
+    // no steps on a single led
+    owner->forEachRun(fillRun, &m_leftColor);
     owner->dirty();
+    return;
   }
+  LadderCtx ctx = { owner->engine(), m_leftColor, m_rightColor,
+                    (uint16_t)(sz -1) };
+  owner->forEachRun(ladderRun, &ctx);
 }
 
 
 // -----------------------------------------------
 
 ActionGotoColor::ActionGotoColor(CRGB fromColor, CRGB toColor, uint32_t duration) :
-    ActionBase(duration),
-    m_fromColor(fromColor), m_toColor(toColor)
+    ActionTween<TweenColor>(TweenColor(fromColor, toColor), duration)
 {
 }
 
@@ -319,121 +401,32 @@ ActionGotoColor::~ActionGotoColor()
 {
 }
 
-// static
-void ActionGotoColor::eventCB(ActionBase *self, SegmentCommon *owner, EvtType evtType)
-{
-  reinterpret_cast<ActionGotoColor*>(self)->onEvent(owner, evtType);
-}
-
-void ActionGotoColor::onEvent(SegmentCommon *owner, EvtType evtType)
-{
-  uint8_t r, g, b;
-  switch(evtType) {
-  case Start:
-    r = m_fromColor.red;
-    g = m_fromColor.green;
-    b = m_fromColor.blue;
-    break;
-  case Tick: {
-    // calculate how far away each color is and how much they should change each 70ms
-    int16_t redDiff   = m_fromColor.red - m_toColor.red,
-            greenDiff = m_fromColor.green - m_toColor.green,
-            blueDiff  = m_fromColor.blue  - m_toColor.blue;
-    float iterations = noOfTicks();
-    if (iterations < 1)
-      iterations = 1;
-
-    float incR = (redDiff / iterations),
-            incG = (greenDiff / iterations),
-            incB = (blueDiff / iterations);
-    uint16_t tickCnt = tickCount();
-    r = m_toColor.red - incR * tickCnt;
-    g = m_toColor.green - incG * tickCnt;
-    b = m_toColor.blue - incB * tickCnt;
-
-    //sp("rdiff:", redDiff);sp(" g:", greenDiff);spl(" b:", blueDiff);
-    //sp("incR:", incR);sp(" g:", incG);spl(" b:", incB);
-  }  break;
-  case End:
-    r = m_toColor.red;
-    g = m_toColor.green;
-    b = m_toColor.blue;
-  }
-
-
-  sp("r:", r);sp(" g:", g);spl(" b:", b);
-
-  for(uint16_t i = 0, end = owner->size(); i < end; ++i) {
-    CRGB *rgb = (*owner)[i];
-    rgb->red = r;
-    rgb->green = g;
-    rgb->blue = b;
-  }
-  owner->dirty();
-}
-
 // ----------------------------------------------------------------
 
-ActionFade::ActionFade(uint8_t toBrightness, uint32_t duration) :
-    ActionBase(duration),
-    m_toBrightness(toBrightness)
-{
-  if (m_toBrightness > 100)
-    m_toBrightness = 100;
-}
-
-ActionFade::~ActionFade()
+// 0-100 to 0-255
+static uint8_t percentToBrightness(uint8_t percent)
 {
+  if (percent > 100)
+    percent = 100;
+  return (uint16_t)percent * 255 / 100;
 }
 
-void ActionFade::eventCB(ActionBase *self, SegmentCommon *owner, EvtType evtType)
+ActionFade::ActionFade(uint8_t toBrightness, uint32_t duration,
+                       bool keepBrightness) :
+    ActionTween<TweenBrightness>(
+        TweenBrightness(percentToBrightness(toBrightness), keepBrightness),
+        duration)
 {
-  reinterpret_cast<ActionFade*>(self)->onEvent(owner, evtType);
 }
 
-void ActionFade::onEvent(SegmentCommon *owner, EvtType evtType)
+ActionFade::~ActionFade()
 {
-  uint8_t fadeFactor = 0;
-
-  switch(evtType){
-    case Start:
-      fadeFactor = 0;
-      break;
-    case Tick: {
-      if (tickCount() >= noOfTicks() -1)
-        return;
-      fadeFactor = 255 - m_toBrightness;
-      fadeFactor = (float)fadeFactor / (noOfTicks() - tickCount());
-    } break;
-    case End:
-      fadeFactor = 255 - m_toBrightness;
-      break;
-    default:
-      return; // do nothing
-  }
-
-  //Serial.println(fadeFactor);
-  //bool printed = false;
-  for(uint16_t i = 0, sz = owner->size(); i < sz; ++i) {
-    CRGB *rgb = (*owner)[i];
-    rgb->fadeLightBy(fadeFactor);
-
-
-//    if (!printed) {
-//      Serial.print("r:");Serial.print(rgb->r);
-//      Serial.print(" g:");Serial.print(rgb->g);
-//      Serial.print(" b:");Serial.println(rgb->b);
-//      printed = true;
-//    }
-
-  }
-  owner->dirty();
 }
 
 // ---------------------------------------------------------------
 
 ActionFadeIn::ActionFadeIn(CRGB toColor, uint8_t fromBrightness, uint32_t duration) :
-    ActionBase(duration),
+    Action<ActionFadeIn>(duration),
     m_fromBrightness(fromBrightness),
     m_toColor(toColor)
 {
@@ -445,121 +438,61 @@ ActionFadeIn::~ActionFadeIn()
 {
 }
 
-void ActionFadeIn::eventCB(ActionBase *self, SegmentCommon *owner, EvtType evtType)
+void ActionFadeIn::onStart(SegmentCommon *owner)
 {
-  reinterpret_cast<ActionFadeIn*>(self)->onEvent(owner, evtType);
+  m_emitted.invalidate();
+  _paint(owner, 255 - m_fromBrightness);
 }
 
-void ActionFadeIn::onEvent(SegmentCommon *owner, EvtType evtType)
+void ActionFadeIn::onTick(SegmentCommon *owner)
 {
-  uint16_t fadeFactor = 0;
-
-  switch(evtType){
-    case Start:
-      fadeFactor = 255 - m_fromBrightness;
-      break;
-    case Tick: {
-      if (tickCount() >= noOfTicks() -1)
-        return;
-      fadeFactor = 255 - m_fromBrightness;
-      fadeFactor -= (fadeFactor * tickCount()) / noOfTicks();
-    } break;
-    case End:
-      fadeFactor = 0;
-      break;
-    default:
-      return; // do nothing
-  }
-
-  //Serial.println(fadeFactor);
-  //bool printed = false;
-  for(uint16_t i = 0, sz = owner->size(); i < sz; ++i) {
-    CRGB *rgb = (*owner)[i];
-    *rgb = m_toColor;
-    rgb->fadeLightBy(fadeFactor);
+  if (tickCount() >= noOfTicks() -1)
+    return;
+  uint16_t fadeFactor = 255 - m_fromBrightness;
+  fadeFactor -= (fadeFactor * tickCount()) / noOfTicks();
+  _paint(owner, fadeFactor);
+}
 
-//    if (!printed) {
-//      Serial.print("r:");Serial.print(rgb->r);
-//      Serial.print(" g:");Serial.print(rgb->g);
-//      Serial.print(" b:");Serial.println(rgb->b);
-//      printed = true;
-//    }
+void ActionFadeIn::onEnd(SegmentCommon *owner)
+{
+  _paint(owner, 0);
+}
 
-  }
+void ActionFadeIn::_paint(SegmentCommon *owner, uint8_t fadeFactor)
+{
+  CRGB rgb = m_toColor;
+  rgb.fadeLightBy(fadeFactor);
+  if (!m_emitted.changed(cRgbToUInt(rgb)))
+    return;
+  owner->forEachRun(fillRun, &rgb);
   owner->dirty();
 }
 
 // ----------------------------------------------------------------
 
-ActionEaseInOut::ActionEaseInOut(CRGB toColor, int8_t easeTo, uint16_t duration) :
-    ActionBase(duration),
-    m_toColor(toColor), m_easeFactor(easeTo),
-    m_rDiff(0), m_gDiff(0), m_bDiff(0)
+static EasingCurve quadCurve(int8_t easeTo)
 {
+  if (easeTo > 0)
+    return EaseTable<CurveIn<CurveQuad> >::curve();
+  if (easeTo < 0)
+    return EaseTable<CurveOut<CurveQuad> >::curve();
+  return EaseTable<CurveInOut<CurveQuad> >::curve();
 }
 
-ActionEaseInOut::~ActionEaseInOut()
+ActionEaseInOut::ActionEaseInOut(CRGB toColor, int8_t easeTo, uint16_t duration) :
+    ActionTween<TweenColor, EasingCurve>(TweenColor(toColor), duration,
+                                         quadCurve(easeTo))
 {
 }
 
-void ActionEaseInOut::eventCB(ActionBase *self, SegmentCommon *owner, EvtType evtType)
+ActionEaseInOut::ActionEaseInOut(CRGB toColor, const EasingCurve &curve,
+                                 uint16_t duration) :
+    ActionTween<TweenColor, EasingCurve>(TweenColor(toColor), duration, curve)
 {
-  reinterpret_cast<ActionSnake*>(self)->onEvent(owner, evtType);
 }
 
-void ActionEaseInOut::onEvent(SegmentCommon *owner, EvtType evtType)
+ActionEaseInOut::~ActionEaseInOut()
 {
-  switch(evtType) {
-  case Start:{
-    // get the diff of each color to desired color
-    for (uint16_t i = 0, sz = owner->size(); i < sz; ++i) {
-      CRGB *rgb = (*owner)[i];
-      if (rgb->r > m_toColor.r)
-        m_rDiff = max(rgb->r - m_toColor.r, m_rDiff);
-      else
-        m_rDiff = max(m_toColor.r - rgb->r, m_rDiff);
-
-      if (rgb->g > m_toColor.g)
-        m_gDiff = max(rgb->g - m_toColor.g, m_gDiff);
-      else
-        m_gDiff = max(m_toColor.g - rgb->g, m_gDiff);
-
-      if (rgb->b > m_toColor.b)
-        m_bDiff = max(rgb->b - m_toColor.b, m_bDiff);
-      else
-        m_bDiff = max(m_toColor.b - rgb->b, m_bDiff);
-    }
-    uint16_t ticks = noOfTicks();
-    m_rDiff /= ticks;
-    m_gDiff /= ticks;
-    m_bDiff /= ticks;
-  }  break;
-  case Tick: {
-    float step = (float)m_easeFactor / noOfTicks();
-    uint8_t curI = step * (noOfTicks() - tickCount());
-    uint8_t factor = ease8InOutQuad(curI);
-    sp("curI", curI);spl("factor:", factor);
-    bool printed = false;
-    for (uint16_t i = 0, sz = owner->size(); i < sz; ++i) {
-      CRGB *rgb = (*owner)[i];
-      rgb->r = factor * m_rDiff;
-      rgb->g = factor * m_gDiff;
-      rgb->b = factor * m_bDiff;
-      if (!printed) {
-        Serial.print("r:");Serial.print(rgb->r);
-        Serial.print(" g:");Serial.print(rgb->g);
-        Serial.print(" b:");Serial.println(rgb->b);
-        printed = true;
-      }
-    }
-  } break;
-  case End: // fallthrough
-  default: {
-    for (uint16_t i = 0, sz = owner->size(); i < sz; ++i)
-      *(*owner)[i] = m_toColor;
-  }
-  }
-  owner->dirty();
 }
 
 // ----------------------------------------------------------------
@@ -567,7 +500,7 @@ void ActionEaseInOut::onEvent(SegmentCommon *owner, EvtType evtType)
 ActionSnake::ActionSnake(CRGB baseColor, CRGB snakeColor,
                          bool reversed, bool keepSnakeColor,
                          uint32_t duration):
-    ActionBase(duration),
+    Action<ActionSnake>(duration),
     m_baseColor(baseColor), m_snakeColor(snakeColor),
     m_keepSnakeColor(keepSnakeColor),
     m_reversed(reversed), m_snakeIdx(0)
@@ -578,60 +511,109 @@ ActionSnake::~ActionSnake()
 {
 }
 
-void ActionSnake::eventCB(ActionBase *self, SegmentCommon *owner, EvtType evtType)
+void ActionSnake::onStart(SegmentCommon *owner)
 {
-  reinterpret_cast<ActionSnake*>(self)->onEvent(owner, evtType);
+  uint16_t sz = owner->size();
+  if (sz == 0)
+    return;
+  m_snakeIdx = m_reversed ? sz -1 : 0;
+  _paint(owner, m_snakeIdx);
+  _scheduleNext(owner, sz);
+}
+
+void ActionSnake::onTick(SegmentCommon *owner)
+{
+  uint16_t sz = owner->size(),
+           steps = _steps(sz),
+           idx = m_reversed ? sz -1 - steps : steps;
+  if (sz > 0 && idx != m_snakeIdx) {
+    uint16_t prevIdx = m_snakeIdx;
+    m_snakeIdx = idx;
+    _paint(owner, prevIdx);
+  }
+  _scheduleNext(owner, sz);
 }
 
-void ActionSnake::onEvent(SegmentCommon *owner, EvtType evtType)
+void ActionSnake::onEnd(SegmentCommon *owner)
 {
   uint16_t sz = owner->size();
-
-  switch(evtType) {
-  case Tick:
-    if (m_reversed) {
-      if (m_snakeIdx == 0)
-        return;
-      --m_snakeIdx;
-    } else {
-      if (m_snakeIdx + 1 == sz)
-        return;
-      ++m_snakeIdx;
-    }
-    break;
-  case Start:
-    // we might have more leds than what is possible within duration
-    m_updateTime = m_duration / (sz -1);
-    spl("updTime:", m_updateTime);
-    spl("duration:", m_duration);
-    m_snakeIdx = m_reversed ? owner->size() -1 : 0;
-    break;
-  case End:
-    m_snakeIdx = m_reversed ? 0 : owner->size() -1;
-    break;
-  default:
-    m_snakeIdx = 0;
-    break;
+  if (sz == 0)
+    return;
+  uint16_t prevIdx = m_snakeIdx;
+  m_snakeIdx = m_reversed ? 0 : sz -1;
+  _paint(owner, prevIdx);
+}
+
+uint16_t ActionSnake::_steps(uint16_t sz) const
+{
+  if (sz < 2)
+    return 0;
+  uint16_t last = sz -1, steps;
+  if (m_duration == 0) {
+    // forever, one led each tick
+    steps = m_reversed ? last - m_snakeIdx : m_snakeIdx;
+    return steps < last ? steps +1 : last;
+  }
+  uint32_t elapsed = millis() - startTime();
+  if (elapsed >= m_duration)
+    return last;
+  steps = ((uint64_t)elapsed * last) / m_duration;
+  return steps < last ? steps : last;
+}
+
+void ActionSnake::_scheduleNext(SegmentCommon *owner, uint16_t sz)
+{
+  if (m_duration == 0 || sz < 2)
+    return;
+  // time when snake reaches next led, from start so it doesn't drift
+  uint16_t steps = m_reversed ? sz -1 - m_snakeIdx : m_snakeIdx;
+  uint32_t at = ((uint64_t)(steps +1) * m_duration + sz -2) / (sz -1),
+           elapsed = millis() - startTime();
+  scheduleIn(owner, at > elapsed ? at - elapsed : 0);
+}
+
+struct SnakeCtx {
+  FastLED_Action *engine;
+  CRGB base, snake;
+  uint16_t first, end, // logical range painted
+           snakeIdx;
+  bool keepSnakeColor;
+};
+
+static void snakeRun(const LedRun &run, uint16_t logicalIdx, void *ctx)
+{
+  const SnakeCtx *paint = static_cast<const SnakeCtx*>(ctx);
+  if (paint->end <= logicalIdx || paint->first >= logicalIdx + run.size)
+    return; // run is outside of painted range
+  uint16_t first = paint->first > logicalIdx ? paint->first - logicalIdx : 0,
+           end = paint->end - logicalIdx < run.size ?
+                  paint->end - logicalIdx : run.size;
+  for (uint16_t i = first; i < end; ++i) {
+    uint16_t idx = logicalIdx + i;
+    run[i] = idx == paint->snakeIdx ||
+              (paint->keepSnakeColor && idx >= paint->snakeIdx) ?
+                paint->snake : paint->base;
   }
+  LedRun part = run.slice(first, end - first);
+  paint->engine->setLedControllerHasChanges(part.controller, part.firstLedIdx(),
+                                            part.span());
+}
 
-  uint16_t beginAt = m_keepSnakeColor ? m_snakeIdx :
-                                (m_snakeIdx > 0 ? m_snakeIdx -1 : 0),
-           endAt = sz;
-  int8_t inc = 1;
+void ActionSnake::_paint(SegmentCommon *owner, uint16_t prevIdx)
+{
+  // from led before snake, or from where it was when it passed several
+  uint16_t sz = owner->size();
+  SnakeCtx ctx = { owner->engine(), m_baseColor, m_snakeColor, 0, sz,
+                   m_snakeIdx, m_keepSnakeColor };
   if (m_reversed) {
-    beginAt = m_keepSnakeColor ? m_snakeIdx :
-                                (m_snakeIdx +1 < sz ? m_snakeIdx+1: m_snakeIdx);
-    endAt = 0 -1;
-    inc = -1;
+    ctx.end = 1 + (m_keepSnakeColor ? m_snakeIdx :
+                    (prevIdx > m_snakeIdx ? prevIdx :
+                      (m_snakeIdx +1 < sz ? m_snakeIdx +1 : m_snakeIdx)));
+  } else {
+    ctx.first = m_keepSnakeColor ? m_snakeIdx :
+                 (prevIdx < m_snakeIdx ? prevIdx :
+                   (m_snakeIdx > 0 ? m_snakeIdx -1 : 0));
   }
-  sp("begAt:", beginAt);sp(" endAt:", endAt);spl(" inc:", inc);
-  for(uint16_t i = beginAt; i != endAt; i += inc) {
-    CRGB *rgb = (*owner)[i];
-    if (i == m_snakeIdx || (m_keepSnakeColor && i >= m_snakeIdx))
-      *rgb = m_snakeColor;
-    else
-      *rgb = m_baseColor;
-  }
-  owner->dirty();
+  sp("first:", ctx.first);spl(" end:", ctx.end);
+  owner->forEachRun(snakeRun, &ctx);
 }
-
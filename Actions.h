@@ -23,11 +23,17 @@
 #include <DList.h>
 #include <stdint.h>
 #include <FastLED.h>
+#include "Easing.h"
+
+// building for a desktop host, ie offline tools or tests
+#if !defined(FASTLED_ACTION_HOST) && (defined(__linux__) || defined(__APPLE__))
+# define FASTLED_ACTION_HOST 1
+#endif
 
 class SegmentCommon;
 class ActionBase;
 
-extern uint32_t cRgbToUInt(CRGB &rgb);
+extern uint32_t cRgbToUInt(const CRGB &rgb);
 
 /**
  * @brief: base class for Segment and SegmentCompound
@@ -36,7 +42,10 @@ extern uint32_t cRgbToUInt(CRGB &rgb);
 class ActionsContainer {
 protected:
   DListDynamic<ActionBase*> m_actions;
-  uint16_t m_currentIdx;
+  uint16_t m_currentIdx,
+           m_transitionMs;
+  /// idx of action, -1 if not found
+  int32_t _indexOf(ActionBase *action);
 public:
   explicit ActionsContainer();
   virtual ~ActionsContainer();
@@ -52,6 +61,10 @@ public:
   uint16_t currentActionIdx();
   void setCurrentActionIdx(uint16_t idx);
   ActionBase *currentAction();
+  /// cross fade from last frame of an action into the next one over ms,
+  /// 0 switches at once, actions can override it
+  uint16_t transitionTime() const { return m_transitionMs; }
+  void setTransitionTime(uint16_t ms) { m_transitionMs = ms; }
 };
 
 // ----------------------------------------------------------
@@ -67,10 +80,16 @@ protected:
            m_nextIterTime,
            m_duration;
   static const uint8_t DefaultTickMs;
-  uint16_t m_updateTime;
+  uint16_t m_updateTime,
+           m_transitionMs;
   typedef void (*eventCallback)(ActionBase *self, SegmentCommon *owner, EvtType evtType);
   eventCallback m_eventCB;
 
+  /// next visible change is ms from now, call from onStart or onTick
+  /// to tick then instead of after m_updateTime, never sooner than
+  /// frameTime of owners engine
+  void scheduleIn(SegmentCommon *owner, uint32_t ms);
+
 public:
   /// action takes this long in milliseconds
   /// duration of 0 is a forever action
@@ -91,6 +110,17 @@ public:
   uint32_t noOfTicks() const;
   /// which tick we are currently at
   uint16_t tickCount() const;
+  /// how far action has come in time, 0-255, 0 for forever actions
+  fract8 progress() const;
+  /// when action ticks next time
+  uint32_t nextTickTime() const { return m_nextIterTime; }
+
+  /// transitionTime is the owners
+  static const uint16_t OWNER_TRANSITION = 0xFFFF;
+  /// cross fade into this action over ms when owner switches to it,
+  /// whatever action was before
+  uint16_t transitionTime() const { return m_transitionMs; }
+  void setTransitionTime(uint16_t ms) { m_transitionMs = ms; }
 
   bool isSingleShot() const { return m_singleShot; }
   void setSingleShot(bool singleShot) { m_singleShot = singleShot; }
@@ -109,16 +139,199 @@ private:
 
 // ----------------------------------------------------
 
+/**
+ * @brief: base for actions with statically dispatched events
+ *         Derived implements any of onStart(owner), onTick(owner) and
+ *         onEnd(owner), they are called directly from one event callback
+ *         without virtual lookup or upcast, so they can be inlined
+ *         class ActionX : public Action<ActionX>
+ *         Derived should be friend to Action<Derived> if handlers are private
+ */
+template<class Derived>
+class Action : public ActionBase {
+public:
+  explicit Action(uint32_t duration = 1000) :
+    ActionBase(duration)
+  {
+    m_eventCB = &Action::eventCB;
+  }
+
+  static void eventCB(ActionBase *self, SegmentCommon *owner, EvtType evtType) {
+    Derived *derived = static_cast<Derived*>(self);
+    switch (evtType) {
+    case Start: derived->onStart(owner); break;
+    case Tick:  derived->onTick(owner); break;
+    case End:   derived->onEnd(owner); break;
+    }
+  }
+  // for callers that still goes through onEvent
+  virtual void onEvent(SegmentCommon *owner, EvtType evtType) {
+    eventCB(this, owner, evtType);
+  }
+
+protected:
+  // defaults, Derived hides the ones it needs
+  void onStart(SegmentCommon *owner) { (void)owner; }
+  void onTick(SegmentCommon *owner) { (void)owner; }
+  void onEnd(SegmentCommon *owner) { (void)owner; }
+};
+
+// ----------------------------------------------------
+
+/// last value an action wrote, ie a color from cRgbToUInt, so a tick
+/// that gives the same 8 bit value again can skip write and dirty()
+class LastEmit {
+  uint32_t m_value;
+  bool m_valid;
+public:
+  LastEmit() : m_value(0), m_valid(false) {}
+  /// true and remembers value when it differs from last one
+  bool changed(uint32_t value) {
+    if (m_valid && value == m_value)
+      return false;
+    m_value = value;
+    m_valid = true;
+    return true;
+  }
+  /// next value is always a change, ie when action starts
+  void invalidate() { m_valid = false; }
+};
+
+/// tween all leds from one color to another
+class TweenColor {
+  CRGB m_from, m_to;
+  LastEmit m_emitted;
+  bool m_fromCurrent;
+public:
+  explicit TweenColor(CRGB from, CRGB to) :
+    m_from(from), m_to(to), m_fromCurrent(false)
+  {}
+  /// start from color of first led when action starts
+  explicit TweenColor(CRGB to) :
+    m_from(to), m_to(to), m_fromCurrent(true)
+  {}
+  void begin(SegmentCommon *owner);
+  void apply(SegmentCommon *owner, fract8 progress);
+  /// color at progress, as cRgbToUInt
+  uint32_t value(fract8 progress) const {
+    return cRgbToUInt(blend(m_from, m_to, progress));
+  }
+};
+
+/// tween brightness of owner, leds keeps their colors while it runs
+/// at end a dimmed level is written into the leds and brightness goes
+/// back to where it was, unless keep, then brightness stays
+class TweenBrightness {
+  uint8_t m_from, m_to;
+  bool m_keep;
+public:
+  explicit TweenBrightness(uint8_t to, bool keep = false) :
+    m_from(255), m_to(to), m_keep(keep) {}
+  void begin(SegmentCommon *owner);
+  void apply(SegmentCommon *owner, fract8 progress);
+  void end(SegmentCommon *owner, fract8 progress);
+  uint32_t value(fract8 progress) const { return lerp8by8(m_from, m_to, progress); }
+};
+
+/// what Interp writes at progress, through its uint32_t value(progress)
+/// Interps without one counts every progress step as a change
+template<class Interp>
+inline auto tweenValue(const Interp &interp, fract8 progress, int)
+    -> decltype(interp.value(progress))
+{
+  return interp.value(progress);
+}
+template<class Interp>
+inline uint32_t tweenValue(const Interp &, fract8 progress, long)
+{
+  return progress;
+}
+
+/// Interps end(owner, progress) when it has one, else last apply
+template<class Interp>
+inline auto tweenEnd(Interp &interp, SegmentCommon *owner, fract8 progress, int)
+    -> decltype(interp.end(owner, progress))
+{
+  return interp.end(owner, progress);
+}
+template<class Interp>
+inline void tweenEnd(Interp &interp, SegmentCommon *owner, fract8 progress, long)
+{
+  interp.apply(owner, progress);
+}
+
+/**
+ * @brief: generic time based action
+ *         Interp has begin(owner), called on start, and
+ *         apply(owner, progress), called with eased progress 0-255
+ *         Easing has uint8_t ease(uint8_t progress), ie a EaseTable or a
+ *         EasingCurve chosen at runtime, see Easing.h
+ *         apply is only called when eased progress has changed
+ *         Interp may have uint32_t value(progress), then next tick is
+ *         scheduled when that value changes, so a long fade between close
+ *         colors ticks once per visible step instead of each DefaultTickMs
+ */
+template<class Interp, class Easing = EaseLinear>
+class ActionTween : public Action<ActionTween<Interp, Easing> > {
+  friend class Action<ActionTween<Interp, Easing> >;
+  Interp m_interp;
+  Easing m_easing;
+  uint8_t m_lastProgress;
+
+  void onStart(SegmentCommon *owner) {
+    m_interp.begin(owner);
+    m_lastProgress = m_easing.ease(0);
+    m_interp.apply(owner, m_lastProgress);
+    _scheduleNext(owner);
+  }
+  void onTick(SegmentCommon *owner) {
+    uint8_t progress = m_easing.ease(this->progress());
+    if (progress != m_lastProgress) {
+      m_lastProgress = progress;
+      m_interp.apply(owner, progress);
+    } // else no visible change
+    _scheduleNext(owner);
+  }
+  void _scheduleNext(SegmentCommon *owner) {
+    uint32_t duration = this->duration(),
+             elapsed = millis() - this->startTime();
+    if (duration == 0 || elapsed >= duration)
+      return;
+    // first progress that gives another value
+    uint16_t p = this->progress();
+    uint32_t current = tweenValue(m_interp, m_easing.ease(p), 0);
+    while (++p < 256 && tweenValue(m_interp, m_easing.ease(p), 0) == current)
+      ;
+    // progress() reaches p at this time
+    uint32_t at = duration;
+    if (p < 256)
+      at = duration < 0x01000000 ? (p * duration + 254) / 255 :
+                                   p * (duration / 255);
+    this->scheduleIn(owner, at > elapsed ? at - elapsed : 0);
+  }
+  void onEnd(SegmentCommon *owner) {
+    tweenEnd(m_interp, owner, m_easing.ease(255), 0);
+  }
+
+public:
+  explicit ActionTween(const Interp &interp, uint32_t duration = 1000,
+                       const Easing &easing = Easing()) :
+    Action<ActionTween<Interp, Easing> >(duration),
+    m_interp(interp), m_easing(easing), m_lastProgress(0)
+  {}
+  Interp &interp() { return m_interp; }
+};
+
+// ----------------------------------------------------
+
 /// set all leds to color
-class ActionColor : public ActionBase {
+class ActionColor : public Action<ActionColor> {
+  friend class Action<ActionColor>;
   CRGB m_color;
+  void onStart(SegmentCommon *owner);
 public:
   explicit ActionColor(CRGB color, uint32_t duration = 1000);
   virtual ~ActionColor();
-
-  // workaround as we need to upcast to this class on each event
-  static void eventCB(ActionBase *self, SegmentCommon *owner, EvtType evtType);
-  virtual void onEvent(SegmentCommon *owner, EvtType evtType);
 };
 
 // ----------------------------------------------------
@@ -133,102 +346,98 @@ public:
 // ----------------------------------------------------
 
 /// sets all leds to a increasing color from left to right
-class ActionColorLadder : public ActionBase {
+class ActionColorLadder : public Action<ActionColorLadder> {
+  friend class Action<ActionColorLadder>;
   CRGB m_leftColor, m_rightColor;
+  void onStart(SegmentCommon *owner);
 public:
   explicit ActionColorLadder(CRGB leftColor, CRGB rightColor, uint32_t duration = 1000);
   virtual ~ActionColorLadder();
-
-  // workaround as we need to upcast to this class on each loop
-  static void eventCB(ActionBase *self, SegmentCommon *owner, EvtType evtType);
-  virtual void onEvent(SegmentCommon *owner, EvtType evtType);
 };
 
 // ----------------------------------------------------
 // does nothing but insert a delay in program on this owner.
-class ActionWait : public ActionBase {
+class ActionWait : public Action<ActionWait> {
 public:
   explicit ActionWait(uint32_t duration);
   virtual ~ActionWait();
-
-  // workaround as we need to upcast to this class on each event
-  static void eventCB(ActionBase *self, SegmentCommon *owner, EvtType evtType);
-  virtual void onEvent(SegmentCommon *owner, EvtType evtType);
 };
 
 // ----------------------------------------------------
 
 /// changes all leds from -> to during duration time
-class ActionGotoColor : public ActionBase {
-  CRGB m_fromColor, m_toColor;
+class ActionGotoColor : public ActionTween<TweenColor> {
 public:
   explicit ActionGotoColor(CRGB fromColor, CRGB toColor, uint32_t duration = 1000);
   virtual ~ActionGotoColor();
-
-  // workaround as we need to upcast to this class on each event
-  static void eventCB(ActionBase *self, SegmentCommon *owner, EvtType evtType);
-  virtual void onEvent(SegmentCommon *owner, EvtType evtType);
 };
 
 // -----------------------------------------------------
 
-/// changes all LED in brightness
-class ActionFade : public ActionBase {
-  uint8_t m_toBrightness;
+/// changes brightness of owner, leds keeps their colors while it fades
+/// at end the faded level is written into the leds and owners brightness
+/// is restored, so actions after it are not dimmed
+/// keepBrightness leaves brightness at toBrightness and leds untouched,
+/// then a later fade up restores colors exactly
+class ActionFade : public ActionTween<TweenBrightness> {
 public:
-  explicit ActionFade(uint8_t toBrightness, uint32_t duration = 1000);
+  /// toBrightness is 0-100
+  explicit ActionFade(uint8_t toBrightness, uint32_t duration = 1000,
+                      bool keepBrightness = false);
   virtual ~ActionFade();
-
-  // workaround as we need to upcast to this class on each event
-  static void eventCB(ActionBase *self, SegmentCommon *owner, EvtType evtType);
-  virtual void onEvent(SegmentCommon *owner, EvtType evtType);
 };
 
 // -----------------------------------------------------
 
-class ActionFadeIn : public ActionBase {
+class ActionFadeIn : public Action<ActionFadeIn> {
+  friend class Action<ActionFadeIn>;
   uint8_t m_fromBrightness;
   CRGB m_toColor;
+  LastEmit m_emitted;
+  void onStart(SegmentCommon *owner);
+  void onTick(SegmentCommon *owner);
+  void onEnd(SegmentCommon *owner);
+  void _paint(SegmentCommon *owner, uint8_t fadeFactor);
 public:
   explicit ActionFadeIn(CRGB toColor, uint8_t fromBrightness, uint32_t duration = 1000);
   virtual ~ActionFadeIn();
-
-  // workaround as we need to upcast to this class on each event
-  static void eventCB(ActionBase *self, SegmentCommon *owner, EvtType evtType);
-  virtual void onEvent(SegmentCommon *owner, EvtType evtType);
 };
 
 // -----------------------------------------------------
 
-class ActionEaseInOut : public ActionBase {
-  CRGB m_toColor;
-  uint8_t m_easeFactor, m_rDiff, m_gDiff, m_bDiff;
-
+/// eases all leds from color of first led to toColor
+class ActionEaseInOut : public ActionTween<TweenColor, EasingCurve> {
 public:
+  /// easeTo < 0 eases out, > 0 eases in, 0 both in and out, quad curve
   explicit ActionEaseInOut(CRGB toColor, int8_t easeTo, uint16_t duration = 1000);
+  /// any curve, ie EaseTable<CurveOut<CurveBounce> >::curve()
+  explicit ActionEaseInOut(CRGB toColor, const EasingCurve &curve,
+                           uint16_t duration = 1000);
   ~ActionEaseInOut();
-
-  // workaround as we need to upcast to this class on each event
-  static void eventCB(ActionBase *self, SegmentCommon *owner, EvtType evtType);
-  virtual void onEvent(SegmentCommon *owner, EvtType evtType);
 };
 
 
 // -----------------------------------------------------
 
-class ActionSnake : public ActionBase {
+/// a led moving from one end to the other during duration, it ticks when
+/// snake reaches next led, leds passed between two frames are skipped
+/// forever snakes moves one led each tick
+class ActionSnake : public Action<ActionSnake> {
+  friend class Action<ActionSnake>;
   CRGB m_baseColor, m_snakeColor;
   bool m_keepSnakeColor, m_reversed;
   uint16_t m_snakeIdx;
+  void onStart(SegmentCommon *owner);
+  void onTick(SegmentCommon *owner);
+  void onEnd(SegmentCommon *owner);
+  void _paint(SegmentCommon *owner, uint16_t prevIdx);
+  uint16_t _steps(uint16_t sz) const;
+  void _scheduleNext(SegmentCommon *owner, uint16_t sz);
 public:
   explicit ActionSnake(CRGB baseColor, CRGB snakeColor,
                        bool reversed = false, bool keepSnakeColor = false,
                        uint32_t duration = 1000);
   ~ActionSnake();
-
-  // workaround as we need to upcast to this class on each event
-  static void eventCB(ActionBase *self, SegmentCommon *owner, EvtType evtType);
-  virtual void onEvent(SegmentCommon *owner, EvtType evtType);
 };
 
 
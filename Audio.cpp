@@ -0,0 +1,423 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  Audio.cpp
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#include "Audio.h"
+#include "Memory.h"
+#include <math.h>
+#include <string.h>
+
+uint16_t MemorySampleSource::read(int16_t *samples, uint16_t count)
+{
+  uint16_t got = 0;
+  while (got < count) {
+    if (m_pos >= m_count) {
+      if (!m_loop || m_count == 0)
+        break;
+      m_pos = 0;
+    }
+    uint32_t n = m_count - m_pos;
+    if (n > (uint32_t)(count - got))
+      n = count - got;
+    memcpy(samples + got, m_samples + m_pos, n * sizeof(int16_t));
+    m_pos += n;
+    got += n;
+  }
+  return got;
+}
+
+// ----------------------------------------------------------
+
+#ifdef FASTLED_ACTION_HOST
+
+static inline uint16_t le16(const uint8_t *p)
+{
+  return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t le32(const uint8_t *p)
+{
+  return (uint32_t)le16(p) | ((uint32_t)le16(p +2) << 16);
+}
+
+WavSampleSource::WavSampleSource(const char *path) :
+    m_file(fopen(path, "rb")),
+    m_sampleRate(0), m_channels(1),
+    m_ownsFile(true)
+{
+  if (m_file && !_readHeader()) {
+    fclose(m_file);
+    m_file = nullptr;
+  }
+}
+
+WavSampleSource::WavSampleSource(FILE *stream, uint32_t rawSampleRate) :
+    m_file(stream),
+    m_sampleRate(rawSampleRate), m_channels(1),
+    m_ownsFile(false)
+{
+  if (m_file && rawSampleRate == 0 && !_readHeader())
+    m_file = nullptr;
+}
+
+WavSampleSource::~WavSampleSource()
+{
+  if (m_file && m_ownsFile)
+    fclose(m_file);
+}
+
+bool WavSampleSource::_readHeader()
+{
+  // only reads forward, so a pipe works too
+  uint8_t buf[16];
+  if (fread(buf, 1, 12, m_file) != 12 ||
+      memcmp(buf, "RIFF", 4) != 0 || memcmp(buf +8, "WAVE", 4) != 0)
+  {
+    return false;
+  }
+  bool fmt = false;
+  while (fread(buf, 1, 8, m_file) == 8) {
+    uint32_t size = le32(buf +4);
+    if (memcmp(buf, "data", 4) == 0)
+      return fmt; // size is ignored, streams often has it unset
+    if (memcmp(buf, "fmt ", 4) == 0 && size >= 16) {
+      if (fread(buf, 1, 16, m_file) != 16)
+        return false;
+      if (le16(buf) != 1 || le16(buf +14) != 16 || le16(buf +2) == 0)
+        return false; // only 16 bit PCM
+      m_channels = le16(buf +2);
+      m_sampleRate = le32(buf +4);
+      fmt = true;
+      size -= 16;
+    }
+    for (size += size & 1; size > 0; --size) {
+      if (fgetc(m_file) == EOF)
+        return false;
+    }
+  }
+  return false;
+}
+
+uint16_t WavSampleSource::read(int16_t *samples, uint16_t count)
+{
+  if (!m_file)
+    return 0;
+  uint8_t buf[256];
+  uint16_t frameBytes = m_channels * 2,
+           maxFrames = sizeof(buf) / frameBytes,
+           got = 0;
+  while (got < count) {
+    uint16_t frames = count - got < maxFrames ? count - got : maxFrames;
+    uint16_t n = fread(buf, frameBytes, frames, m_file);
+    for (uint16_t i = 0; i < n; ++i) {
+      int32_t sum = 0;
+      for (uint8_t c = 0; c < m_channels; ++c)
+        sum += (int16_t)le16(buf + i * frameBytes + c * 2);
+      samples[got++] = sum / m_channels;
+    }
+    if (n < frames)
+      break;
+  }
+  return got;
+}
+
+#endif // FASTLED_ACTION_HOST
+
+// ----------------------------------------------------------
+
+static const uint16_t AUDIO_LOG_RANGE = 256; // 16 power octaves, 48 dB
+static const uint16_t AUDIO_MIN_PEAK = 8 * 16; // keeps silence dark
+static const uint8_t AUDIO_BEAT_RISE = 24;    // 1.5 power octave over avg
+
+AudioAnalyzer::AudioAnalyzer(SampleSource &source, uint32_t sampleRate,
+                             uint8_t fftBits, uint8_t bands) :
+    m_source(source),
+    m_ring(nullptr), m_window(nullptr),
+    m_cos(nullptr), m_sin(nullptr),
+    m_re(nullptr), m_im(nullptr),
+    m_sampleRate(sampleRate),
+    m_written(0), m_readPos(0),
+    m_blockCount(0), m_beatCount(0), m_dropped(0),
+    m_fftSize(0),
+    m_peak(AUDIO_MIN_PEAK), m_bassAvg(0),
+    m_fftBits(fftBits < MIN_FFT_BITS ? MIN_FFT_BITS :
+                (fftBits > MAX_FFT_BITS ? MAX_FFT_BITS : fftBits)),
+    m_bandCount(0),
+    m_level(0), m_beatPulse(0), m_refractory(0),
+    m_beat(false),
+    m_realtime(true)
+{
+  m_fftSize = 1 << m_fftBits;
+  uint16_t half = m_fftSize >> 1;
+  m_bandCount = bands < 1 ? 1 : (bands > MAX_BANDS ? MAX_BANDS : bands);
+  if (m_bandCount > (half >> 1))
+    m_bandCount = half >> 1;
+
+  // everything is allocated here, never while running
+  m_ring = memNew<int16_t>(MemoryStats::Audio, m_fftSize << 1);
+  m_window = memNew<int16_t>(MemoryStats::Audio, m_fftSize);
+  m_cos = memNew<int16_t>(MemoryStats::Audio, half);
+  m_sin = memNew<int16_t>(MemoryStats::Audio, half);
+  m_re = memNew<int16_t>(MemoryStats::Audio, m_fftSize);
+  m_im = memNew<int16_t>(MemoryStats::Audio, m_fftSize);
+
+  const float tau = 6.2831853f;
+  for (uint16_t i = 0; i < m_fftSize; ++i)
+    m_window[i] = 16383.5f * (1.0f - cosf(tau * i / m_fftSize));
+  for (uint16_t i = 0; i < half; ++i) {
+    m_cos[i] = 32767.0f * cosf(tau * i / m_fftSize);
+    m_sin[i] = 32767.0f * sinf(tau * i / m_fftSize);
+  }
+
+  // log spaced, skipping DC, at least one bin each
+  m_edges[0] = 1;
+  for (uint8_t b = 1; b < m_bandCount; ++b) {
+    uint16_t edge = powf(half, (float)b / m_bandCount) + 0.5f;
+    uint16_t room = half - (m_bandCount - b);
+    m_edges[b] = edge <= m_edges[b -1] ? m_edges[b -1] +1 : edge;
+    if (m_edges[b] > room)
+      m_edges[b] = room;
+  }
+  m_edges[m_bandCount] = half;
+  memset(m_bands, 0, sizeof(m_bands));
+}
+
+AudioAnalyzer::~AudioAnalyzer()
+{
+  uint16_t half = m_fftSize >> 1;
+  memDelete(MemoryStats::Audio, m_ring, m_fftSize << 1);
+  memDelete(MemoryStats::Audio, m_window, m_fftSize);
+  memDelete(MemoryStats::Audio, m_cos, half);
+  memDelete(MemoryStats::Audio, m_sin, half);
+  memDelete(MemoryStats::Audio, m_re, m_fftSize);
+  memDelete(MemoryStats::Audio, m_im, m_fftSize);
+}
+
+uint32_t AudioAnalyzer::bandFrequency(uint8_t band) const
+{
+  if (band > m_bandCount)
+    band = m_bandCount;
+  return (uint32_t)m_edges[band] * m_sampleRate / m_fftSize;
+}
+
+uint8_t AudioAnalyzer::update(uint8_t maxBlocks)
+{
+  uint16_t hop = m_fftSize >> 1;
+  m_beat = false;
+  _fill();
+
+  if (m_realtime && m_written - m_readPos >= m_fftSize) {
+    // skip what can't be analysed now, keeps latency down
+    uint32_t pending = (m_written - m_readPos - m_fftSize) / hop +1;
+    if (pending > maxBlocks) {
+      m_readPos += (pending - maxBlocks) * hop;
+      m_dropped += pending - maxBlocks;
+    }
+  }
+
+  uint8_t done = 0;
+  while (done < maxBlocks && m_written - m_readPos >= m_fftSize) {
+    _analyse();
+    m_readPos += hop;
+    ++done;
+  }
+  return done;
+}
+
+uint16_t AudioAnalyzer::memoryUsage() const
+{
+  // ring, window, re and im plus half sized twiddles
+  return (uint16_t)m_fftSize * 6 * sizeof(int16_t);
+}
+
+void AudioAnalyzer::_fill()
+{
+  uint16_t cap = m_fftSize << 1,
+           mask = cap -1,
+           hop = m_fftSize >> 1;
+  // looping sources never runs dry
+  uint32_t start = m_written;
+  while (m_written - start < ((uint32_t)cap << 2)) {
+    uint32_t used = m_written - m_readPos;
+    if (used >= cap) {
+      if (!m_realtime)
+        break;
+      m_readPos += hop; // full, oldest block goes
+      ++m_dropped;
+      used -= hop;
+    }
+    uint16_t pos = m_written & mask,
+             n = cap - used;
+    if (n > cap - pos)
+      n = cap - pos;
+    uint16_t got = m_source.read(m_ring + pos, n);
+    m_written += got;
+    if (got < n)
+      break;
+  }
+}
+
+void AudioAnalyzer::_analyse()
+{
+  uint16_t mask = (m_fftSize << 1) -1;
+  for (uint16_t i = 0; i < m_fftSize; ++i) {
+    m_re[i] = ((int32_t)m_ring[(m_readPos + i) & mask] * m_window[i]) >> 15;
+    m_im[i] = 0;
+  }
+  _fft();
+
+  uint16_t logs[MAX_BANDS],
+           top = 0;
+  uint32_t total = 0;
+  for (uint8_t b = 0; b < m_bandCount; ++b) {
+    uint32_t sum = 0;
+    for (uint16_t bin = m_edges[b]; bin < m_edges[b +1]; ++bin) {
+      int32_t re = m_re[bin], im = m_im[bin];
+      uint32_t power = ((uint32_t)(re * re) + (uint32_t)(im * im)) >> 1;
+      sum = sum + power < sum ? 0xFFFFFFFFUL : sum + power;
+    }
+    total = total + sum < total ? 0xFFFFFFFFUL : total + sum;
+    // mean power of each bin, so wide bands doesn't read louder
+    logs[b] = _log2(sum / (m_edges[b +1] - m_edges[b]));
+    if (logs[b] > top)
+      top = logs[b];
+  }
+  uint16_t all = _log2(total / (m_edges[m_bandCount] - m_edges[0]));
+
+  // AGC, loudest band sets 255, falls back slowly
+  if (m_peak > AUDIO_MIN_PEAK)
+    --m_peak;
+  if (top > m_peak)
+    m_peak = top;
+  for (uint8_t b = 0; b < m_bandCount; ++b)
+    m_bands[b] = _scaleLog(logs[b]);
+  m_level = _scaleLog(all);
+
+  // onset when bass rises well over its running average
+  uint8_t bassBands = m_bandCount > 4 ? m_bandCount >> 2 : 1;
+  uint16_t bass = 0;
+  for (uint8_t b = 0; b < bassBands; ++b)
+    if (logs[b] > bass)
+      bass = logs[b];
+  bool onset = bass > m_bassAvg + AUDIO_BEAT_RISE &&
+               bass + AUDIO_LOG_RANGE / 2 > m_peak;
+  m_bassAvg = (int32_t)m_bassAvg + (((int32_t)bass - m_bassAvg) >> 3);
+  m_beatPulse = m_beatPulse > 32 ? m_beatPulse - 32 : 0;
+  if (m_refractory > 0) {
+    --m_refractory;
+  } else if (onset) {
+    m_beat = true;
+    m_beatPulse = 255;
+    ++m_beatCount;
+    // about 100ms before next beat
+    uint32_t blocks = m_sampleRate / 10 / (m_fftSize >> 1);
+    m_refractory = blocks > 255 ? 255 : blocks;
+  }
+  ++m_blockCount;
+}
+
+void AudioAnalyzer::_fft()
+{
+  // radix 2 in place, each stage halves, so output is scaled by 1/N
+  uint16_t n = m_fftSize;
+  for (uint16_t i = 1, j = 0; i < n; ++i) {
+    uint16_t bit = n >> 1;
+    for (; j & bit; bit >>= 1)
+      j ^= bit;
+    j ^= bit;
+    if (i < j) {
+      int16_t t = m_re[i]; m_re[i] = m_re[j]; m_re[j] = t;
+      t = m_im[i]; m_im[i] = m_im[j]; m_im[j] = t;
+    }
+  }
+
+  for (uint16_t len = 2, step = n >> 1; len <= n; len <<= 1, step >>= 1) {
+    uint16_t halfLen = len >> 1;
+    for (uint16_t i = 0; i < n; i += len) {
+      for (uint16_t k = 0; k < halfLen; ++k) {
+        int32_t wr = m_cos[k * step],
+                wi = -m_sin[k * step];
+        uint16_t a = i + k, b = a + halfLen;
+        int32_t tr = (m_re[b] * wr - m_im[b] * wi) >> 15,
+                ti = (m_re[b] * wi + m_im[b] * wr) >> 15;
+        int32_t ar = m_re[a], ai = m_im[a];
+        m_re[b] = (ar - tr) >> 1;
+        m_im[b] = (ai - ti) >> 1;
+        m_re[a] = (ar + tr) >> 1;
+        m_im[a] = (ai + ti) >> 1;
+      }
+    }
+  }
+}
+
+uint8_t AudioAnalyzer::_scaleLog(uint16_t log) const
+{
+  if (log + AUDIO_LOG_RANGE <= m_peak)
+    return 0;
+  uint16_t below = m_peak > log ? m_peak - log : 0;
+  return below >= 255 ? 0 : 255 - below;
+}
+
+// static
+uint16_t AudioAnalyzer::_log2(uint32_t vlu)
+{
+  // 1/16 steps, 0 for 0
+  if (vlu == 0)
+    return 0;
+  uint8_t msb = 31;
+  while (!(vlu & (1UL << msb)))
+    --msb;
+  uint8_t frac = msb >= 4 ? (vlu >> (msb - 4)) & 15 : (vlu << (4 - msb)) & 15;
+  return (uint16_t)(msb +1) * 16 + frac;
+}
+
+// ----------------------------------------------------------
+
+ActionAudio::ActionAudio(AudioAnalyzer &analyzer, Signal signal,
+                         uint8_t band, uint32_t duration) :
+    Action<ActionAudio>(duration),
+    m_analyzer(analyzer),
+    m_cb(nullptr), m_ctx(nullptr),
+    m_signal(signal),
+    m_band(band),
+    m_low(0), m_high(255),
+    m_budget(1),
+    m_value(0)
+{
+  m_updateTime = 16;
+}
+
+ActionAudio::~ActionAudio()
+{
+}
+
+void ActionAudio::onTick(SegmentCommon *owner)
+{
+  if (m_budget > 0)
+    m_analyzer.update(m_budget);
+  uint8_t vlu = m_signal == Level ? m_analyzer.level() :
+                 m_signal == Band ? m_analyzer.band(m_band) :
+                                    m_analyzer.beatPulse();
+  // high below low inverts
+  m_value = m_low + ((int16_t)(m_high - m_low) * vlu) / 255;
+  if (m_cb)
+    m_cb(owner, m_value, m_ctx);
+  else
+    owner->setBrightness(m_value);
+}
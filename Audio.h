@@ -0,0 +1,205 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  Audio.h
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#ifndef AUDIO_H_
+#define AUDIO_H_
+
+#include <stdint.h>
+#include "FastLED_Action.h"
+#include "Actions.h"
+#ifdef FASTLED_ACTION_HOST
+# include <stdio.h>
+#endif
+
+/**
+ * @brief: where the analyzer reads mono 16 bit samples from
+ *         read should not block, return 0 when nothing is ready
+ */
+class SampleSource {
+public:
+  virtual ~SampleSource() {}
+  /// read up to count samples, returns how many read
+  virtual uint16_t read(int16_t *samples, uint16_t count) = 0;
+};
+
+/// samples in RAM, ie tests or a buffer filled by a ADC interrupt
+class MemorySampleSource : public SampleSource {
+  const int16_t *m_samples;
+  uint32_t m_count,
+           m_pos;
+  bool m_loop;
+public:
+  explicit MemorySampleSource(const int16_t *samples, uint32_t count,
+                              bool loop = false) :
+    m_samples(samples), m_count(count), m_pos(0), m_loop(loop)
+  {}
+  uint16_t read(int16_t *samples, uint16_t count);
+  void rewind() { m_pos = 0; }
+};
+
+#ifdef FASTLED_ACTION_HOST
+/// a 16 bit PCM WAV file or pipe on host, channels are mixed to mono
+/// a pipe without header, ie from sox or ffmpeg, is raw s16le mono at
+/// rawSampleRate, NOTE! pipe reads blocks until data arrives
+class WavSampleSource : public SampleSource {
+  FILE *m_file;
+  uint32_t m_sampleRate;
+  uint8_t m_channels;
+  bool m_ownsFile;
+  bool _readHeader();
+public:
+  explicit WavSampleSource(const char *path);
+  explicit WavSampleSource(FILE *stream, uint32_t rawSampleRate = 0);
+  ~WavSampleSource();
+  bool isOpen() const { return m_file != nullptr; }
+  uint32_t sampleRate() const { return m_sampleRate; }
+  uint8_t channels() const { return m_channels; }
+  uint16_t read(int16_t *samples, uint16_t count);
+};
+#endif
+
+// ----------------------------------------------------------
+
+/**
+ * @brief: band energies and beat onsets from a SampleSource
+ *         samples are streamed into a ring buffer of 2 FFT sizes and
+ *         analysed by a fixed point FFT in blocks overlapping by half,
+ *         window, twiddles and work buffers are allocated once
+ *         update() can run from loop, a timer or an action, it analyses
+ *         at most maxBlocks each call, so time spent is bounded
+ *         in realtime mode blocks that can't be analysed within budget
+ *         are dropped, so output follows the latest audio
+ *         band and level is 0-255 on a log scale, 255 at the loudest
+ *         recently heard, 48 dB range
+ */
+class AudioAnalyzer {
+public:
+  static const uint8_t MIN_FFT_BITS = 5,
+                       MAX_FFT_BITS = 10,
+                       MAX_BANDS = 16;
+
+  /// FFT of 1 << fftBits samples, bands are spaced log from 0 to half
+  /// of sampleRate
+  explicit AudioAnalyzer(SampleSource &source, uint32_t sampleRate,
+                         uint8_t fftBits = 8, uint8_t bands = 8);
+  ~AudioAnalyzer();
+
+  uint16_t fftSize() const { return m_fftSize; }
+  uint8_t bandCount() const { return m_bandCount; }
+  uint32_t sampleRate() const { return m_sampleRate; }
+  /// lowest frequency in band, in Hz
+  uint32_t bandFrequency(uint8_t band) const;
+
+  bool realtime() const { return m_realtime; }
+  void setRealtime(bool realtime) { m_realtime = realtime; }
+
+  /// read source and analyse up to maxBlocks, returns blocks analysed
+  uint8_t update(uint8_t maxBlocks = 1);
+
+  uint8_t band(uint8_t idx) const { return idx < m_bandCount ? m_bands[idx] : 0; }
+  /// all bands
+  uint8_t level() const { return m_level; }
+  /// true when last update found a beat
+  bool beat() const { return m_beat; }
+  /// 255 at beat, falls to 0 in about 8 blocks
+  uint8_t beatPulse() const { return m_beatPulse; }
+  uint32_t beatCount() const { return m_beatCount; }
+  uint32_t blockCount() const { return m_blockCount; }
+  uint32_t droppedBlocks() const { return m_dropped; }
+
+  /// bytes allocated
+  uint16_t memoryUsage() const;
+
+private:
+  SampleSource &m_source;
+  int16_t *m_ring,
+          *m_window,   // hann, Q15
+          *m_cos,      // twiddles, Q15
+          *m_sin,
+          *m_re,
+          *m_im;
+  uint32_t m_sampleRate,
+           m_written,  // samples into ring since start
+           m_readPos,  // first sample of next block
+           m_blockCount,
+           m_beatCount,
+           m_dropped;
+  uint16_t m_fftSize,
+           m_edges[MAX_BANDS +1], // first bin of each band
+           m_peak,                // AGC, log2 in 1/16
+           m_bassAvg;             // running bass energy, log2 in 1/16
+  uint8_t m_bands[MAX_BANDS],
+          m_fftBits,
+          m_bandCount,
+          m_level,
+          m_beatPulse,
+          m_refractory;
+  bool m_beat,
+       m_realtime;
+
+  void _fill();
+  void _analyse();
+  void _fft();
+  uint8_t _scaleLog(uint16_t log) const;
+  static uint16_t _log2(uint32_t vlu);
+};
+
+// ----------------------------------------------------------
+
+/**
+ * @brief: binds a audio signal to owner, brightness by default or
+ *         anything else through a callback, ie speed of a ActionNoise
+ *         or palette position of a IndexedSegment
+ *         signal is mapped into low - high before it is applied
+ *         budget is blocks analysed each tick, 0 if analyzer is updated
+ *         elsewhere
+ */
+class ActionAudio : public Action<ActionAudio> {
+  friend class Action<ActionAudio>;
+public:
+  enum Signal : uint8_t { Level, Band, Beat };
+  typedef void (*BindCallback)(SegmentCommon *owner, uint8_t value, void *ctx);
+
+  explicit ActionAudio(AudioAnalyzer &analyzer, Signal signal = Level,
+                       uint8_t band = 0, uint32_t duration = 0);
+  virtual ~ActionAudio();
+
+  void setRange(uint8_t low, uint8_t high) { m_low = low; m_high = high; }
+  /// cb gets mapped value each tick, nullptr binds owners brightness
+  void bind(BindCallback cb, void *ctx) { m_cb = cb; m_ctx = ctx; }
+  uint8_t budget() const { return m_budget; }
+  void setBudget(uint8_t maxBlocks) { m_budget = maxBlocks; }
+  /// last mapped value
+  uint8_t value() const { return m_value; }
+
+private:
+  AudioAnalyzer &m_analyzer;
+  BindCallback m_cb;
+  void *m_ctx;
+  Signal m_signal;
+  uint8_t m_band,
+          m_low, m_high,
+          m_budget,
+          m_value;
+
+  void onTick(SegmentCommon *owner);
+};
+
+#endif /* AUDIO_H_ */
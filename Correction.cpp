@@ -0,0 +1,87 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  Correction.cpp
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#include "Correction.h"
+#include <math.h>
+
+OutputCorrection::OutputCorrection() :
+    m_gamma(1.0f), m_balance(255, 255, 255), m_order(RGB)
+{
+  setChannelOrder(RGB);
+  _buildTables();
+}
+
+OutputCorrection::OutputCorrection(float gamma, CRGB balance, EOrder order) :
+    m_gamma(gamma), m_balance(balance), m_order(order)
+{
+  setChannelOrder(order);
+  _buildTables();
+}
+
+OutputCorrection::~OutputCorrection()
+{
+}
+
+void OutputCorrection::setGamma(float gamma)
+{
+  m_gamma = gamma;
+  _buildTables();
+}
+
+void OutputCorrection::setBalance(CRGB balance)
+{
+  m_balance = balance;
+  _buildTables();
+}
+
+void OutputCorrection::setChannelOrder(EOrder order)
+{
+  // FastLED packs order as 3 octal digits, first digit is first byte out
+  m_order = order;
+  m_map[0] = (order >> 6) & 0x3;
+  m_map[1] = (order >> 3) & 0x3;
+  m_map[2] = order & 0x3;
+}
+
+void OutputCorrection::apply(const CRGB *src, CRGB *dst, uint16_t count) const
+{
+  const uint8_t *in = reinterpret_cast<const uint8_t*>(src);
+  uint8_t *out = reinterpret_cast<uint8_t*>(dst);
+  const uint8_t m0 = m_map[0], m1 = m_map[1], m2 = m_map[2];
+  const uint8_t *lut0 = m_lut[m0], *lut1 = m_lut[m1], *lut2 = m_lut[m2];
+
+  for (uint16_t i = 0; i < count; ++i, in += 3, out += 3) {
+    uint8_t c0 = in[m0], c1 = in[m1], c2 = in[m2]; // src may be dst
+    out[0] = lut0[c0];
+    out[1] = lut1[c1];
+    out[2] = lut2[c2];
+  }
+}
+
+void OutputCorrection::_buildTables()
+{
+  for (uint8_t ch = 0; ch < 3; ++ch) {
+    uint8_t top = m_balance[ch];
+    for (uint16_t v = 0; v < 256; ++v) {
+      float lin = m_gamma == 1.0f ? v / 255.0f : powf(v / 255.0f, m_gamma);
+      m_lut[ch][v] = (uint8_t)(lin * top + 0.5f);
+    }
+  }
+}
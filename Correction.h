@@ -0,0 +1,69 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  Correction.h
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#ifndef CORRECTION_H_
+#define CORRECTION_H_
+
+#include <stdint.h>
+#include <FastLED.h>
+
+/**
+ * @brief: gamma, channel balance and channel order applied when a
+ *         controller is sent, leds in controller buffer stays linear
+ *         everything is folded into one 256 entry table per channel
+ *         when changed, so render only does 3 lookups per led
+ *         set it with FastLED_Action::setOutputCorrection()
+ */
+class OutputCorrection {
+public:
+  OutputCorrection();
+  explicit OutputCorrection(float gamma, CRGB balance = CRGB(255, 255, 255),
+                            EOrder order = RGB);
+  ~OutputCorrection();
+
+  /// 1.0 is linear, 2.2-2.8 is typical for LED strips
+  void setGamma(float gamma);
+  float gamma() const { return m_gamma; }
+  /// max output of each channel, ie white balance of a strip
+  void setBalance(CRGB balance);
+  CRGB balance() const { return m_balance; }
+  /// reorder channels, ie BRG for a strip wired different from controller
+  void setChannelOrder(EOrder order);
+  EOrder channelOrder() const { return m_order; }
+
+  /// value sent for vlu on rgb channel, before reorder
+  uint8_t lookup(uint8_t channel, uint8_t vlu) const {
+    return m_lut[channel][vlu];
+  }
+
+  /// correct count leds from src into dst, dst may be src
+  void apply(const CRGB *src, CRGB *dst, uint16_t count) const;
+
+private:
+  uint8_t m_lut[3][256];
+  uint8_t m_map[3]; // output byte i takes rgb channel m_map[i]
+  float m_gamma;
+  CRGB m_balance;
+  EOrder m_order;
+
+  void _buildTables();
+};
+
+#endif /* CORRECTION_H_ */
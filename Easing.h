@@ -0,0 +1,234 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  Easing.h
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#ifndef EASING_H_
+#define EASING_H_
+
+#include <stdint.h>
+#include <Arduino.h>
+#include <FastLED.h>
+
+/**
+ * Easing curves, each curve is a struct with
+ *   static constexpr float at(float x)   x and result 0.0-1.0
+ * curves are ease in, wrap them in CurveOut or CurveInOut for the others
+ * they are only evaluated by the compiler, when EaseTable generates its
+ * table in PROGMEM, at runtime an ease is a table lookup and a integer lerp
+ *
+ *   ActionTween<TweenColor, EaseTable<CurveInOut<CurveCubic> > >
+ *   ActionEaseInOut(CRGB::Red, EaseTable<CurveOut<CurveBounce>, 65>::curve())
+ */
+
+// easing curves for ActionTween, maps progress 0-255 to eased progress
+struct EaseLinear {
+  static uint8_t ease(uint8_t x) { return x; }
+};
+struct EaseInOutQuad {
+  static uint8_t ease(uint8_t x) { return ease8InOutQuad(x); }
+};
+
+// ----------------------------------------------------------
+// compile time math, C++11 constexpr only allows a single return
+
+namespace easing_math {
+  constexpr float PI_F = 3.14159265f;
+  constexpr float LN2_F = 0.69314718f;
+
+  // cos for 0 - PI/2 by taylor series
+  constexpr float cosTaylor(float t2) {
+    return 1 - t2 / 2 * (1 - t2 / 12 * (1 - t2 / 30 * (1 - t2 / 56 *
+               (1 - t2 / 90 * (1 - t2 / 132)))));
+  }
+  constexpr float cosine(float t) { return cosTaylor(t * t); }
+
+  // e^x for 0 - 1 by taylor series
+  constexpr float expTaylor(float x) {
+    return 1 + x * (1 + x / 2 * (1 + x / 3 * (1 + x / 4 * (1 + x / 5 *
+               (1 + x / 6 * (1 + x / 7 * (1 + x / 8)))))));
+  }
+  constexpr float pow2Int(int n) {
+    return n == 0 ? 1.0f : n < 0 ? pow2Int(n + 1) / 2 : pow2Int(n - 1) * 2;
+  }
+  constexpr int floorInt(float x) {
+    return (float)(int)x > x ? (int)x - 1 : (int)x;
+  }
+  // 2^x as 2^floor(x) * e^(frac(x) * ln2)
+  constexpr float pow2(float x) {
+    return pow2Int(floorInt(x)) * expTaylor((x - floorInt(x)) * LN2_F);
+  }
+
+  constexpr float bounceOut(float t) {
+    return t < 1 / 2.75f ? 7.5625f * t * t :
+           t < 2 / 2.75f ? 7.5625f * (t - 1.5f / 2.75f) * (t - 1.5f / 2.75f) + 0.75f :
+           t < 2.5f / 2.75f ? 7.5625f * (t - 2.25f / 2.75f) * (t - 2.25f / 2.75f) + 0.9375f :
+                              7.5625f * (t - 2.625f / 2.75f) * (t - 2.625f / 2.75f) + 0.984375f;
+  }
+
+  // one coordinate of a cubic bezier from 0,0 to 1,1
+  constexpr float bezier(float t, float p1, float p2) {
+    return 3 * (1 - t) * (1 - t) * t * p1 + 3 * (1 - t) * t * t * p2 + t * t * t;
+  }
+  // find t where bezier x is x, by bisection
+  constexpr float bezierT(float x, float p1, float p2,
+                          float lo, float hi, int depth) {
+    return depth == 0 ? (lo + hi) / 2 :
+           bezier((lo + hi) / 2, p1, p2) < x ?
+              bezierT(x, p1, p2, (lo + hi) / 2, hi, depth - 1) :
+              bezierT(x, p1, p2, lo, (lo + hi) / 2, depth - 1);
+  }
+
+  constexpr uint8_t toByte(float y) {
+    return y <= 0 ? 0 : y >= 1 ? 255 : (uint8_t)(y * 255 + 0.5f);
+  }
+
+  template<uint16_t... Is> struct IndexSeq {};
+  template<uint16_t N, uint16_t... Is>
+  struct MakeIndexSeq : MakeIndexSeq<N - 1, N - 1, Is...> {};
+  template<uint16_t... Is>
+  struct MakeIndexSeq<0, Is...> { typedef IndexSeq<Is...> type; };
+} // namespace easing_math
+
+// ----------------------------------------------------------
+// curves
+
+struct CurveLinear {
+  static constexpr float at(float x) { return x; }
+};
+struct CurveQuad {
+  static constexpr float at(float x) { return x * x; }
+};
+struct CurveCubic {
+  static constexpr float at(float x) { return x * x * x; }
+};
+struct CurveSine {
+  static constexpr float at(float x) {
+    return 1 - easing_math::cosine(x * easing_math::PI_F / 2);
+  }
+};
+struct CurveExpo {
+  static constexpr float at(float x) {
+    return x <= 0 ? 0 : easing_math::pow2(10 * x - 10);
+  }
+};
+/// hermite smoothstep, ie fade between noise lattice points
+struct CurveSmoothStep {
+  static constexpr float at(float x) { return x * x * (3 - 2 * x); }
+};
+struct CurveBounce {
+  static constexpr float at(float x) {
+    return 1 - easing_math::bounceOut(1 - x);
+  }
+};
+/// css style cubic-bezier, control points as 0-255 for 0.0-1.0
+/// ie CurveBezier<107, 0, 148, 255> is ease-in-out
+template<uint8_t X1, uint8_t Y1, uint8_t X2, uint8_t Y2>
+struct CurveBezier {
+  static constexpr float at(float x) {
+    return easing_math::bezier(
+        easing_math::bezierT(x, X1 / 255.0f, X2 / 255.0f, 0, 1, 16),
+        Y1 / 255.0f, Y2 / 255.0f);
+  }
+};
+
+/// ease in is the curve as is
+template<class Curve>
+struct CurveIn {
+  static constexpr float at(float x) { return Curve::at(x); }
+};
+/// curve mirrored, fast start slow end
+template<class Curve>
+struct CurveOut {
+  static constexpr float at(float x) { return 1 - Curve::at(1 - x); }
+};
+/// ease in first half, ease out second half
+template<class Curve>
+struct CurveInOut {
+  static constexpr float at(float x) {
+    return x < 0.5f ? Curve::at(2 * x) / 2 : 1 - Curve::at(2 - 2 * x) / 2;
+  }
+};
+
+// ----------------------------------------------------------
+
+/// ease x by table of size points in PROGMEM, lerps between points
+inline uint8_t easeLookup(const uint8_t *table, uint16_t size, uint8_t x)
+{
+  // 0-255 to 0-256 so 255 hits last point
+  uint16_t pos = (uint16_t)(x + (x >> 7)) * (size - 1);
+  uint8_t idx = pos >> 8, frac = pos & 0xFF;
+  uint8_t a = pgm_read_byte(table + idx);
+  if (frac == 0)
+    return a;
+  uint8_t b = pgm_read_byte(table + idx + 1);
+  return lerp8by8(a, b, frac);
+}
+
+/**
+ * @brief: a easing table chosen at runtime, ie as a constructor parameter
+ *         default constructed it is linear
+ */
+class EasingCurve {
+  const uint8_t *m_table;
+  uint16_t m_size;
+public:
+  EasingCurve() : m_table(nullptr), m_size(0) {}
+  /// table of size points in PROGMEM, size 2-256
+  EasingCurve(const uint8_t *table, uint16_t size) :
+    m_table(table), m_size(size)
+  {}
+  uint8_t ease(uint8_t x) const {
+    return m_table ? easeLookup(m_table, m_size, x) : x;
+  }
+};
+
+template<class Curve, uint16_t Resolution,
+         class Seq = typename easing_math::MakeIndexSeq<Resolution>::type>
+struct EaseTableData;
+
+template<class Curve, uint16_t Resolution, uint16_t... Is>
+struct EaseTableData<Curve, Resolution, easing_math::IndexSeq<Is...> > {
+  static const uint8_t values[Resolution] PROGMEM;
+};
+
+template<class Curve, uint16_t Resolution, uint16_t... Is>
+const uint8_t EaseTableData<Curve, Resolution, easing_math::IndexSeq<Is...> >
+  ::values[Resolution] PROGMEM = {
+    easing_math::toByte(Curve::at((float)Is / (Resolution - 1)))...
+};
+
+/**
+ * @brief: Curve sampled into Resolution points in PROGMEM at compile time
+ *         Resolution 2-256, more points follows the curve closer
+ *         can be used as Easing in ActionTween
+ */
+template<class Curve, uint16_t Resolution = 33>
+struct EaseTable {
+  static_assert(Resolution >= 2 && Resolution <= 256,
+                "EaseTable Resolution must be 2-256");
+  static const uint8_t *table() {
+    return EaseTableData<Curve, Resolution>::values;
+  }
+  static uint8_t ease(uint8_t x) {
+    return easeLookup(table(), Resolution, x);
+  }
+  static EasingCurve curve() { return EasingCurve(table(), Resolution); }
+};
+
+#endif /* EASING_H_ */
@@ -19,48 +19,201 @@
 */
 
 #include "FastLED_Action.h"
-
-
-FastLED_Action::FastLED_Action()
+#include "Recorder.h"
+#include "Correction.h"
+#include "IndexedSegment.h"
+#include "MirrorSegment.h"
+#include "GatherSegment.h"
+#include "Memory.h"
+
+
+FastLED_Action::FastLED_Action() :
+    m_recorder(nullptr), m_postProcessCount(0),
+    m_scratch(nullptr), m_filterLine(nullptr),
+    m_scratchSize(0), m_filterLineSize(0),
+    m_powerLimit(0), m_layoutGeneration(0),
+    m_frameMs(10) // a 300 led WS2812 strip takes ~9ms to show
 {
-  for(int i = 0; i < MAX_CHANNEL_COUNT; ++i)
-    m_dirtyControllers[i] = nullptr;
+  for(int i = 0; i < MAX_CHANNEL_COUNT; ++i) {
+    ControllerEntry &entry = m_controllers[i];
+    entry.controller = nullptr;
+    entry.correction = nullptr;
+    entry.blocks = nullptr;
+    entry.dirtyBlocks = nullptr;
+    entry.dimmed = nullptr;
+    entry.draw = 0;
+    entry.dirtyFirst = 0xFFFF;
+    entry.dirtyEnd = 0;
+    entry.blockCount = 0;
+    entry.dimmedSize = 0;
+    entry.supply = 0;
+    entry.brightness = 255;
+    entry.dirty = false;
+  }
+  for(uint8_t i = 0; i < MAX_SUPPLY_COUNT; ++i)
+    m_supplyLimit[i] = 0;
+  for(uint8_t i = 0; i < MAX_TRANSITIONS; ++i) {
+    m_transitions[i].item = nullptr;
+    m_transitions[i].frames = nullptr;
+    m_transitions[i].capacity = 0;
+  }
+  resetStats();
 }
 
 FastLED_Action::~FastLED_Action()
 {
+  for(int i = 0; i < MAX_CHANNEL_COUNT; ++i) {
+    ControllerEntry &entry = m_controllers[i];
+    memDelete(MemoryStats::Engine, entry.blocks, entry.blockCount);
+    memDelete(MemoryStats::Engine, entry.dirtyBlocks,
+              (entry.blockCount + 7) >> 3);
+    memDelete(MemoryStats::Engine, entry.dimmed, entry.dimmedSize);
+  }
+  for(uint8_t i = 0; i < MAX_TRANSITIONS; ++i) {
+    TransitionSlot &slot = m_transitions[i];
+    memDelete(MemoryStats::Frames, slot.frames, (uint32_t)slot.capacity * 2);
+  }
+  memDelete(MemoryStats::Engine, m_scratch, m_scratchSize);
+  releaseFilterLine();
+  MemoryStats::freed(MemoryStats::Lists, m_items.length() * MemoryStats::LIST_NODE);
 }
 
 // static
 FastLED_Action FastLED_Action::s_instance;
 
-void FastLED_Action::_registerItem(SegmentCommon *item)
+void FastLED_Action::attach(SegmentCommon *item)
 {
-  m_items.push(item);
+  if (!isAttached(item)) {
+    m_items.push(item);
+    MemoryStats::allocated(MemoryStats::Lists, MemoryStats::LIST_NODE);
+  }
 }
 
-void FastLED_Action::_unregisterItem(SegmentCommon *item)
+void FastLED_Action::detach(SegmentCommon *item)
 {
-  size_t idx = 0;
-  for(SegmentCommon *itm = m_items.first();
-      m_items.canMove(); itm = m_items.next())
-  {
-    if (itm == item)
+  for(size_t idx = 0; idx < m_items.length(); ++idx) {
+    if (m_items[idx] == item) {
       m_items.remove(idx);
-    ++idx;
+      MemoryStats::freed(MemoryStats::Lists, MemoryStats::LIST_NODE);
+      return;
+    }
+  }
+}
+
+bool FastLED_Action::isAttached(SegmentCommon *item)
+{
+  for(size_t idx = 0; idx < m_items.length(); ++idx) {
+    if (m_items[idx] == item)
+      return true;
+  }
+  return false;
+}
+
+void FastLED_Action::update()
+{
+  for(auto itm = m_items.first(); m_items.canMove(); itm = m_items.next())
+  {
+    itm->loop();
+  }
+  for(uint8_t i = 0; i < m_postProcessCount; ++i)
+    m_postProcess[i].cb(m_postProcess[i].item, m_postProcess[i].ctx);
+  ++m_stats.loops;
+  _render();
+}
+
+bool FastLED_Action::addPostProcess(PostProcessCallback cb,
+                                    SegmentCommon *item, void *ctx)
+{
+  if (m_postProcessCount >= MAX_POST_PROCESS)
+    return false;
+  PostProcessEntry &entry = m_postProcess[m_postProcessCount++];
+  entry.cb = cb;
+  entry.item = item;
+  entry.ctx = ctx;
+  return true;
+}
+
+void FastLED_Action::removePostProcess(SegmentCommon *item, void *ctx)
+{
+  for(uint8_t i = 0; i < m_postProcessCount;) {
+    if (m_postProcess[i].item == item && m_postProcess[i].ctx == ctx) {
+      --m_postProcessCount;
+      for(uint8_t j = i; j < m_postProcessCount; ++j)
+        m_postProcess[j] = m_postProcess[j +1];
+    } else
+      ++i;
+  }
+}
+
+void FastLED_Action::reserveTransitions(uint16_t leds)
+{
+  for(uint8_t i = 0; i < MAX_TRANSITIONS; ++i) {
+    TransitionSlot &slot = m_transitions[i];
+    if (slot.capacity >= leds || slot.item)
+      continue;
+    memDelete(MemoryStats::Frames, slot.frames, (uint32_t)slot.capacity * 2);
+    slot.frames = memNew<CRGB>(MemoryStats::Frames, (uint32_t)leds * 2);
+    slot.capacity = leds;
+  }
+}
+
+bool FastLED_Action::inTransition(SegmentCommon *item) const
+{
+  for(uint8_t i = 0; i < MAX_TRANSITIONS; ++i) {
+    if (m_transitions[i].item == item)
+      return true;
+  }
+  return false;
+}
+
+uint32_t FastLED_Action::transitionMemory() const
+{
+  uint32_t bytes = 0;
+  for(uint8_t i = 0; i < MAX_TRANSITIONS; ++i)
+    bytes += (uint32_t)m_transitions[i].capacity * 2 * sizeof(CRGB);
+  return bytes;
+}
+
+CRGB *FastLED_Action::filterLine(uint16_t size)
+{
+  if (size > m_filterLineSize) {
+    memDelete(MemoryStats::Frames, m_filterLine, m_filterLineSize);
+    m_filterLine = memNew<CRGB>(MemoryStats::Frames, size);
+    m_filterLineSize = size;
   }
+  return m_filterLine;
+}
+
+void FastLED_Action::releaseFilterLine()
+{
+  memDelete(MemoryStats::Frames, m_filterLine, m_filterLineSize);
+  m_filterLineSize = 0;
+}
+
+void FastLED_Action::clearActions()
+{
+  _clearActions(nullptr);
+}
+
+void FastLED_Action::resetStats()
+{
+  m_stats.loops = m_stats.frames = m_stats.shows = 0;
+  m_stats.renderMicros = m_stats.milliamps = 0;
+  m_stats.dirtyBlocks = 0;
+  m_stats.headroom = NO_POWER_LIMIT;
+  m_stats.powerScale = 255;
 }
 
 // static
 void FastLED_Action::registerItem(SegmentCommon *item)
 {
-  FastLED_Action::s_instance._registerItem(item);
+  FastLED_Action::s_instance.attach(item);
 }
 
 // static
 void FastLED_Action::unregisterItem(SegmentCommon *item)
 {
-  FastLED_Action::s_instance._unregisterItem(item);
+  FastLED_Action::s_instance.detach(item);
 }
 
 // static
@@ -72,12 +225,7 @@ FastLED_Action &FastLED_Action::instance()
 // static
 void FastLED_Action::loop()
 {
-  DListDynamic<SegmentCommon*> &items = FastLED_Action::s_instance.m_items;
-  for(auto itm = items.first(); items.canMove(); itm = items.next())
-  {
-    itm->loop();
-  }
-  s_instance._render();
+  s_instance.update();
 }
 
 // static
@@ -89,7 +237,7 @@ void FastLED_Action::runProgram(int repeatCount)
     running  = true;
     do {
       s_instance.program();
-      s_instance.clearAllActions(); // safety cleanup
+      s_instance.clearActions(); // safety cleanup
       if (repeatCount < -1)
         ++repeatCount;
     } while(repeatCount--);
@@ -100,18 +248,374 @@ void FastLED_Action::runProgram(int repeatCount)
 // static
 void FastLED_Action::clearAllActions()
 {
-  s_instance._clearActions(nullptr);
+  s_instance.clearActions();
 }
 
 void FastLED_Action::_render()
 {
+  uint32_t start = micros();
+  bool changed = false;
+
+  // palette indices to leds, then mirrors copies their sources,
+  // both marks controllers dirty
+  for(size_t idx = 0; idx < m_items.length(); ++idx)
+    _prepare(m_items[idx], SegmentCommon::T_Indexed);
+  for(size_t idx = 0; idx < m_items.length(); ++idx)
+    _prepare(m_items[idx], SegmentCommon::T_Mirror);
+
+  // dimmed copy is kept per controller, only changed blocks are redone
+  // and both power estimate and output reads it
+  bool dimmed = _anyDimmed();
+  for(int i = 0; i < MAX_CHANNEL_COUNT; ++i) {
+    ControllerEntry &entry = m_controllers[i];
+    if (!entry.controller)
+      break;
+    if (!dimmed)
+      memDelete(MemoryStats::Engine, entry.dimmed, entry.dimmedSize);
+    else if (entry.dirty)
+      _updateDimmed(entry);
+  }
+  _limitPower();
+
   // render changes
+  uint32_t dirtyBlocks = 0;
   for(int i = MAX_CHANNEL_COUNT -1; i >= 0; --i) {
-    CLEDController *cont = m_dirtyControllers[i];
-    if (cont != nullptr) {
-      cont->showLeds();
-      m_dirtyControllers[i] = nullptr;
+    ControllerEntry &entry = m_controllers[i];
+    if (entry.dirty) {
+      uint16_t blockCnt = _blockCount(entry), marked = 0;
+      if (entry.dirtyBlocks && entry.dirtyFirst < entry.dirtyEnd) {
+        for(uint16_t blk = 0; blk < blockCnt; ++blk)
+          marked += _blockDirty(entry, blk);
+        memset(entry.dirtyBlocks, 0, (blockCnt + 7) >> 3);
+      }
+      // without a range, ie new brightness, all is sent changed
+      dirtyBlocks += marked > 0 ? marked : blockCnt;
+      const CRGB *out = _output(entry);
+      if (m_recorder) {
+        if (!changed)
+          m_recorder->beginFrame(millis());
+        m_recorder->capture(i, out, entry.controller->size());
+      }
+      if (out == entry.controller->leds())
+        entry.controller->showLeds(entry.brightness);
+      else
+        entry.controller->show(out, entry.controller->size(),
+                               entry.brightness);
+      entry.dirty = false;
+      entry.dirtyFirst = 0xFFFF;
+      entry.dirtyEnd = 0;
+      ++m_stats.shows;
+      changed = true;
+    }
+  }
+
+  if (changed) {
+    ++m_stats.frames;
+    m_stats.dirtyBlocks = dirtyBlocks;
+    m_stats.renderMicros = micros() - start;
+  }
+
+  if (m_recorder)
+    m_recorder->service(); // drain a little each loop
+}
+
+const CRGB *FastLED_Action::_output(ControllerEntry &entry)
+{
+  const CRGB *leds = entry.dimmed ? entry.dimmed : entry.controller->leds();
+  if (!entry.correction)
+    return leds;
+
+  uint16_t size = entry.controller->size();
+  if (size > m_scratchSize) {
+    memDelete(MemoryStats::Engine, m_scratch, m_scratchSize);
+    m_scratch = memNew<CRGB>(MemoryStats::Engine, size);
+    m_scratchSize = size;
+  }
+  entry.correction->apply(leds, m_scratch, size);
+  return m_scratch;
+}
+
+bool FastLED_Action::_anyDimmed()
+{
+  for(size_t idx = 0; idx < m_items.length(); ++idx) {
+    if (_dimmed(m_items[idx]))
+      return true;
+  }
+  return false;
+}
+
+struct FastLED_Action::DimCtx {
+  const ControllerEntry *entry;
+  uint16_t first,   // range to dim, in strip order
+           end;
+  bool all;         // all blocks within range, else only changed
+  uint8_t brightness;
+};
+
+void FastLED_Action::_updateDimmed(ControllerEntry &entry)
+{
+  uint16_t size = entry.controller->size();
+  DimCtx ctx = { &entry, entry.dirtyFirst, entry.dirtyEnd, false, 255 };
+  if (!entry.dimmed || entry.dimmedSize != size) {
+    // first frame dimmed, copy all
+    memDelete(MemoryStats::Engine, entry.dimmed, entry.dimmedSize);
+    entry.dimmed = memNew<CRGB>(MemoryStats::Engine, size);
+    entry.dimmedSize = size;
+    ctx.first = 0;
+    ctx.end = size;
+    ctx.all = true;
+  }
+  if (ctx.end > size)
+    ctx.end = size;
+  if (ctx.first >= ctx.end)
+    return; // ie only brightness of controller changed
+  // whole blocks are copied, so whole blocks are dimmed again
+  ctx.first &= ~((1 << POWER_BLOCK_SHIFT) -1);
+  uint32_t end = ((ctx.end -1) | ((1 << POWER_BLOCK_SHIFT) -1)) + 1;
+  ctx.end = end > size ? size : end;
+
+  const CRGB *leds = entry.controller->leds();
+  for(uint16_t blk = ctx.first >> POWER_BLOCK_SHIFT,
+               lastBlk = (ctx.end -1) >> POWER_BLOCK_SHIFT; blk <= lastBlk; ++blk)
+  {
+    if (!ctx.all && !_blockDirty(entry, blk))
+      continue;
+    uint16_t i = blk << POWER_BLOCK_SHIFT,
+             blkEnd = i + (1 << POWER_BLOCK_SHIFT);
+    if (blkEnd > size)
+      blkEnd = size;
+    memcpy(&entry.dimmed[i], &leds[i], (blkEnd - i) * sizeof(CRGB));
+  }
+  for(size_t idx = 0; idx < m_items.length(); ++idx)
+    _dim(m_items[idx], ctx, 255);
+}
+
+bool FastLED_Action::_powerLimited() const
+{
+  if (m_powerLimit > 0)
+    return true;
+  for(uint8_t i = 0; i < MAX_SUPPLY_COUNT; ++i) {
+    if (m_supplyLimit[i] > 0)
+      return true;
+  }
+  return false;
+}
+
+void FastLED_Action::_updateDraw(ControllerEntry &entry)
+{
+  uint16_t size = entry.controller->size(),
+           first = entry.dirtyFirst,
+           end = entry.dirtyEnd;
+  bool all = !entry.blocks;
+  if (!entry.blocks) {
+    // first time, scan all
+    uint16_t blockCnt = (size + (1 << POWER_BLOCK_SHIFT) -1) >> POWER_BLOCK_SHIFT;
+    entry.blocks = memNew<uint32_t>(MemoryStats::Engine, blockCnt);
+    entry.blockCount = blockCnt;
+    memset(entry.blocks, 0, blockCnt * sizeof(uint32_t));
+    entry.draw = 0;
+    first = 0;
+    end = size;
+  }
+  if (end > size)
+    end = size;
+  if (first >= end)
+    return;
+
+  // only blocks within changed range is summed again, from leds as
+  // dimmed by segment brightness, a brightness change dirties its leds
+  const CRGB *leds = entry.dimmed ? entry.dimmed : entry.controller->leds();
+  for(uint16_t blk = first >> POWER_BLOCK_SHIFT,
+               lastBlk = (end -1) >> POWER_BLOCK_SHIFT; blk <= lastBlk; ++blk)
+  {
+    if (!all && !_blockDirty(entry, blk))
+      continue; // sparse changes, ie twinkles
+    uint16_t i = blk << POWER_BLOCK_SHIFT,
+             blkEnd = i + (1 << POWER_BLOCK_SHIFT);
+    if (blkEnd > size)
+      blkEnd = size;
+    uint32_t sum = 0;
+    for(; i < blkEnd; ++i) {
+      sum += (uint16_t)leds[i].r * POWER_RED_MA +
+             (uint16_t)leds[i].g * POWER_GREEN_MA +
+             (uint16_t)leds[i].b * POWER_BLUE_MA;
+    }
+    entry.draw += sum - entry.blocks[blk];
+    entry.blocks[blk] = sum;
+  }
+}
+
+// brightness that keeps active + idle within limit
+static uint8_t powerScale(uint32_t limit, uint32_t active, uint32_t idle)
+{
+  if (limit == 0 || active + idle <= limit)
+    return 255;
+  if (limit <= idle)
+    return 0;
+  return ((limit - idle) * 255) / active;
+}
+
+void FastLED_Action::_limitPower()
+{
+  if (!_powerLimited()) {
+    // resend at full brightness if limit was removed, sums are dropped
+    // as changes are not tracked, next limit scans all again
+    for(int i = 0; i < MAX_CHANNEL_COUNT; ++i) {
+      ControllerEntry &entry = m_controllers[i];
+      if (entry.brightness != 255) {
+        entry.brightness = 255;
+        entry.dirty = true;
+      }
+      memDelete(MemoryStats::Engine, entry.blocks, entry.blockCount);
+      entry.draw = 0;
+    }
+    m_stats.headroom = NO_POWER_LIMIT;
+    m_stats.powerScale = 255;
+    return;
+  }
+
+  uint32_t active[MAX_SUPPLY_COUNT] = { 0 },
+           idle[MAX_SUPPLY_COUNT] = { 0 },
+           totalActive = 0, totalIdle = 0;
+  for(int i = 0; i < MAX_CHANNEL_COUNT; ++i) {
+    ControllerEntry &entry = m_controllers[i];
+    if (!entry.controller)
+      break;
+    _updateDraw(entry);
+    uint32_t act = entry.draw / 255,
+             idl = (uint32_t)entry.controller->size() * POWER_IDLE_MA;
+    active[entry.supply] += act;
+    idle[entry.supply] += idl;
+    totalActive += act;
+    totalIdle += idl;
+  }
+
+  uint8_t globalScale = powerScale(m_powerLimit, totalActive, totalIdle),
+          supplyScale[MAX_SUPPLY_COUNT];
+  int32_t headroom = NO_POWER_LIMIT;
+  if (m_powerLimit > 0)
+    headroom = (int32_t)m_powerLimit - (int32_t)(totalActive + totalIdle);
+  for(uint8_t i = 0; i < MAX_SUPPLY_COUNT; ++i) {
+    supplyScale[i] = powerScale(m_supplyLimit[i], active[i], idle[i]);
+    if (m_supplyLimit[i] > 0) {
+      int32_t left = (int32_t)m_supplyLimit[i] - (int32_t)(active[i] + idle[i]);
+      if (left < headroom)
+        headroom = left;
+    }
+  }
+
+  uint8_t lowest = 255;
+  for(int i = 0; i < MAX_CHANNEL_COUNT; ++i) {
+    ControllerEntry &entry = m_controllers[i];
+    if (!entry.controller)
+      break;
+    uint8_t brightness = supplyScale[entry.supply] < globalScale ?
+                            supplyScale[entry.supply] : globalScale;
+    if (brightness != entry.brightness) {
+      entry.brightness = brightness;
+      entry.dirty = true; // resend with new limit
     }
+    if (brightness < lowest)
+      lowest = brightness;
+  }
+
+  m_stats.milliamps = totalActive + totalIdle;
+  m_stats.headroom = headroom;
+  m_stats.powerScale = lowest;
+}
+
+// static
+uint32_t FastLED_Action::_milliamps(const ControllerEntry &entry)
+{
+  return entry.draw / 255 +
+         (uint32_t)entry.controller->size() * POWER_IDLE_MA;
+}
+
+// dims the leds of run within changed blocks of ctx range
+// static
+void FastLED_Action::_dimRun(const LedRun &run, uint16_t logicalIdx, void *ctx)
+{
+  (void)logicalIdx;
+  DimCtx *dim = static_cast<DimCtx*>(ctx);
+  const ControllerEntry &entry = *dim->entry;
+  if (run.controller != entry.controller || run.size == 0)
+    return;
+  uint16_t lo = run.firstLedIdx(),
+           step = run.stride < 0 ? -run.stride : run.stride,
+           first = lo > dim->first ? lo : dim->first;
+  uint32_t end = (uint32_t)lo + run.span();
+  if (end > dim->end)
+    end = dim->end;
+  if (step == 0 || first >= end)
+    return;
+  for(uint16_t blk = first >> POWER_BLOCK_SHIFT,
+               lastBlk = (end -1) >> POWER_BLOCK_SHIFT; blk <= lastBlk; ++blk)
+  {
+    if (!dim->all && !_blockDirty(entry, blk))
+      continue;
+    uint16_t blkFirst = blk << POWER_BLOCK_SHIFT;
+    uint32_t blkEnd = (uint32_t)blkFirst + (1 << POWER_BLOCK_SHIFT);
+    if (blkFirst < first)
+      blkFirst = first;
+    if (blkEnd > end)
+      blkEnd = end;
+    // first led of run in block
+    uint16_t i = lo + (uint16_t)((blkFirst - lo + step -1) / step) * step;
+    for(; i < blkEnd; i += step)
+      entry.dimmed[i].nscale8(dim->brightness);
+  }
+}
+
+bool FastLED_Action::_dimmed(SegmentCommon *item)
+{
+  if (item->brightness() < 255)
+    return true;
+  if (item->type() == SegmentCommon::T_Compound) {
+    SegmentCompound *comp = static_cast<SegmentCompound*>(item);
+    for(uint16_t i = 0, sz = comp->segmentSize(); i < sz; ++i) {
+      if (comp->segmentAt(i)->brightness() < 255)
+        return true;
+    }
+    for(uint16_t i = 0, sz = comp->compoundSize(); i < sz; ++i) {
+      if (_dimmed(comp->compoundAt(i)))
+        return true;
+    }
+  }
+  return false;
+}
+
+void FastLED_Action::_dim(SegmentCommon *item, DimCtx &ctx, uint8_t brightness)
+{
+  if (item->brightness() < 255)
+    brightness = scale8(brightness, item->brightness());
+
+  if (item->isSegment()) {
+    if (brightness == 255)
+      return;
+    ctx.brightness = brightness;
+    item->forEachRun(_dimRun, &ctx);
+  } else if (item->type() == SegmentCommon::T_Compound) {
+    SegmentCompound *comp = static_cast<SegmentCompound*>(item);
+    for(uint16_t i = 0, sz = comp->segmentSize(); i < sz; ++i)
+      _dim(comp->segmentAt(i), ctx, brightness);
+    for(uint16_t i = 0, sz = comp->compoundSize(); i < sz; ++i)
+      _dim(comp->compoundAt(i), ctx, brightness);
+  }
+}
+
+void FastLED_Action::_prepare(SegmentCommon *item, uint8_t type)
+{
+  if (item->type() == type) {
+    if (type == SegmentCommon::T_Indexed)
+      static_cast<IndexedSegment*>(item)->expand();
+    else if (type == SegmentCommon::T_Mirror)
+      static_cast<MirrorSegment*>(item)->mirror();
+  } else if (item->type() == SegmentCommon::T_Compound) {
+    SegmentCompound *comp = static_cast<SegmentCompound*>(item);
+    for(uint16_t i = 0, sz = comp->segmentSize(); i < sz; ++i)
+      _prepare(comp->segmentAt(i), type);
+    for(uint16_t i = 0, sz = comp->compoundSize(); i < sz; ++i)
+      _prepare(comp->compoundAt(i), type);
   }
 }
 
@@ -124,7 +628,7 @@ void FastLED_Action::_clearActions(SegmentCommon *item)
   }
 
   if (item->type() == Segment::T_Compound) {
-    SegmentCompound *comp = reinterpret_cast<SegmentCompound*>(item);
+    SegmentCompound *comp = static_cast<SegmentCompound*>(item);
     for(uint16_t i = 0, sz = comp->compoundSize(); i < sz; ++i)
       _clearActions(comp->compoundAt(i));
   }
@@ -133,36 +637,326 @@ void FastLED_Action::_clearActions(SegmentCommon *item)
     item->removeActionByIdx(0);
 }
 
-void FastLED_Action::setLedControllerHasChanges(CLEDController *controller)
+FastLED_Action::ControllerEntry*
+FastLED_Action::_controllerEntry(CLEDController *controller, bool create)
 {
   for(int i = 0; i < MAX_CHANNEL_COUNT; ++i) {
-    CLEDController *cont = m_dirtyControllers[i];
-    if (cont == controller)
-      return; // already dirty
-    if (cont == nullptr) {
-      m_dirtyControllers[i] = controller;
-      return;
+    ControllerEntry &entry = m_controllers[i];
+    if (entry.controller == controller)
+      return &entry;
+    if (entry.controller == nullptr) {
+      if (!create)
+        return nullptr;
+      entry.controller = controller;
+      return &entry;
     }
   }
+  return nullptr; // registry full
+}
+
+struct FastLED_Action::TransitionCtx {
+  enum Mode : uint8_t { Snapshot, Save, Restore, Blend };
+  CRGB *out,     // outgoing frame
+       *in;      // incoming action output
+  Mode mode;
+  fract8 amount;
+};
+
+void FastLED_Action::_beginTransition(SegmentCommon *item, uint16_t duration)
+{
+  // item already fading starts over from what it shows now
+  TransitionSlot *slot = nullptr, *free = nullptr;
+  uint16_t size = item->size();
+  for(uint8_t i = 0; i < MAX_TRANSITIONS && !slot; ++i) {
+    TransitionSlot &s = m_transitions[i];
+    if (s.item == item)
+      slot = &s;
+    else if (!s.item && (!free || (s.capacity >= size && free->capacity < size)))
+      free = &s; // rather one that fits
+  }
+  if (!slot)
+    slot = free;
+  if (!slot || size == 0)
+    return; // all busy, switch at once
+
+  if (slot->capacity < size) {
+    // only first time a slot is too small
+    memDelete(MemoryStats::Frames, slot->frames, (uint32_t)slot->capacity * 2);
+    slot->frames = memNew<CRGB>(MemoryStats::Frames, (uint32_t)size * 2);
+    slot->capacity = size;
+  }
+  slot->item = item;
+  slot->size = size;
+  slot->start = millis();
+  slot->duration = duration;
+  slot->incoming = false;
+  TransitionCtx ctx = { slot->frames, nullptr, TransitionCtx::Snapshot, 0 };
+  item->forEachRun(&FastLED_Action::_transitionRun, &ctx);
+}
+
+FastLED_Action::TransitionSlot *FastLED_Action::_transitionBefore(SegmentCommon *item)
+{
+  TransitionSlot *slot = nullptr;
+  for(uint8_t i = 0; i < MAX_TRANSITIONS && !slot; ++i) {
+    if (m_transitions[i].item == item)
+      slot = &m_transitions[i];
+  }
+  if (!slot)
+    return nullptr;
+  if (item->size() != slot->size) {
+    slot->item = nullptr; // layout changed, frames are stale
+    return nullptr;
+  }
+
+  // action sees its own output, not the blend
+  if (slot->incoming) {
+    TransitionCtx ctx = { nullptr, slot->frames + slot->capacity,
+                          TransitionCtx::Restore, 0 };
+    item->forEachRun(&FastLED_Action::_transitionRun, &ctx);
+  }
+  if (millis() - slot->start >= slot->duration) {
+    slot->item = nullptr;
+    item->dirty();
+    return nullptr;
+  }
+  return slot;
+}
+
+void FastLED_Action::_transitionAfter(TransitionSlot *slot)
+{
+  SegmentCommon *item = slot->item;
+  TransitionCtx ctx = { slot->frames, slot->frames + slot->capacity,
+                        TransitionCtx::Save, 0 };
+  item->forEachRun(&FastLED_Action::_transitionRun, &ctx);
+  slot->incoming = true;
+
+  uint32_t elapsed = millis() - slot->start;
+  ctx.out = slot->frames;
+  ctx.in = slot->frames + slot->capacity;
+  ctx.mode = TransitionCtx::Blend;
+  ctx.amount = elapsed >= slot->duration ? 255 : (elapsed * 255) / slot->duration;
+  item->forEachRun(&FastLED_Action::_transitionRun, &ctx);
+  item->dirty();
+}
+
+void FastLED_Action::_endTransition(SegmentCommon *item)
+{
+  for(uint8_t i = 0; i < MAX_TRANSITIONS; ++i) {
+    if (m_transitions[i].item == item)
+      m_transitions[i].item = nullptr;
+  }
+}
+
+// static
+void FastLED_Action::_transitionRun(const LedRun &run, uint16_t logicalIdx,
+                                    void *ctx)
+{
+  (void)logicalIdx;
+  TransitionCtx *trans = static_cast<TransitionCtx*>(ctx);
+  uint16_t n = run.size;
+  if (run.stride == 1 || run.stride == -1) {
+    // frames are kept in memory order of each run, so bulk kernels works
+    CRGB *leds = run.stride < 0 ? &run[n -1] : run.leds;
+    switch (trans->mode) {
+    case TransitionCtx::Snapshot: memcpy(trans->out, leds, n * sizeof(CRGB)); break;
+    case TransitionCtx::Save:     memcpy(trans->in, leds, n * sizeof(CRGB)); break;
+    case TransitionCtx::Restore:  memcpy(leds, trans->in, n * sizeof(CRGB)); break;
+    case TransitionCtx::Blend:
+      blend(trans->out, trans->in, leds, n, trans->amount);
+      break;
+    }
+  } else {
+    for (uint16_t i = 0; i < n; ++i) {
+      CRGB &led = run[i];
+      switch (trans->mode) {
+      case TransitionCtx::Snapshot: trans->out[i] = led; break;
+      case TransitionCtx::Save:     trans->in[i] = led; break;
+      case TransitionCtx::Restore:  led = trans->in[i]; break;
+      case TransitionCtx::Blend:
+        led = blend(trans->out[i], trans->in[i], trans->amount);
+        break;
+      }
+    }
+  }
+  if (trans->out)
+    trans->out += n;
+  if (trans->in)
+    trans->in += n;
+}
+
+void FastLED_Action::setLedControllerHasChanges(CLEDController *controller)
+{
+  setLedControllerHasChanges(controller, 0, 0xFFFF);
+}
+
+void FastLED_Action::setLedControllerHasChanges(CLEDController *controller,
+                                                uint16_t first, uint16_t count)
+{
+  ControllerEntry *entry = _controllerEntry(controller, true);
+  if (!entry)
+    return;
+  entry->dirty = true;
+  uint32_t end = (uint32_t)first + count;
+  if (first < entry->dirtyFirst)
+    entry->dirtyFirst = first;
+  if (end > entry->dirtyEnd)
+    entry->dirtyEnd = end > 0xFFFF ? 0xFFFF : end;
+
+  // blocks within range, so sparse changes stays sparse
+  uint16_t size = controller->size(),
+           blockCnt = _blockCount(*entry);
+  if (end > size)
+    end = size;
+  if (first >= end)
+    return;
+  if (!entry->dirtyBlocks) {
+    entry->dirtyBlocks = memNew<uint8_t>(MemoryStats::Engine, (blockCnt + 7) >> 3);
+    entry->blockCount = blockCnt;
+    memset(entry->dirtyBlocks, 0, (blockCnt + 7) >> 3);
+  }
+  for(uint16_t blk = first >> POWER_BLOCK_SHIFT,
+               lastBlk = (end -1) >> POWER_BLOCK_SHIFT; blk <= lastBlk; ++blk)
+  {
+    entry->dirtyBlocks[blk >> 3] |= 1 << (blk & 7);
+  }
+}
+
+// static
+uint16_t FastLED_Action::_blockCount(const ControllerEntry &entry)
+{
+  return (entry.controller->size() + (1 << POWER_BLOCK_SHIFT) -1) >>
+            POWER_BLOCK_SHIFT;
+}
+
+void FastLED_Action::setSupplyLimit(uint8_t supply, uint32_t milliamps)
+{
+  if (supply < MAX_SUPPLY_COUNT)
+    m_supplyLimit[supply] = milliamps;
+}
+
+uint32_t FastLED_Action::supplyLimit(uint8_t supply) const
+{
+  return supply < MAX_SUPPLY_COUNT ? m_supplyLimit[supply] : 0;
+}
+
+void FastLED_Action::setControllerSupply(CLEDController *controller,
+                                         uint8_t supply)
+{
+  ControllerEntry *entry = _controllerEntry(controller, true);
+  if (entry && supply < MAX_SUPPLY_COUNT)
+    entry->supply = supply;
+}
+
+uint32_t FastLED_Action::estimatedMilliamps(CLEDController *controller)
+{
+  ControllerEntry *entry = _controllerEntry(controller, false);
+  return entry && entry->blocks ? _milliamps(*entry) : 0;
+}
+
+void FastLED_Action::setOutputCorrection(CLEDController *controller,
+                                         OutputCorrection *correction)
+{
+  ControllerEntry *entry = _controllerEntry(controller, true);
+  if (entry) {
+    entry->correction = correction;
+    entry->dirty = true; // resend with new correction
+  }
+}
+
+OutputCorrection *FastLED_Action::outputCorrection(CLEDController *controller)
+{
+  ControllerEntry *entry = _controllerEntry(controller, false);
+  return entry ? entry->correction : nullptr;
 }
 
 bool FastLED_Action::ledControllerHasChanges(CLEDController *controller)
 {
-  for(int i = 0; i < MAX_CHANNEL_COUNT; ++i) {
-    CLEDController *cont = m_dirtyControllers[i];
-    if (cont == controller)
-      return true; // already dirty
+  ControllerEntry *entry = _controllerEntry(controller, false);
+  return entry && entry->dirty;
+}
+
+bool FastLED_Action::ledControllerHasChanges(CLEDController *controller,
+                                             uint16_t first, uint16_t count)
+{
+  ControllerEntry *entry = _controllerEntry(controller, false);
+  if (!entry || !entry->dirty || first >= entry->dirtyEnd ||
+      (uint32_t)first + count <= entry->dirtyFirst || count == 0)
+  {
+    return false;
+  }
+  uint16_t size = controller->size();
+  uint32_t end = (uint32_t)first + count;
+  if (end > entry->dirtyEnd)
+    end = entry->dirtyEnd;
+  if (end > size)
+    end = size;
+  if (first >= end)
+    return true; // beyond leds, only range is known
+  if (first < entry->dirtyFirst)
+    first = entry->dirtyFirst;
+  for(uint16_t blk = first >> POWER_BLOCK_SHIFT,
+               lastBlk = (end -1) >> POWER_BLOCK_SHIFT; blk <= lastBlk; ++blk)
+  {
+    if (_blockDirty(*entry, blk))
+      return true;
   }
   return false;
 }
 
 // --------------------------------------------------------------------
 
+uint16_t LedRun::firstLedIdx() const
+{
+  const CRGB *lowest = stride < 0 && size > 0 ? &(*this)[size -1] : leds;
+  return lowest - controller->leds();
+}
+
+uint16_t LedRun::span() const
+{
+  if (size == 0)
+    return 0;
+  return (size -1) * (uint16_t)(stride < 0 ? -stride : stride) + 1;
+}
+
+LedRun LedRun::slice(uint16_t first, uint16_t count) const
+{
+  LedRun run = *this;
+  run.leds = &(*this)[first];
+  run.size = count;
+  return run;
+}
+
+void LedRun::fill(const CRGB &color) const
+{
+  if (size == 0)
+    return;
+  if (stride == 1 || stride == -1) {
+    // same leds in memory either way
+    fill_solid(stride < 0 ? &(*this)[size -1] : leds, size, color);
+  } else {
+    for (uint16_t i = 0; i < size; ++i)
+      (*this)[i] = color;
+  }
+}
+
+void LedRun::write(uint16_t first, const CRGB *src, uint16_t count) const
+{
+  if (stride == 1) {
+    memmove(&leds[first], src, count * sizeof(CRGB));
+  } else {
+    for (uint16_t i = 0; i < count; ++i)
+      (*this)[first + i] = src[i];
+  }
+}
+
+// --------------------------------------------------------------------
+
 SegmentPart::SegmentPart(CLEDController *controller,
                          uint8_t firstLed,
                          uint8_t nLeds) :
     m_firstIdx(firstLed), m_nLeds(nLeds),
-    m_ledController(controller)
+    m_ledController(controller), m_engine(nullptr),
+    m_stride(1), m_offset(0), m_reversed(false)
 {
   if (controller)
     _checkLedsWithinBounds();
@@ -176,19 +970,73 @@ void SegmentPart::setLedController(CLEDController *controller)
 {
   m_ledController = controller;
   _checkLedsWithinBounds();
+  _layoutChanged();
 }
 
 CRGB *SegmentPart::operator [] (uint8_t idx) const
 {
-  uint16_t i = m_firstIdx + idx;
+  if (idx >= m_nLeds)
+    return nullptr;
+  uint16_t pos = idx + m_offset;
+  if (pos >= m_nLeds)
+    pos -= m_nLeds;
+  if (m_reversed)
+    pos = m_nLeds -1 - pos;
+  uint16_t i = m_firstIdx + pos * m_stride;
   if (m_ledController->size() <= (int)i)
     return nullptr;
   return &m_ledController->leds()[i];
 }
 
+void SegmentPart::setReversed(bool reversed)
+{
+  m_reversed = reversed;
+  _layoutChanged();
+}
+
+void SegmentPart::setStride(uint8_t stride)
+{
+  m_stride = stride > 0 ? stride : 1;
+  if (m_ledController)
+    _checkLedsWithinBounds();
+  _layoutChanged();
+}
+
+void SegmentPart::setOffset(uint8_t offset)
+{
+  m_offset = m_nLeds > 0 ? offset % m_nLeds : 0;
+  _layoutChanged();
+}
+
+uint8_t SegmentPart::runs(LedRun *runs) const
+{
+  if (m_nLeds == 0 || !m_ledController)
+    return 0;
+  CRGB *leds = &m_ledController->leds()[m_firstIdx];
+  int16_t stride = m_reversed ? -m_stride : m_stride;
+
+  // logical 0 is at position offset, positions before it comes last
+  runs[0].controller = m_ledController;
+  runs[0].leds = &leds[(m_reversed ? m_nLeds -1 - m_offset : m_offset) * m_stride];
+  runs[0].size = m_nLeds - m_offset;
+  runs[0].stride = stride;
+  if (m_offset == 0)
+    return 1;
+  runs[1].controller = m_ledController;
+  runs[1].leds = &leds[(m_reversed ? m_nLeds -1 : 0) * m_stride];
+  runs[1].size = m_offset;
+  runs[1].stride = stride;
+  return 2;
+}
+
 void SegmentPart::dirty()
 {
-  FastLED_Action::instance().setLedControllerHasChanges(m_ledController);
+  dirty(FastLED_Action::instance());
+}
+
+void SegmentPart::dirty(FastLED_Action &engine)
+{
+  engine.setLedControllerHasChanges(m_ledController, m_firstIdx, span());
 }
 
 void SegmentPart::_checkLedsWithinBounds()
@@ -196,22 +1044,56 @@ void SegmentPart::_checkLedsWithinBounds()
   // safetycheck
   if (m_firstIdx >= m_ledController->size())
     m_firstIdx = m_ledController->size() -1;
-  if (m_firstIdx + m_nLeds >= m_ledController->size())
-    m_nLeds = m_ledController->size() - m_firstIdx;
+  if (m_firstIdx + span() > m_ledController->size())
+    m_nLeds = (m_ledController->size() - m_firstIdx -1) / m_stride +1;
 }
 
 // --------------------------------------------------------------------
 
-SegmentCommon::SegmentCommon(typeEnum type) :
+SegmentCommon::SegmentCommon(typeEnum type, FastLED_Action *engine) :
     ActionsContainer(),
-    m_type(type), m_halted(false)
+    m_engine(engine ? engine : &FastLED_Action::instance()),
+    m_type(type), m_brightness(255), m_halted(false)
 {
-  FastLED_Action::registerItem(this);
+  m_engine->attach(this);
 }
 
 SegmentCommon::~SegmentCommon()
 {
-  FastLED_Action::unregisterItem(this);
+  m_engine->_endTransition(this);
+  m_engine->detach(this);
+}
+
+void SegmentCommon::setEngine(FastLED_Action *engine)
+{
+  if (!engine)
+    engine = &FastLED_Action::instance();
+  if (engine == m_engine)
+    return;
+
+  // only items not owned by a compound is looped directly by engine
+  if (m_engine->isAttached(this)) {
+    m_engine->detach(this);
+    engine->attach(this);
+  }
+  m_engine->_endTransition(this);
+  m_engine = engine;
+
+  if (m_type == T_Compound) {
+    SegmentCompound *comp = static_cast<SegmentCompound*>(this);
+    for(uint16_t i = 0; i < comp->segmentSize(); ++i)
+      comp->segmentAt(i)->setEngine(engine);
+    for(uint16_t i = 0; i < comp->compoundSize(); ++i)
+      comp->compoundAt(i)->setEngine(engine);
+  }
+}
+
+void SegmentCommon::setBrightness(uint8_t brightness)
+{
+  if (brightness == m_brightness)
+    return;
+  m_brightness = brightness;
+  dirty(); // resend with new brightness
 }
 
 bool SegmentCommon::halted() const
@@ -226,22 +1108,42 @@ void SegmentCommon::setHalted(bool halt)
 
 void SegmentCommon::loop()
 {
+  FastLED_Action::TransitionSlot *fade = m_engine->_transitionBefore(this);
   if (!m_halted && m_actions.length()) {
     ActionBase *action = m_actions[m_currentIdx];
     action->loop(this);
   }
+  if (fade && fade->item == this)
+    m_engine->_transitionAfter(fade);
+}
+
+void SegmentCommon::nextAction()
+{
+  ActionsContainer::nextAction();
+  ActionBase *next = currentAction();
+  if (!next)
+    return;
+  uint16_t ms = next->transitionTime();
+  if (ms == ActionBase::OWNER_TRANSITION)
+    ms = m_transitionMs;
+  if (ms > 0)
+    m_engine->_beginTransition(this, ms);
 }
 
 void SegmentCommon::dirty()
 {
   // do upcast to correct type
   switch(m_type){
-  case T_Segment: {
-    Segment *seg = reinterpret_cast<Segment*>(this);
+  case T_Segment: case T_Indexed: case T_Mirror: case T_Matrix: {
+    Segment *seg = static_cast<Segment*>(this);
+    seg->dirty();
+  }  break;
+  case T_Gather: {
+    GatherSegment *seg = static_cast<GatherSegment*>(this);
     seg->dirty();
   }  break;
   case T_Compound: {
-    SegmentCompound *comp = reinterpret_cast<SegmentCompound*>(this);
+    SegmentCompound *comp = static_cast<SegmentCompound*>(this);
     comp->dirty();
   }  break;
   default:
@@ -249,6 +1151,27 @@ void SegmentCommon::dirty()
   }
 }
 
+void SegmentCommon::setLed(uint16_t idx, const CRGB &color)
+{
+  // do upcast to correct type
+  switch(m_type){
+  case T_Segment: case T_Indexed: case T_Mirror: case T_Matrix: {
+    Segment *seg = static_cast<Segment*>(this);
+    seg->setLed(idx, color);
+  }  break;
+  case T_Gather: {
+    GatherSegment *seg = static_cast<GatherSegment*>(this);
+    seg->setLed(idx, color);
+  }  break;
+  case T_Compound: {
+    SegmentCompound *comp = static_cast<SegmentCompound*>(this);
+    comp->setLed(idx, color);
+  }  break;
+  default:
+    break; // do nothing
+  }
+}
+
 uint32_t SegmentCommon::yieldUntilAction(uint16_t noOfActions)
 {
   ActionBase *action = currentAction();
@@ -261,7 +1184,7 @@ uint32_t SegmentCommon::yieldUntilAction(uint16_t noOfActions)
   do {
     action = currentAction();
     if (action && !action->isRunning())
-      FastLED_Action::loop();
+      m_engine->update();
     while(action && action->isRunning()) {
       yield();
       this->loop();
@@ -283,7 +1206,7 @@ uint32_t SegmentCommon::yieldUntilAction(ActionBase &action)
   do {
     curAction = currentAction();
     if (!curAction->isRunning())
-      FastLED_Action::loop();
+      m_engine->update();
     while(curAction->isRunning()) {
       yield();
       ::loop();// loop in root *.ino file
@@ -295,18 +1218,35 @@ uint32_t SegmentCommon::yieldUntilAction(ActionBase &action)
 
 // --------------------------------------------------------------------
 
-Segment::Segment() :
-    SegmentCommon(T_Segment)
+Segment::Segment(FastLED_Action *engine) :
+    SegmentCommon(T_Segment, engine),
+    m_layout(nullptr), m_layoutGeneration(0), m_offset(0), m_size(0),
+    m_layoutSize(0), m_layoutCapacity(0), m_layoutParts(0),
+    m_reversed(false), m_wrap(false)
+{
+}
+
+Segment::Segment(typeEnum type, FastLED_Action *engine) :
+    SegmentCommon(type, engine),
+    m_layout(nullptr), m_layoutGeneration(0), m_offset(0), m_size(0),
+    m_layoutSize(0), m_layoutCapacity(0), m_layoutParts(0),
+    m_reversed(false), m_wrap(false)
 {
 }
 
 Segment::~Segment()
 {
+  memDelete(MemoryStats::Layout, m_layout, m_layoutCapacity);
+  MemoryStats::freed(MemoryStats::Lists,
+                     m_segmentParts.length() * MemoryStats::LIST_NODE);
 }
 
 void Segment::addSegmentPart(SegmentPart *part)
 {
   m_segmentParts.push(part);
+  MemoryStats::allocated(MemoryStats::Lists, MemoryStats::LIST_NODE);
+  part->m_engine = m_engine;
+  m_engine->layoutChanged();
 }
 
 size_t Segment::segmentPartSize() const
@@ -316,7 +1256,11 @@ size_t Segment::segmentPartSize() const
 
 void Segment::removeSegmentPart(size_t idx)
 {
+  if (idx >= m_segmentParts.length())
+    return;
   m_segmentParts.remove(idx);
+  MemoryStats::freed(MemoryStats::Lists, MemoryStats::LIST_NODE);
+  m_engine->layoutChanged();
 }
 
 SegmentPart* Segment::segmentPartAt(size_t idx)
@@ -331,64 +1275,183 @@ Segment::PartsList &Segment::segmentPartsList()
 
 CRGB *Segment::operator[] (uint16_t idx)
 {
-  uint16_t led = 0;
-  for (SegmentPart *part = m_segmentParts.first();
-      m_segmentParts.canMove(); part = m_segmentParts.next())
-  {
-    if (led + part->size() > idx) {
-      return (*part)[idx - led]; // found it!
-    }
-    led += part->size();
+  if (!_layoutValid())
+    _compile();
+  if (idx >= m_size) {
+    if (!m_wrap || m_size == 0)
+      return nullptr;
+    idx %= m_size;
+  }
+  for (uint16_t i = 0; i < m_layoutSize; ++i) {
+    const LedRun &run = m_layout[i];
+    if (idx < run.size)
+      return &run[idx]; // found it!
+    idx -= run.size;
   }
   return nullptr;
 }
 
+uint16_t Segment::forEachRun(LedRunCallback cb, void *ctx, uint16_t firstIdx)
+{
+  if (!_layoutValid())
+    _compile();
+  // index based and a copy of run, cb might change our layout
+  for (uint16_t i = 0; i < m_layoutSize; ++i) {
+    LedRun run = m_layout[i];
+    cb(run, firstIdx, ctx);
+    firstIdx += run.size;
+  }
+  return firstIdx;
+}
+
 uint16_t Segment::size()
 {
-  uint16_t sz = 0;
-  for (SegmentPart *part = m_segmentParts.first();
-      m_segmentParts.canMove(); part = m_segmentParts.next())
-  {
-    sz += part->size();
+  if (!_layoutValid())
+    _compile();
+  return m_size;
+}
+
+void Segment::setReversed(bool reversed)
+{
+  m_reversed = reversed;
+  m_engine->layoutChanged();
+}
+
+void Segment::setOffset(uint16_t offset)
+{
+  m_offset = offset;
+  m_engine->layoutChanged();
+}
+
+static void reverseRuns(LedRun *runs, uint16_t first, uint16_t end)
+{
+  while (first + 1 < end) {
+    LedRun tmp = runs[first];
+    runs[first++] = runs[--end];
+    runs[end] = tmp;
   }
-  return sz;
+}
+
+uint16_t Segment::_sourceRunCount()
+{
+  // each part is 1 or 2 runs
+  return m_segmentParts.length() * 2;
+}
+
+uint16_t Segment::_sourceRuns(LedRun *runs)
+{
+  uint16_t cnt = 0;
+  for (uint8_t i = 0; i < m_segmentParts.length(); ++i)
+    cnt += m_segmentParts[i]->runs(&runs[cnt]);
+  return cnt;
+}
+
+void Segment::_compile()
+{
+  // segment offset might split 1 more run
+  uint16_t capacity = _sourceRunCount() + 1;
+  if (capacity != m_layoutCapacity) {
+    memDelete(MemoryStats::Layout, m_layout, m_layoutCapacity);
+    m_layout = memNew<LedRun>(MemoryStats::Layout, capacity);
+    m_layoutCapacity = capacity;
+  }
+  uint16_t cnt = _sourceRuns(m_layout);
+  m_size = 0;
+  for (uint16_t r = 0; r < cnt; ++r)
+    m_size += m_layout[r].size;
+
+  if (m_reversed) {
+    reverseRuns(m_layout, 0, cnt);
+    for (uint16_t i = 0; i < cnt; ++i) {
+      LedRun &run = m_layout[i];
+      run.leds = &run[run.size -1];
+      run.stride = -run.stride;
+    }
+  }
+
+  uint16_t offset = m_size > 0 ? m_offset % m_size : 0;
+  if (offset > 0) {
+    // split run at offset, then rotate so it comes first
+    uint16_t i = 0;
+    while (offset >= m_layout[i].size)
+      offset -= m_layout[i++].size;
+    if (offset > 0) {
+      for (uint16_t r = cnt; r > i + 1; --r)
+        m_layout[r] = m_layout[r -1];
+      m_layout[i + 1] = m_layout[i].slice(offset, m_layout[i].size - offset);
+      m_layout[i].size = offset;
+      ++cnt;
+      ++i;
+    }
+    reverseRuns(m_layout, 0, cnt);
+    reverseRuns(m_layout, 0, cnt - i);
+    reverseRuns(m_layout, cnt - i, cnt);
+  }
+
+  m_layoutSize = cnt;
+  m_layoutParts = m_segmentParts.length();
+  m_layoutGeneration = m_engine->layoutGeneration();
 }
 
 void Segment::dirty()
 {
-  for(auto part = m_segmentParts.begin();
-      m_segmentParts.canMove();
-      part = m_segmentParts.next())
-  {
-    part->dirty();
+  // from layout, so leds that are not from parts are marked as well
+  if (!_layoutValid())
+    _compile();
+  for (uint16_t i = 0; i < m_layoutSize; ++i) {
+    const LedRun &run = m_layout[i];
+    m_engine->setLedControllerHasChanges(run.controller, run.firstLedIdx(),
+                                         run.span());
+  }
+}
+
+void Segment::setLed(uint16_t idx, const CRGB &color)
+{
+  if (!_layoutValid())
+    _compile();
+  if (idx >= m_size) {
+    if (!m_wrap || m_size == 0)
+      return;
+    idx %= m_size;
+  }
+  for (uint16_t i = 0; i < m_layoutSize; ++i) {
+    const LedRun &run = m_layout[i];
+    if (idx < run.size) {
+      CRGB &led = run[idx];
+      led = color;
+      m_engine->setLedControllerHasChanges(run.controller,
+                                           &led - run.controller->leds(), 1);
+      return;
+    }
+    idx -= run.size;
   }
 }
 
 // -----------------------------------------------------------
 
-SegmentCompound::SegmentCompound() :
-    SegmentCommon(T_Compound)
+SegmentCompound::SegmentCompound(FastLED_Action *engine) :
+    SegmentCommon(T_Compound, engine)
 {
 }
 
 SegmentCompound::~SegmentCompound()
 {
-  // re-register segments to loop control
-  for(uint16_t i = 0; i < m_segments.length(); ++i) {
-    removeSegmentByIdx(i);
-  }
+  // re-register segments to loop control, list shrinks each time
+  while(m_segments.length())
+    removeSegmentByIdx(0);
 
   // re-register compounds to loop control
-  for(uint16_t i = 0; i < m_compounds.length(); ++i) {
-    removeCompoundByIdx(i);
-  }
+  while(m_compounds.length())
+    removeCompoundByIdx(0);
 }
 
 void SegmentCompound::addSegment(Segment *segment)
 {
-  FastLED_Action::unregisterItem(segment); // unregister loop control,
-                                           // controlled by this Compound
+  segment->engine()->detach(segment); // unregister loop control,
+                                      // controlled by this Compound
+  segment->setEngine(m_engine);
   m_segments.push(segment);
+  MemoryStats::allocated(MemoryStats::Lists, MemoryStats::LIST_NODE);
 }
 
 size_t SegmentCompound::segmentSize() const
@@ -398,16 +1461,19 @@ size_t SegmentCompound::segmentSize() const
 
 void SegmentCompound::removeSegment(Segment *segment)
 {
-  for(uint16_t i = 0; i < m_segments.length(); ++i) {
+  for(uint16_t i = 0; i < m_segments.length();) {
     if (m_segments[i] == segment)
       removeSegmentByIdx(i);
+    else
+      ++i;
   }
 }
 
 void SegmentCompound::removeSegmentByIdx(size_t idx)
 {
-  FastLED_Action::registerItem(m_segments[idx]); // re-register for loop control
+  m_engine->attach(m_segments[idx]); // re-register for loop control
   m_segments.remove(idx);
+  MemoryStats::freed(MemoryStats::Lists, MemoryStats::LIST_NODE);
 }
 
 Segment* SegmentCompound::segmentAt(size_t idx)
@@ -443,6 +1509,16 @@ CRGB* SegmentCompound::operator [](uint16_t idx)
   return nullptr;
 }
 
+uint16_t SegmentCompound::forEachRun(LedRunCallback cb, void *ctx, uint16_t firstIdx)
+{
+  // same order as operator [], local segments first
+  for (size_t i = 0; i < m_segments.length(); ++i)
+    firstIdx = m_segments[i]->forEachRun(cb, ctx, firstIdx);
+  for (size_t i = 0; i < m_compounds.length(); ++i)
+    firstIdx = m_compounds[i]->forEachRun(cb, ctx, firstIdx);
+  return firstIdx;
+}
+
 uint16_t SegmentCompound::size()
 {
   uint16_t sz = 0;
@@ -462,9 +1538,11 @@ uint16_t SegmentCompound::size()
 
 void SegmentCompound::addCompound(SegmentCompound *compound)
 {
-  FastLED_Action::unregisterItem(compound); // loop is controlled by this
-                                          // compound from here on
+  compound->engine()->detach(compound); // loop is controlled by this
+                                        // compound from here on
+  compound->setEngine(m_engine);
   m_compounds.push(compound);
+  MemoryStats::allocated(MemoryStats::Lists, MemoryStats::LIST_NODE);
 }
 
 size_t SegmentCompound::compoundSize() const
@@ -474,16 +1552,19 @@ size_t SegmentCompound::compoundSize() const
 
 void SegmentCompound::removeCompound(SegmentCompound *compound)
 {
-  for(uint16_t i = 0; i < m_compounds.length(); ++i) {
+  for(uint16_t i = 0; i < m_compounds.length();) {
     if (m_compounds[i] == compound)
       removeCompoundByIdx(i);
+    else
+      ++i;
   }
 }
 
 void SegmentCompound::removeCompoundByIdx(size_t idx)
 {
-  FastLED_Action::registerItem(m_compounds[idx]);// re-register for loop control
+  m_engine->attach(m_compounds[idx]);// re-register for loop control
   m_compounds.remove(idx);
+  MemoryStats::freed(MemoryStats::Lists, MemoryStats::LIST_NODE);
 }
 
 SegmentCompound* SegmentCompound::compoundAt(size_t idx)
@@ -492,12 +1573,36 @@ SegmentCompound* SegmentCompound::compoundAt(size_t idx)
 }
 
 
+void SegmentCompound::setLed(uint16_t idx, const CRGB &color)
+{
+  // same order as operator []
+  uint16_t led = 0;
+  for (Segment *segment = m_segments.first();
+      m_segments.canMove(); segment = m_segments.next())
+  {
+    if (led + segment->size() > idx) {
+      segment->SegmentCommon::setLed(idx - led, color); // by type
+      return;
+    }
+    led += segment->size();
+  }
+  for (SegmentCompound *compound = m_compounds.first();
+      m_compounds.canMove(); compound = m_compounds.next())
+  {
+    if (led + compound->size() > idx) {
+      compound->setLed(idx - led, color);
+      return;
+    }
+    led += compound->size();
+  }
+}
+
 void SegmentCompound::dirty()
 {
    for (Segment *segment = m_segments.first();
        m_segments.canMove(); segment = m_segments.next())
    {
-     segment->dirty();
+     segment->SegmentCommon::dirty(); // by type
    }
 
    for(SegmentCompound *comp = m_compounds.first();
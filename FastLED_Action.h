@@ -31,24 +31,192 @@
 class SegmentCommon;
 class Segment;
 class SegmentCompound;
+class FrameRecorder;
+class OutputCorrection;
+struct LedRun;
 
+/**
+ * @brief: the engine that loops segments and renders to LED controllers
+ *         a default instance is constructed during boot and is what the
+ *         static API works on, more instances can be constructed to run
+ *         independent programs, each instance owns its own segments,
+ *         controller registry and stats
+ *         NOTE! a LED controller should only be driven by one instance
+ */
 class FastLED_Action {
+  friend class SegmentCommon;
+public:
+  struct Stats {
+    uint32_t loops,        // how many times update() has run
+             frames,       // how many renders that had any changes
+             shows;        // how many times a controller was sent
+    uint32_t renderMicros; // time spent in last render that had changes
+    uint32_t dirtyBlocks;  // blocks of 16 leds sent changed in last render
+    uint32_t milliamps;    // estimated draw of all controllers, before limit
+    int32_t headroom;      // mA left on the tightest power limit,
+                           // negative when limiting, NO_POWER_LIMIT if none
+    uint8_t powerScale;    // lowest brightness set by power limit, 255 none
+  };
+
+  static const uint8_t MAX_SUPPLY_COUNT = 4,
+                       MAX_POST_PROCESS = 4,
+                       MAX_TRANSITIONS = 4;
+  /// called with item each update, after actions and before render
+  typedef void (*PostProcessCallback)(SegmentCommon *item, void *ctx);
+  static const int32_t NO_POWER_LIMIT = 0x7FFFFFFF;
+  /// power model in mA at full on, same as FastLED power_mgt
+  static const uint8_t POWER_RED_MA = 16,
+                       POWER_GREEN_MA = 11,
+                       POWER_BLUE_MA = 15,
+                       POWER_IDLE_MA = 1;
+
+private:
+  struct ControllerEntry {
+    CLEDController *controller;
+    OutputCorrection *correction;
+    uint32_t *blocks;      // power sum of each block of leds
+    uint8_t *dirtyBlocks;  // changed blocks since last render, 1 bit each
+    CRGB *dimmed;          // leds dimmed by segment brightness, while any is
+    uint32_t draw;         // sum of blocks
+    uint16_t dirtyFirst,   // changed range since last render
+             dirtyEnd,
+             blockCount,   // blocks allocated for
+             dimmedSize;
+    uint8_t supply,
+            brightness;    // set by power limit
+    bool dirty;
+  };
+  struct DimCtx;
+  struct PostProcessEntry {
+    PostProcessCallback cb;
+    SegmentCommon *item;
+    void *ctx;
+  };
+  struct TransitionSlot {
+    SegmentCommon *item;  // nullptr when free
+    CRGB *frames;         // outgoing frame, then incoming action output
+    uint32_t start;
+    uint16_t capacity,    // leds each frame has room for
+             size,        // leds of item when started
+             duration;
+    bool incoming;        // second frame is valid
+  };
+  struct TransitionCtx;
+  static const uint8_t POWER_BLOCK_SHIFT = 4; // 16 leds in each block
   DListDynamic<SegmentCommon*> m_items;
   static const uint8_t MAX_CHANNEL_COUNT = 10; // how many LED i/o port we can have
-  CLEDController* m_dirtyControllers[MAX_CHANNEL_COUNT];
+  ControllerEntry m_controllers[MAX_CHANNEL_COUNT];
+  Stats m_stats;
+  FrameRecorder *m_recorder;
+  PostProcessEntry m_postProcess[MAX_POST_PROCESS];
+  TransitionSlot m_transitions[MAX_TRANSITIONS];
+  uint8_t m_postProcessCount;
+  CRGB *m_scratch;        // corrected output, leds stays linear
+  CRGB *m_filterLine;     // segment in logical order, for filters
+  uint16_t m_scratchSize,
+           m_filterLineSize;
+  uint32_t m_powerLimit,
+           m_supplyLimit[MAX_SUPPLY_COUNT];
+  uint32_t m_layoutGeneration;
+  uint8_t m_frameMs;
   static FastLED_Action s_instance;
-  void _registerItem(SegmentCommon *item);
-  void _unregisterItem(SegmentCommon *item);
   void _render();
+  const CRGB *_output(ControllerEntry &entry);
+  bool _anyDimmed();
+  /// changed blocks of entry.dimmed copied and dimmed again
+  void _updateDimmed(ControllerEntry &entry);
+  static void _dimRun(const LedRun &run, uint16_t logicalIdx, void *ctx);
+  bool _powerLimited() const;
+  void _updateDraw(ControllerEntry &entry);
+  static uint16_t _blockCount(const ControllerEntry &entry);
+  static bool _blockDirty(const ControllerEntry &entry, uint16_t blk) {
+    return !entry.dirtyBlocks || (entry.dirtyBlocks[blk >> 3] & (1 << (blk & 7)));
+  }
+  void _limitPower();
+  static uint32_t _milliamps(const ControllerEntry &entry);
+  bool _dimmed(SegmentCommon *item);
+  void _dim(SegmentCommon *item, DimCtx &ctx, uint8_t brightness);
+  void _prepare(SegmentCommon *item, uint8_t type);
   void _clearActions(SegmentCommon *item);
+  void _beginTransition(SegmentCommon *item, uint16_t duration);
+  TransitionSlot *_transitionBefore(SegmentCommon *item);
+  void _transitionAfter(TransitionSlot *slot);
+  void _endTransition(SegmentCommon *item);
+  static void _transitionRun(const LedRun &run, uint16_t logicalIdx, void *ctx);
+  ControllerEntry *_controllerEntry(CLEDController *controller, bool create);
   void program(); // must implement in root *.ino file
 public:
   FastLED_Action();
   ~FastLED_Action();
 
-  /// register a new item that should be called each loop
+  /// attach a new item that should be called each update
+  void attach(SegmentCommon *item);
+  /// detach a item from being called on each update
+  void detach(SegmentCommon *item);
+  /// true if item is looped directly by this instance
+  bool isAttached(SegmentCommon *item);
+  /// loop all attached items and render changes, call from loop()
+  void update();
+  /// remove all actions from all items in this instance
+  void clearActions();
+  /// counters for this instance
+  const Stats &stats() const { return m_stats; }
+  void resetStats();
+  /// record each frame sent to controllers, nullptr stops recording
+  /// controllers are identified by the order they first got changes
+  void setRecorder(FrameRecorder *recorder) { m_recorder = recorder; }
+  FrameRecorder *recorder() const { return m_recorder; }
+  /// shortest time between ticks for actions that schedules themselves,
+  /// ie the time it takes to show a frame
+  uint8_t frameTime() const { return m_frameMs; }
+  void setFrameTime(uint8_t ms) { m_frameMs = ms > 0 ? ms : 1; }
+  /// correct gamma, balance and channel order each time controller is sent
+  /// nullptr sends leds as they are
+  void setOutputCorrection(CLEDController *controller,
+                           OutputCorrection *correction);
+  OutputCorrection *outputCorrection(CLEDController *controller);
+
+  /// run cb on item each update after actions, ie a filter
+  /// stages runs in the order they were added, false if full
+  bool addPostProcess(PostProcessCallback cb, SegmentCommon *item, void *ctx);
+  void removePostProcess(SegmentCommon *item, void *ctx);
+
+  /// allocate all transition slots for items up to leds, so a cross fade
+  /// never allocates, else a slot grows the first time it is too small
+  void reserveTransitions(uint16_t leds);
+  /// true while item cross fades between actions
+  bool inTransition(SegmentCommon *item) const;
+  /// bytes held by transition slots
+  uint32_t transitionMemory() const;
+
+  /// scratch line for filters of this instance, grows to the largest
+  /// size asked for and is kept until released
+  CRGB *filterLine(uint16_t size);
+  uint16_t filterLineSize() const { return m_filterLineSize; }
+  void releaseFilterLine();
+
+  /// max current of all controllers in mA, 0 is no limit
+  /// leds are dimmed when sent if estimated draw is above limit
+  void setPowerLimit(uint32_t milliamps) { m_powerLimit = milliamps; }
+  uint32_t powerLimit() const { return m_powerLimit; }
+  /// max current of a power supply in mA, 0 is no limit
+  void setSupplyLimit(uint8_t supply, uint32_t milliamps);
+  uint32_t supplyLimit(uint8_t supply) const;
+  /// which supply powers controller, all are on supply 0 by default
+  void setControllerSupply(CLEDController *controller, uint8_t supply);
+  /// estimated draw of controller in mA, only tracked when a limit is set
+  /// estimate is from leds dimmed by segment brightness, but before
+  /// correction, so it errs on the safe side
+  uint32_t estimatedMilliamps(CLEDController *controller);
+
+  /// bumps each time a part or segment of this instance changes layout,
+  /// segments recompiles
+  uint32_t layoutGeneration() const { return m_layoutGeneration; }
+  void layoutChanged() { ++m_layoutGeneration; }
+
+  /// register a new item in default instance
   static void registerItem(SegmentCommon *item);
-  /// unregister a item form beeing called on each loop
+  /// unregister a item from default instance
   static void unregisterItem(SegmentCommon *item);
   /// gets a ref to global singleton of this class
   static FastLED_Action &instance();
@@ -61,19 +229,60 @@ public:
 
   /// triggers a resend on each LED controller list
   void setLedControllerHasChanges(CLEDController *controller);
+  /// same but only count leds from first has changed
+  void setLedControllerHasChanges(CLEDController *controller,
+                                  uint16_t first, uint16_t count);
   bool ledControllerHasChanges(CLEDController *controller);
+  /// true if any led from first has changed since last render
+  bool ledControllerHasChanges(CLEDController *controller,
+                               uint16_t first, uint16_t count);
 };
 
 // ----------------------------------------------------------
 
+/**
+ * @brief: a run of leds in a LED controllers buffer, evenly spaced
+ *         stride is 1 for leds next to each other in logical order,
+ *         negative when wired backwards
+ */
+struct LedRun {
+  CLEDController *controller;
+  CRGB *leds;       // first led of run, in logical order
+  uint16_t size;    // how many leds
+  int16_t stride;   // from one led to next
+
+  CRGB &operator [] (uint16_t idx) const { return leds[(int32_t)idx * stride]; }
+  /// true if leds are next to each other in logical order, ie memcpy
+  bool contiguous() const { return stride == 1; }
+  /// idx in controllers buffer of the lowest led in run
+  uint16_t firstLedIdx() const;
+  /// how many leds in controllers buffer the run stretches over
+  uint16_t span() const;
+  /// the leds from idx first
+  LedRun slice(uint16_t first, uint16_t count) const;
+  void fill(const CRGB &color) const;
+  /// copy count leds from src into run, from idx first
+  void write(uint16_t first, const CRGB *src, uint16_t count) const;
+};
+
+/// called for each run, logicalIdx is the segments idx of first led in run
+typedef void (*LedRunCallback)(const LedRun &run, uint16_t logicalIdx, void *ctx);
+
+// ----------------------------------------------------------
+
 /**
  * @breif: a segment of leds within a single LED data out
  */
 
 class SegmentPart {
+  friend class Segment;
   uint8_t m_firstIdx,
            m_nLeds;
   CLEDController *m_ledController;
+  FastLED_Action *m_engine; // of segment it was added to
+  uint8_t m_stride,
+          m_offset;
+  bool m_reversed;
 
 public:
   SegmentPart(CLEDController *controller, uint8_t firstLed, uint8_t nLeds);
@@ -83,13 +292,39 @@ public:
   CLEDController *ledController() { return m_ledController; }
 
   uint8_t firstLedIdx() const { return m_firstIdx; }
-  uint8_t lastLedIdx() const { return m_firstIdx + m_nLeds; }
+  /// idx after last led on strip
+  uint8_t lastLedIdx() const { return m_firstIdx + span(); }
   uint16_t size() const { return m_nLeds; }
+  /// how many leds on strip from first to last
+  uint16_t span() const { return m_nLeds ? (m_nLeds -1) * m_stride +1 : 0; }
   CRGB *operator [] (uint8_t idx) const;
 
+  // transform from logical order to strip, segments compiles it
+  // into their layout so actions always see logical order
+  /// wired backwards, logical first led is last on strip
+  bool reversed() const { return m_reversed; }
+  void setReversed(bool reversed);
+  /// leds are stride apart on strip, ie 2 for every other led
+  uint8_t stride() const { return m_stride; }
+  void setStride(uint8_t stride);
+  /// logical first led is offset leds in, leds before wraps to end
+  /// ie a ring where data in is not at top
+  uint8_t offset() const { return m_offset; }
+  void setOffset(uint8_t offset);
+
+  /// this part as runs in controllers buffer, in logical order
+  /// 2 runs when offset, returns how many
+  uint8_t runs(LedRun *runs) const;
+
+  /// mark controller as changed in default instance
   void dirty();
+  void dirty(FastLED_Action &engine);
 private:
   void _checkLedsWithinBounds();
+  void _layoutChanged() {
+    if (m_engine)
+      m_engine->layoutChanged();
+  }
 };
 
 
@@ -100,11 +335,24 @@ private:
  */
 class SegmentCommon : public ActionsContainer {
 public:
-  enum typeEnum : uint8_t { T_InValid, T_Segment, T_Compound };
-  explicit SegmentCommon(typeEnum type);
+  /// T_Indexed is a IndexedSegment, T_Mirror a MirrorSegment, T_Matrix
+  /// a MatrixSegment and T_Gather a GatherSegment, all are Segments
+  enum typeEnum : uint8_t { T_InValid, T_Segment, T_Compound, T_Indexed,
+                            T_Mirror, T_Matrix, T_Gather };
+  /// engine nullptr means default instance
+  explicit SegmentCommon(typeEnum type, FastLED_Action *engine = nullptr);
   virtual ~SegmentCommon();
 
   typeEnum type() const { return m_type; }
+  /// true for Segment and its subclasses
+  bool isSegment() const { return m_type != T_Compound && m_type != T_InValid; }
+
+  /// the engine instance this segment renders through
+  FastLED_Action *engine() const { return m_engine; }
+  /// move to engine, nullptr means default instance
+  /// sub segments of a compound follows
+  void setEngine(FastLED_Action *engine);
+  void setEngine(FastLED_Action &engine) { setEngine(&engine); }
 
   // halted status
   bool halted() const;
@@ -117,8 +365,23 @@ public:
   virtual CRGB* operator [] (uint16_t idx) = 0;
   virtual uint16_t size() = 0;
 
+  /// calls cb for each contiguous run of leds in logical order
+  /// firstIdx is the logical idx of first run, returns idx after last run
+  virtual uint16_t forEachRun(LedRunCallback cb, void *ctx,
+                              uint16_t firstIdx = 0) = 0;
+
+  /// switch to next action, cross fades into it if a transition is set
+  void nextAction();
+
   void dirty();
+  /// write one led and mark only it as changed, cheaper than dirty()
+  /// for effects that touches a few leds each frame
+  void setLed(uint16_t idx, const CRGB &color);
 
+  /// master brightness, 255 is full, applied when rendered so leds keeps
+  /// their colors, multiplies with brightness of parent compounds
+  uint8_t brightness() const { return m_brightness; }
+  void setBrightness(uint8_t brightness);
 
   /// waits for next action to occur
   /// if duration is 0 (forever action) or if we are halted
@@ -129,7 +392,9 @@ public:
   uint32_t yieldUntilAction(ActionBase &action);
 
 protected:
+  FastLED_Action *m_engine;
   typeEnum m_type;
+  uint8_t m_brightness;
   bool m_halted;
 };
 
@@ -142,7 +407,7 @@ protected:
 class Segment : public SegmentCommon {
 public:
   typedef DListDynamic<SegmentPart*> PartsList;
-  explicit Segment();
+  explicit Segment(FastLED_Action *engine = nullptr);
   ~Segment();
 
   // add a subsegment to this segment, built up of several SegmentParts
@@ -158,10 +423,46 @@ public:
   // LEDs
   CRGB *operator [] (uint16_t idx);
   uint16_t size();
+  uint16_t forEachRun(LedRunCallback cb, void *ctx, uint16_t firstIdx = 0);
 
   void dirty();
+  void setLed(uint16_t idx, const CRGB &color);
+
+  // transform of all parts, applied after each parts own transform
+  /// logical first led is last led of last part
+  bool reversed() const { return m_reversed; }
+  void setReversed(bool reversed);
+  /// logical first led is offset leds in, leds before wraps to end
+  uint16_t offset() const { return m_offset; }
+  void setOffset(uint16_t offset);
+  /// operator [] wraps idx beyond size around, instead of nullptr
+  bool wrap() const { return m_wrap; }
+  void setWrap(bool wrap) { m_wrap = wrap; }
+
+protected:
+  // for subclasses, ie IndexedSegment
+  Segment(typeEnum type, FastLED_Action *engine);
+  /// runs layout is compiled from, before reverse and offset of segment
+  /// runs of parts, a subclass with leds from elsewhere adds its own
+  virtual uint16_t _sourceRunCount();
+  virtual uint16_t _sourceRuns(LedRun *runs);
 private:
   PartsList m_segmentParts;
+  LedRun *m_layout;       // compiled runs in logical order
+  uint32_t m_layoutGeneration;
+  uint16_t m_offset,
+           m_size,
+           m_layoutSize,
+           m_layoutCapacity;
+  uint8_t m_layoutParts;  // parts when compiled
+  bool m_reversed,
+       m_wrap;
+
+  void _compile();
+  bool _layoutValid() const {
+    return m_layout && m_layoutGeneration == m_engine->layoutGeneration() &&
+           m_layoutParts == m_segmentParts.length();
+  }
 };
 
 // -----------------------------------------------------------
@@ -174,7 +475,7 @@ class SegmentCompound : public SegmentCommon {
 public:
   typedef DListDynamic<Segment*> SegmentList;
   typedef DListDynamic<SegmentCompound*> CompoundList;
-  explicit SegmentCompound();
+  explicit SegmentCompound(FastLED_Action *engine = nullptr);
   ~SegmentCompound();
 
   /// add segment to to this compound
@@ -200,8 +501,10 @@ public:
   // LEDs
   CRGB *operator [] (uint16_t idx);
   uint16_t size();
+  uint16_t forEachRun(LedRunCallback cb, void *ctx, uint16_t firstIdx = 0);
 
   void dirty();
+  void setLed(uint16_t idx, const CRGB &color);
 
 private:
   SegmentList m_segments;
@@ -0,0 +1,366 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  Filters.cpp
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#include "Filters.h"
+#include "Memory.h"
+
+#if defined(FASTLED_ACTION_HOST) && defined(__SSE2__)
+# include <emmintrin.h>
+# define FILTERS_SSE2 1
+#endif
+
+struct GatherCtx {
+  CRGB *leds;
+  uint16_t size;
+};
+
+// static
+const CRGB *FilterLine::gather(SegmentCommon *seg, uint16_t &size)
+{
+  size = seg->size();
+  if (size == 0)
+    return nullptr;
+  CRGB *leds = seg->engine()->filterLine(size);
+  GatherCtx ctx = { leds, size };
+  seg->forEachRun(&FilterLine::_gatherRun, &ctx);
+  return leds;
+}
+
+// static
+void FilterLine::_gatherRun(const LedRun &run, uint16_t logicalIdx, void *ctx)
+{
+  GatherCtx *gather = static_cast<GatherCtx*>(ctx);
+  if (logicalIdx >= gather->size)
+    return;
+  uint16_t count = gather->size - logicalIdx;
+  if (count > run.size)
+    count = run.size;
+  if (run.contiguous()) {
+    memcpy(&gather->leds[logicalIdx], run.leds, count * sizeof(CRGB));
+  } else {
+    for (uint16_t i = 0; i < count; ++i)
+      gather->leds[logicalIdx + i] = run[i];
+  }
+}
+
+// ----------------------------------------------------
+
+struct FilterConvolve::RunCtx {
+  const FilterConvolve *self;
+  const uint8_t *line;
+  uint16_t size;
+  FastLED_Action *engine;
+};
+
+FilterConvolve::FilterConvolve()
+{
+  const int8_t identity[] = { 1 };
+  setKernel(identity, 1);
+}
+
+FilterConvolve::FilterConvolve(const int8_t *taps, uint8_t count,
+                               uint16_t divisor)
+{
+  setKernel(taps, count, divisor);
+}
+
+void FilterConvolve::setKernel(const int8_t *taps, uint8_t count,
+                               uint16_t divisor)
+{
+  if (count > MAX_TAPS)
+    count = MAX_TAPS;
+  int16_t sum = 0, absSum = 0;
+  bool positive = true;
+  for (uint8_t i = 0; i < count; ++i) {
+    m_taps[i] = taps[i];
+    sum += taps[i];
+    absSum += taps[i] < 0 ? -taps[i] : taps[i];
+    positive = positive && taps[i] >= 0;
+  }
+  m_count = count;
+  if (divisor == 0)
+    divisor = sum > 0 ? sum : 1;
+  m_divisor = divisor;
+  m_half = divisor >> 1;
+
+  if ((divisor & (divisor -1)) == 0) {
+    m_shift = 0;
+    while ((1U << m_shift) < divisor)
+      ++m_shift;
+    m_recip = 0;
+  } else {
+    m_shift = 0xFF;
+    m_recip = (65536UL + divisor -1) / divisor;
+  }
+
+  // which 16 bit path can sum this kernel without overflow
+  if (positive && sum <= (int16_t)divisor && m_shift != 0xFF && divisor <= 256)
+    m_mode = UnsignedShift;
+  else if (positive && sum <= (int16_t)divisor && m_shift == 0xFF &&
+           divisor <= 16)
+    m_mode = UnsignedRecip;
+  else if (m_shift != 0xFF && (int32_t)absSum * 255 + m_half <= 0x7FFF)
+    m_mode = SignedShift;
+  else
+    m_mode = Scalar;
+}
+
+void FilterConvolve::apply(SegmentCommon *seg) const
+{
+  uint16_t size;
+  const CRGB *line = FilterLine::gather(seg, size);
+  if (!line)
+    return;
+  RunCtx ctx = { this, reinterpret_cast<const uint8_t*>(line), size,
+                 seg->engine() };
+  seg->forEachRun(&FilterConvolve::_convolveRun, &ctx);
+}
+
+uint8_t FilterConvolve::_channel(const uint8_t *line, uint16_t size,
+                                 uint16_t led, uint8_t ch) const
+{
+  int32_t sum = m_half;
+  int16_t radius = m_count >> 1;
+  for (uint8_t t = 0; t < m_count; ++t) {
+    int32_t j = (int32_t)led + t - radius;
+    if (j < 0)
+      j = 0;
+    else if (j >= size)
+      j = size -1;
+    sum += m_taps[t] * line[j * 3 + ch];
+  }
+  return _scale(sum);
+}
+
+uint8_t FilterConvolve::_scale(int32_t sum) const
+{
+  if (sum <= 0)
+    return 0;
+  if (m_shift != 0xFF) {
+    sum >>= m_shift;
+    return sum > 255 ? 255 : sum;
+  }
+  if (sum >= (int32_t)m_divisor << 8)
+    return 255;
+  return ((uint32_t)sum * m_recip) >> 16;
+}
+
+void FilterConvolve::_interior(const uint8_t *src, uint8_t *dst,
+                               uint16_t bytes) const
+{
+  // all taps are inside line, src is first center byte
+  const uint8_t *first = src - (m_count >> 1) * 3;
+  uint16_t b = 0;
+
+#ifdef FILTERS_SSE2
+  if (m_mode != Scalar) {
+    const __m128i zero = _mm_setzero_si128(),
+                  half = _mm_set1_epi16(m_half),
+                  recip = _mm_set1_epi16((int16_t)m_recip),
+                  shift = _mm_cvtsi32_si128(m_shift);
+    for (; b + 16 <= bytes; b += 16) {
+      __m128i lo = half, hi = half;
+      for (uint8_t t = 0; t < m_count; ++t) {
+        __m128i v = _mm_loadu_si128(
+                      reinterpret_cast<const __m128i*>(first + b + t * 3)),
+                w = _mm_set1_epi16(m_taps[t]);
+        lo = _mm_add_epi16(lo, _mm_mullo_epi16(_mm_unpacklo_epi8(v, zero), w));
+        hi = _mm_add_epi16(hi, _mm_mullo_epi16(_mm_unpackhi_epi8(v, zero), w));
+      }
+      switch (m_mode) {
+      case UnsignedShift:
+        lo = _mm_srl_epi16(lo, shift);
+        hi = _mm_srl_epi16(hi, shift);
+        break;
+      case UnsignedRecip:
+        lo = _mm_mulhi_epu16(lo, recip);
+        hi = _mm_mulhi_epu16(hi, recip);
+        break;
+      default:
+        lo = _mm_sra_epi16(lo, shift);
+        hi = _mm_sra_epi16(hi, shift);
+        break;
+      }
+      // packus clamps negative sums to 0
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + b),
+                       _mm_packus_epi16(lo, hi));
+    }
+  }
+#endif
+
+  for (; b < bytes; ++b) {
+    int32_t sum = m_half;
+    for (uint8_t t = 0; t < m_count; ++t)
+      sum += m_taps[t] * first[b + t * 3];
+    dst[b] = _scale(sum);
+  }
+}
+
+// static
+void FilterConvolve::_convolveRun(const LedRun &run, uint16_t logicalIdx,
+                                  void *ctx)
+{
+  RunCtx *conv = static_cast<RunCtx*>(ctx);
+  const FilterConvolve *self = conv->self;
+  uint16_t radius = self->m_count >> 1,
+           first = logicalIdx,
+           end = logicalIdx + run.size;
+  if (end > conv->size)
+    end = conv->size;
+  if (first >= end)
+    return;
+
+  // leds that has all taps inside line, only for contiguous runs
+  uint16_t inFirst = end, inEnd = end;
+  if (run.contiguous()) {
+    inFirst = first > radius ? first : radius;
+    inEnd = conv->size > radius ? conv->size - radius : 0;
+    if (inEnd > end)
+      inEnd = end;
+    if (inFirst >= inEnd)
+      inFirst = inEnd = end;
+    else
+      self->_interior(conv->line + inFirst * 3,
+                      reinterpret_cast<uint8_t*>(&run.leds[inFirst - first]),
+                      (inEnd - inFirst) * 3);
+  }
+
+  // ends and strided runs clamps each tap
+  for (uint16_t led = first; led < end; ++led) {
+    if (led == inFirst)
+      led = inEnd;
+    if (led >= end)
+      break;
+    CRGB &out = run[led - first];
+    for (uint8_t ch = 0; ch < 3; ++ch)
+      out.raw[ch] = self->_channel(conv->line, conv->size, led, ch);
+  }
+
+  conv->engine->setLedControllerHasChanges(run.controller, run.firstLedIdx(),
+                                           run.span());
+}
+
+// ----------------------------------------------------
+
+FilterBlur::FilterBlur(uint8_t radius, Shape shape) :
+    m_radius(radius > MAX_RADIUS ? MAX_RADIUS : radius),
+    m_shape(shape)
+{
+  _buildKernel();
+}
+
+void FilterBlur::setRadius(uint8_t radius)
+{
+  m_radius = radius > MAX_RADIUS ? MAX_RADIUS : radius;
+  _buildKernel();
+}
+
+void FilterBlur::setShape(Shape shape)
+{
+  m_shape = shape;
+  _buildKernel();
+}
+
+void FilterBlur::apply(SegmentCommon *seg) const
+{
+  if (m_radius > 0)
+    m_kernel.apply(seg);
+}
+
+void FilterBlur::_buildKernel()
+{
+  int8_t taps[FilterConvolve::MAX_TAPS];
+  uint8_t count = m_radius * 2 + 1;
+  if (m_shape == Box) {
+    for (uint8_t i = 0; i < count; ++i)
+      taps[i] = 1;
+  } else {
+    // row 2 * radius of pascals triangle, sums to 4^radius
+    taps[0] = 1;
+    for (uint8_t row = 1; row < count; ++row) {
+      taps[row] = 1;
+      for (uint8_t i = row -1; i > 0; --i)
+        taps[i] += taps[i -1];
+    }
+  }
+  m_kernel.setKernel(taps, count);
+}
+
+// ----------------------------------------------------
+
+struct FilterShift::RunCtx {
+  const FilterShift *self;
+  const CRGB *line;
+  uint16_t size;
+  int16_t steps;
+  FastLED_Action *engine;
+};
+
+FilterShift::FilterShift(int16_t steps, bool rotate, CRGB fill) :
+    m_fill(fill), m_steps(steps), m_rotate(rotate)
+{
+}
+
+void FilterShift::apply(SegmentCommon *seg) const
+{
+  uint16_t size;
+  const CRGB *line = FilterLine::gather(seg, size);
+  if (!line)
+    return;
+  int16_t steps = m_steps;
+  if (m_rotate) {
+    steps %= (int16_t)size;
+    if (steps == 0)
+      return;
+  }
+  RunCtx ctx = { this, line, size, steps, seg->engine() };
+  seg->forEachRun(&FilterShift::_shiftRun, &ctx);
+}
+
+// static
+void FilterShift::_shiftRun(const LedRun &run, uint16_t logicalIdx, void *ctx)
+{
+  RunCtx *shift = static_cast<RunCtx*>(ctx);
+  int32_t size = shift->size;
+
+  // each chunk is a contiguous range of line, or fill
+  for (uint16_t i = 0; i < run.size;) {
+    int32_t src = (int32_t)logicalIdx + i - shift->steps;
+    uint16_t chunk = run.size - i;
+    if (shift->self->m_rotate) {
+      src %= size;
+      if (src < 0)
+        src += size;
+    } else if (src < 0 || src >= size) {
+      if (src < 0 && chunk > -src)
+        chunk = -src;
+      run.slice(i, chunk).fill(shift->self->m_fill);
+      i += chunk;
+      continue;
+    }
+    if (chunk > size - src)
+      chunk = size - src;
+    run.write(i, &shift->line[src], chunk);
+    i += chunk;
+  }
+
+  shift->engine->setLedControllerHasChanges(run.controller, run.firstLedIdx(),
+                                            run.span());
+}
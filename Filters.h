@@ -0,0 +1,192 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  Filters.h
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#ifndef FILTERS_H_
+#define FILTERS_H_
+
+#include <stdint.h>
+#include "FastLED_Action.h"
+#include "Actions.h"
+
+/**
+ * @brief: scratch line shared by all filters of an engine instance
+ *         a segment is copied here in logical order, so a filter can read
+ *         neighbours across parts and controllers while it writes the
+ *         result back run by run
+ *         grows to the largest segment filtered
+ */
+class FilterLine {
+public:
+  /// copy seg into line, size is set to leds copied
+  static const CRGB *gather(SegmentCommon *seg, uint16_t &size);
+  /// bytes used by line of engine
+  static uint16_t memoryUsage(const FastLED_Action &engine) {
+    return engine.filterLineSize() * sizeof(CRGB);
+  }
+  /// free line of engine, next filter allocates again
+  static void release(FastLED_Action &engine) { engine.releaseFilterLine(); }
+
+private:
+  static void _gatherRun(const LedRun &run, uint16_t logicalIdx, void *ctx);
+};
+
+// ----------------------------------------------------
+
+/**
+ * @brief: convolve each color channel with a kernel of up to 9 taps
+ *         led i gets sum of taps[t] * led[i + t - count / 2] / divisor,
+ *         leds beyond the ends repeats the end led
+ *         on host the inner loop is SSE2 when kernel can be summed in
+ *         16 bits, result is the same as without
+ */
+class FilterConvolve {
+public:
+  static const uint8_t MAX_TAPS = 9;
+
+  /// identity kernel
+  FilterConvolve();
+  /// count should be odd, divisor 0 means sum of taps
+  explicit FilterConvolve(const int8_t *taps, uint8_t count,
+                          uint16_t divisor = 0);
+
+  void setKernel(const int8_t *taps, uint8_t count, uint16_t divisor = 0);
+  uint8_t count() const { return m_count; }
+  int8_t tap(uint8_t idx) const { return idx < m_count ? m_taps[idx] : 0; }
+  uint16_t divisor() const { return m_divisor; }
+
+  /// filter seg in place
+  void apply(SegmentCommon *seg) const;
+
+private:
+  enum Mode : uint8_t {
+    Scalar,          // no 16 bit path
+    UnsignedShift,   // taps >= 0, divisor a power of 2
+    UnsignedRecip,   // taps >= 0, small divisor
+    SignedShift      // small taps, divisor a power of 2
+  };
+  struct RunCtx;
+  int8_t m_taps[MAX_TAPS];
+  uint16_t m_divisor,
+           m_recip,  // 65536 / divisor rounded up
+           m_half;   // rounding
+  uint8_t m_count,
+          m_shift;   // 0xFF when divisor is not a power of 2
+  Mode m_mode;
+
+  uint8_t _channel(const uint8_t *line, uint16_t size,
+                   uint16_t led, uint8_t ch) const;
+  uint8_t _scale(int32_t sum) const;
+  void _interior(const uint8_t *src, uint8_t *dst, uint16_t bytes) const;
+  static void _convolveRun(const LedRun &run, uint16_t logicalIdx, void *ctx);
+};
+
+// ----------------------------------------------------
+
+/**
+ * @brief: 1D blur in logical order, box averages 2 * radius + 1 leds
+ *         gaussian weights them by binomial coefficients
+ */
+class FilterBlur {
+public:
+  enum Shape : uint8_t { Box, Gaussian };
+  static const uint8_t MAX_RADIUS = FilterConvolve::MAX_TAPS / 2;
+
+  explicit FilterBlur(uint8_t radius = 1, Shape shape = Gaussian);
+
+  uint8_t radius() const { return m_radius; }
+  void setRadius(uint8_t radius);
+  Shape shape() const { return m_shape; }
+  void setShape(Shape shape);
+
+  /// filter seg in place, radius 0 does nothing
+  void apply(SegmentCommon *seg) const;
+
+private:
+  FilterConvolve m_kernel;
+  uint8_t m_radius;
+  Shape m_shape;
+
+  void _buildKernel();
+};
+
+// ----------------------------------------------------
+
+/**
+ * @brief: move leds steps in logical order, positive is towards end
+ *         rotate wraps leds around, else vacated leds gets fill
+ */
+class FilterShift {
+public:
+  explicit FilterShift(int16_t steps = 1, bool rotate = true,
+                       CRGB fill = CRGB::Black);
+
+  int16_t steps() const { return m_steps; }
+  void setSteps(int16_t steps) { m_steps = steps; }
+  bool rotate() const { return m_rotate; }
+  void setRotate(bool rotate) { m_rotate = rotate; }
+  CRGB fill() const { return m_fill; }
+  void setFill(CRGB fill) { m_fill = fill; }
+
+  /// filter seg in place
+  void apply(SegmentCommon *seg) const;
+
+private:
+  struct RunCtx;
+  CRGB m_fill;
+  int16_t m_steps;
+  bool m_rotate;
+  static void _shiftRun(const LedRun &run, uint16_t logicalIdx, void *ctx);
+};
+
+// ----------------------------------------------------
+
+/**
+ * @brief: applies a filter each tick, ie blur a running animation
+ *         Filter is any of FilterBlur, FilterShift or FilterConvolve
+ *         put it on a compound to filter leds of its sub segments
+ */
+template<class Filter>
+class ActionFilter : public Action<ActionFilter<Filter> > {
+  friend class Action<ActionFilter<Filter> >;
+  Filter m_filter;
+public:
+  explicit ActionFilter(const Filter &filter, uint16_t stepTime = 50,
+                        uint32_t duration = 0) :
+    Action<ActionFilter<Filter> >(duration),
+    m_filter(filter)
+  {
+    this->m_updateTime = stepTime;
+  }
+
+  Filter &filter() { return m_filter; }
+
+private:
+  void onTick(SegmentCommon *owner) { m_filter.apply(owner); }
+};
+
+/// post process callback for a Filter
+/// engine.addPostProcess(filterPostProcess<FilterBlur>, &seg, &blur)
+template<class Filter>
+void filterPostProcess(SegmentCommon *item, void *filter)
+{
+  static_cast<Filter*>(filter)->apply(item);
+}
+
+#endif /* FILTERS_H_ */
@@ -0,0 +1,578 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  GatherSegment.cpp
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#include "GatherSegment.h"
+#include "Memory.h"
+
+struct RangeCtx {
+  uint16_t first;
+  int16_t stride;
+};
+
+static uint16_t listIdx(uint16_t i, const void *ctx)
+{
+  return static_cast<const uint16_t*>(ctx)[i];
+}
+
+static uint16_t rangeIdx(uint16_t i, const void *ctx)
+{
+  const RangeCtx *range = static_cast<const RangeCtx*>(ctx);
+  return range->first + (int32_t)i * range->stride;
+}
+
+// a delta is 1 byte, or escape, 2 bytes and escape again when it doesn't
+// fit, escaped at both ends so a list can be read backwards as well
+static const uint8_t DELTA_ESCAPE = 0x80;
+
+static uint8_t putDelta(uint8_t *deltas, uint16_t from, uint16_t to)
+{
+  int16_t delta = to - from;
+  if (delta >= -127 && delta <= 127) {
+    if (deltas)
+      deltas[0] = delta;
+    return 1;
+  }
+  if (deltas) {
+    deltas[0] = DELTA_ESCAPE;
+    deltas[1] = (uint16_t)delta & 0xFF;
+    deltas[2] = (uint16_t)delta >> 8;
+    deltas[3] = DELTA_ESCAPE;
+  }
+  return 4;
+}
+
+static uint16_t nextIdx(const uint8_t *deltas, uint16_t &at, uint16_t idx)
+{
+  uint8_t code = deltas[at++];
+  if (code != DELTA_ESCAPE)
+    return idx + (int8_t)code;
+  uint16_t delta = deltas[at] | (uint16_t)deltas[at +1] << 8;
+  at += 3;
+  return idx + delta;
+}
+
+static uint16_t prevIdx(const uint8_t *deltas, uint16_t &at, uint16_t idx)
+{
+  uint8_t code = deltas[--at];
+  if (code != DELTA_ESCAPE)
+    return idx - (int8_t)code;
+  at -= 3;
+  uint16_t delta = deltas[at +1] | (uint16_t)deltas[at +2] << 8;
+  return idx - delta;
+}
+
+// the part of run at pos that is within from, to
+static bool clipRun(const LedRun &run, uint16_t pos, uint16_t from,
+                    uint16_t to, LedRun &clipped)
+{
+  if (pos >= to || (uint32_t)pos + run.size <= from)
+    return false;
+  uint16_t first = from > pos ? from - pos : 0,
+           end = to - pos < run.size ? to - pos : run.size;
+  clipped = run.slice(first, end - first);
+  return true;
+}
+
+// -----------------------------------------------------------
+
+/// splits leds into runs of evenly spaced leds, long runs becomes ranges
+/// and the rest is appended to lists, entries and deltas nullptr only counts
+struct GatherSegment::Builder {
+  Entry *entries;
+  uint8_t *deltas;
+  uint32_t entryCount,
+           deltaCount;
+  Entry tail;         // last entry, written back when another is pushed
+  bool hasTail;
+
+  void begin(const GatherSegment &seg, Entry *toEntries, uint8_t *toDeltas) {
+    entries = toEntries;
+    deltas = toDeltas;
+    entryCount = seg.m_entryCount;
+    deltaCount = seg.m_deltaCount;
+    hasTail = entryCount > 0;
+    if (hasTail)
+      tail = seg.m_entries[entryCount -1];
+  }
+  void finish() {
+    if (hasTail && entries)
+      entries[entryCount -1] = tail;
+  }
+  void push(const Entry &entry) {
+    finish();
+    tail = entry;
+    hasTail = true;
+    ++entryCount;
+  }
+  void addLed(uint8_t slot, uint16_t idx) {
+    if (hasTail && tail.stride == LIST && tail.slot == slot &&
+        tail.count < 0xFFFF && deltaCount < 0xFFFC)
+    {
+      deltaCount += putDelta(deltas ? &deltas[deltaCount] : nullptr,
+                             tail.last, idx);
+      ++tail.count;
+      tail.last = idx;
+      return;
+    }
+    Entry entry = { idx, 1, LIST, (uint16_t)deltaCount, idx, slot };
+    push(entry);
+  }
+  void addRun(uint8_t slot, uint16_t first, uint16_t count, int16_t stride) {
+    if (hasTail && tail.stride != LIST && tail.slot == slot &&
+        (count == 1 || stride == tail.stride) &&
+        tail.first + (int32_t)tail.count * tail.stride == first &&
+        (uint32_t)tail.count + count <= 0xFFFF)
+    {
+      tail.count += count; // goes on from last range
+      return;
+    }
+    if (count >= MIN_RANGE_COUNT) {
+      Entry entry = { first, count, stride, 0, 0, slot };
+      push(entry);
+      return;
+    }
+    for (uint16_t i = 0; i < count; ++i)
+      addLed(slot, first + (int32_t)i * stride);
+  }
+  /// returns how many leds were within controller
+  uint32_t gather(uint8_t slot, uint16_t size, uint16_t count,
+                  uint16_t (*idxAt)(uint16_t i, const void *ctx),
+                  const void *ctx)
+  {
+    uint32_t added = 0;
+    uint16_t first = 0, runCount = 0;
+    int16_t stride = 1;
+    for (uint16_t i = 0; i < count; ++i) {
+      uint16_t idx = idxAt(i, ctx);
+      if (idx >= size)
+        continue;
+      ++added;
+      int32_t delta = (int32_t)idx - first;
+      if (runCount == 1 && delta != 0 && delta >= -32768 && delta <= 32767) {
+        // a second led sets stride, later ones must keep it
+        stride = delta;
+        ++runCount;
+        continue;
+      }
+      if (runCount > 1 && runCount < 0xFFFF && delta == (int32_t)runCount * stride) {
+        ++runCount;
+        continue;
+      }
+      if (runCount > 0)
+        addRun(slot, first, runCount, stride);
+      first = idx;
+      runCount = 1;
+      stride = 1;
+    }
+    if (runCount > 0)
+      addRun(slot, first, runCount, stride);
+    finish();
+    return added;
+  }
+};
+
+/// hands runs to cb in logical order, list leds evenly spaced are merged
+struct GatherSegment::WalkCtx {
+  LedRunCallback cb;
+  void *ctx;
+  uint16_t logicalIdx;
+  LedRun pending;     // list leds not handed to cb yet
+
+  void flush() {
+    if (pending.size == 0)
+      return;
+    LedRun run = pending;
+    pending.size = 0;
+    cb(run, logicalIdx, ctx);
+    logicalIdx += run.size;
+  }
+  void run(LedRun run, bool backward) {
+    flush();
+    if (backward) {
+      run.leds = &run[run.size -1];
+      run.stride = -run.stride;
+    }
+    cb(run, logicalIdx, ctx);
+    logicalIdx += run.size;
+  }
+  void led(CLEDController *controller, CRGB *led) {
+    if (pending.size > 0 && pending.controller == controller &&
+        pending.size < 0xFFFF)
+    {
+      int32_t delta = led - pending.leds;
+      if (pending.size == 1 && delta != 0 && delta >= -32768 && delta <= 32767) {
+        pending.stride = delta;
+        ++pending.size;
+        return;
+      }
+      if (pending.size > 1 && delta == (int32_t)pending.size * pending.stride) {
+        ++pending.size;
+        return;
+      }
+    }
+    flush();
+    pending.controller = controller;
+    pending.leds = led;
+    pending.size = 1;
+    pending.stride = 1;
+  }
+};
+
+// -----------------------------------------------------------
+
+GatherSegment::GatherSegment(FastLED_Action *engine) :
+    Segment(T_Gather, engine),
+    m_entries(nullptr),
+    m_deltas(nullptr),
+    m_generation(this->engine()->layoutGeneration()),
+    m_entryCount(0),
+    m_deltaCount(0),
+    m_ledCount(0),
+    m_partsSize(0),
+    m_cursorEntry(0), m_cursorPos(0), m_cursorLed(0),
+    m_cursorAt(0), m_cursorIdx(0),
+    m_controllerCount(0)
+{
+}
+
+GatherSegment::~GatherSegment()
+{
+  memDelete(MemoryStats::Layout, m_entries, m_entryCount);
+  memDelete(MemoryStats::Layout, m_deltas, m_deltaCount);
+}
+
+bool GatherSegment::addIndices(CLEDController *controller,
+                               const uint16_t *indices, uint16_t count)
+{
+  return _add(controller, count, listIdx, indices);
+}
+
+bool GatherSegment::addRange(CLEDController *controller, uint16_t first,
+                             uint16_t count, int16_t stride)
+{
+  RangeCtx ctx = { first, stride };
+  return _add(controller, count, rangeIdx, &ctx);
+}
+
+void GatherSegment::clear()
+{
+  memDelete(MemoryStats::Layout, m_entries, m_entryCount);
+  memDelete(MemoryStats::Layout, m_deltas, m_deltaCount);
+  m_entryCount = 0;
+  m_deltaCount = 0;
+  m_ledCount = 0;
+  m_controllerCount = 0;
+  engine()->layoutChanged();
+}
+
+uint16_t GatherSegment::rangeCount() const
+{
+  uint16_t cnt = 0;
+  for (uint16_t i = 0; i < m_entryCount; ++i)
+    cnt += m_entries[i].stride != LIST;
+  return cnt;
+}
+
+uint16_t GatherSegment::listCount() const
+{
+  return m_entryCount - rangeCount();
+}
+
+uint16_t GatherSegment::memoryUsage() const
+{
+  return m_entryCount * sizeof(Entry) + m_deltaCount;
+}
+
+CRGB *GatherSegment::operator [] (uint16_t idx)
+{
+  uint16_t sz = size();
+  if (idx >= sz) {
+    if (!wrap() || sz == 0)
+      return nullptr;
+    idx %= sz;
+  }
+  CLEDController *controller;
+  return _led(_position(idx), controller);
+}
+
+uint16_t GatherSegment::size()
+{
+  _refresh();
+  return m_partsSize + m_ledCount;
+}
+
+uint16_t GatherSegment::forEachRun(LedRunCallback cb, void *ctx,
+                                   uint16_t firstIdx)
+{
+  uint16_t sz = size();
+  if (sz == 0)
+    return firstIdx;
+  WalkCtx walk = { cb, ctx, firstIdx, LedRun() };
+  // from offset to end then from start, of positions backwards if reversed
+  uint16_t offset = this->offset() % sz;
+  if (reversed()) {
+    _walk(0, sz - offset, true, walk);
+    _walk(sz - offset, sz, true, walk);
+  } else {
+    _walk(offset, sz, false, walk);
+    _walk(0, offset, false, walk);
+  }
+  walk.flush();
+  return walk.logicalIdx;
+}
+
+void GatherSegment::dirty()
+{
+  forEachRun(&GatherSegment::_dirtyRun, engine());
+}
+
+void GatherSegment::setLed(uint16_t idx, const CRGB &color)
+{
+  uint16_t sz = size();
+  if (idx >= sz) {
+    if (!wrap() || sz == 0)
+      return;
+    idx %= sz;
+  }
+  CLEDController *controller;
+  CRGB *led = _led(_position(idx), controller);
+  if (!led)
+    return;
+  *led = color;
+  engine()->setLedControllerHasChanges(controller, led - controller->leds(), 1);
+}
+
+int8_t GatherSegment::_slot(CLEDController *controller)
+{
+  for (uint8_t i = 0; i < m_controllerCount; ++i) {
+    if (m_controllers[i] == controller)
+      return i;
+  }
+  if (m_controllerCount >= MAX_CONTROLLERS)
+    return -1;
+  m_controllers[m_controllerCount] = controller;
+  return m_controllerCount++;
+}
+
+bool GatherSegment::_add(CLEDController *controller, uint16_t count,
+                         uint16_t (*idxAt)(uint16_t i, const void *ctx),
+                         const void *ctx)
+{
+  if (!controller)
+    return false;
+  int8_t slot = _slot(controller);
+  if (slot < 0)
+    return false;
+  uint16_t size = controller->size();
+
+  // first count, so entries and deltas are allocated once with no slack
+  Builder build;
+  build.begin(*this, nullptr, nullptr);
+  uint32_t added = build.gather(slot, size, count, idxAt, ctx);
+  if (build.entryCount > 0xFFFF || build.deltaCount > 0xFFFF ||
+      m_partsSize + m_ledCount + added > 0xFFFF)
+  {
+    return false;
+  }
+  uint16_t entryCount = build.entryCount,
+           deltaCount = build.deltaCount;
+
+  if (entryCount > m_entryCount) {
+    Entry *entries = memNew<Entry>(MemoryStats::Layout, entryCount);
+    for (uint16_t i = 0; i < m_entryCount; ++i)
+      entries[i] = m_entries[i];
+    memDelete(MemoryStats::Layout, m_entries, m_entryCount);
+    m_entries = entries;
+  }
+  if (deltaCount > m_deltaCount) {
+    uint8_t *deltas = memNew<uint8_t>(MemoryStats::Layout, deltaCount);
+    if (m_deltaCount > 0)
+      memcpy(deltas, m_deltas, m_deltaCount);
+    memDelete(MemoryStats::Layout, m_deltas, m_deltaCount);
+    m_deltas = deltas;
+  }
+  build.begin(*this, m_entries, m_deltas);
+  build.gather(slot, size, count, idxAt, ctx);
+  m_entryCount = entryCount;
+  m_deltaCount = deltaCount;
+  m_ledCount += added;
+  engine()->layoutChanged();
+  return true;
+}
+
+void GatherSegment::_refresh()
+{
+  if (m_generation == engine()->layoutGeneration())
+    return;
+  m_partsSize = 0;
+  for (size_t p = 0; p < segmentPartSize(); ++p) {
+    LedRun runs[2];
+    uint8_t cnt = segmentPartAt(p)->runs(runs);
+    for (uint8_t r = 0; r < cnt; ++r)
+      m_partsSize += runs[r].size;
+  }
+  m_cursorEntry = m_cursorPos = m_cursorLed = 0;
+  if (m_entryCount > 0) {
+    m_cursorAt = m_entries[0].at;
+    m_cursorIdx = m_entries[0].first;
+  }
+  m_generation = engine()->layoutGeneration();
+}
+
+uint16_t GatherSegment::_position(uint16_t idx)
+{
+  // reversed first, then offset, as a segment compiles its layout
+  uint16_t sz = m_partsSize + m_ledCount,
+           pos = ((uint32_t)idx + offset() % sz) % sz;
+  return reversed() ? sz -1 - pos : pos;
+}
+
+CRGB *GatherSegment::_led(uint16_t pos, CLEDController *&controller)
+{
+  if (pos < m_partsSize) {
+    for (size_t p = 0; p < segmentPartSize(); ++p) {
+      LedRun runs[2];
+      uint8_t cnt = segmentPartAt(p)->runs(runs);
+      for (uint8_t r = 0; r < cnt; ++r) {
+        if (pos < runs[r].size) {
+          controller = runs[r].controller;
+          return &runs[r][pos];
+        }
+        pos -= runs[r].size;
+      }
+    }
+    return nullptr;
+  }
+  pos -= m_partsSize;
+
+  // step from entry of last read, reads in order are a step or none
+  uint16_t entryIdx = m_cursorEntry;
+  while (pos < m_cursorPos)
+    m_cursorPos -= m_entries[--m_cursorEntry].count;
+  while (pos >= m_cursorPos + m_entries[m_cursorEntry].count)
+    m_cursorPos += m_entries[m_cursorEntry++].count;
+  const Entry &entry = m_entries[m_cursorEntry];
+  if (m_cursorEntry != entryIdx) {
+    m_cursorLed = 0;
+    m_cursorAt = entry.at;
+    m_cursorIdx = entry.first;
+  }
+
+  controller = m_controllers[entry.slot];
+  uint16_t led = pos - m_cursorPos;
+  if (entry.stride != LIST)
+    return &controller->leds()[entry.first + (int32_t)led * entry.stride];
+  if (led < m_cursorLed && led < m_cursorLed - led) {
+    // closer from first led
+    m_cursorLed = 0;
+    m_cursorAt = entry.at;
+    m_cursorIdx = entry.first;
+  }
+  for (; m_cursorLed < led; ++m_cursorLed)
+    m_cursorIdx = nextIdx(m_deltas, m_cursorAt, m_cursorIdx);
+  for (; m_cursorLed > led; --m_cursorLed)
+    m_cursorIdx = prevIdx(m_deltas, m_cursorAt, m_cursorIdx);
+  return &controller->leds()[m_cursorIdx];
+}
+
+void GatherSegment::_walk(uint16_t from, uint16_t to, bool backward,
+                          WalkCtx &walk)
+{
+  LedRun clipped;
+  if (!backward) {
+    uint16_t pos = 0;
+    for (size_t p = 0; p < segmentPartSize() && pos < to; ++p) {
+      LedRun runs[2];
+      uint8_t cnt = segmentPartAt(p)->runs(runs);
+      for (uint8_t r = 0; r < cnt; pos += runs[r++].size) {
+        if (clipRun(runs[r], pos, from, to, clipped))
+          walk.run(clipped, false);
+      }
+    }
+    for (uint16_t e = 0; e < m_entryCount && pos < to; pos += m_entries[e++].count) {
+      const Entry &entry = m_entries[e];
+      if ((uint32_t)pos + entry.count <= from)
+        continue;
+      CLEDController *controller = m_controllers[entry.slot];
+      if (entry.stride != LIST) {
+        LedRun run = { controller, &controller->leds()[entry.first],
+                       entry.count, entry.stride };
+        if (clipRun(run, pos, from, to, clipped))
+          walk.run(clipped, false);
+        continue;
+      }
+      uint16_t idx = entry.first, at = entry.at;
+      for (uint16_t led = 0; ; ) {
+        if (pos + led >= from)
+          walk.led(controller, &controller->leds()[idx]);
+        if (++led >= entry.count || pos + led >= to)
+          break;
+        idx = nextIdx(m_deltas, at, idx);
+      }
+    }
+    return;
+  }
+
+  // backwards, from last entry to first part
+  uint16_t pos = m_partsSize + m_ledCount,
+           deltaEnd = m_deltaCount; // after deltas of list
+  for (uint16_t e = m_entryCount; e > 0 && pos > from; ) {
+    const Entry &entry = m_entries[--e];
+    uint16_t listEnd = deltaEnd;
+    if (entry.stride == LIST)
+      deltaEnd = entry.at;
+    pos -= entry.count;
+    if (pos >= to)
+      continue;
+    CLEDController *controller = m_controllers[entry.slot];
+    if (entry.stride != LIST) {
+      LedRun run = { controller, &controller->leds()[entry.first],
+                     entry.count, entry.stride };
+      if (clipRun(run, pos, from, to, clipped))
+        walk.run(clipped, true);
+      continue;
+    }
+    uint16_t idx = entry.last, at = listEnd;
+    for (uint16_t led = entry.count -1; ; --led) {
+      if (pos + led < to)
+        walk.led(controller, &controller->leds()[idx]);
+      if (led == 0 || pos + led <= from)
+        break;
+      idx = prevIdx(m_deltas, at, idx);
+    }
+  }
+  for (size_t p = segmentPartSize(); p > 0 && pos > from; ) {
+    LedRun runs[2];
+    uint8_t cnt = segmentPartAt(--p)->runs(runs);
+    for (uint8_t r = cnt; r > 0; ) {
+      pos -= runs[--r].size;
+      if (clipRun(runs[r], pos, from, to, clipped))
+        walk.run(clipped, true);
+    }
+  }
+}
+
+// static
+void GatherSegment::_dirtyRun(const LedRun &run, uint16_t logicalIdx, void *ctx)
+{
+  (void)logicalIdx;
+  static_cast<FastLED_Action*>(ctx)->setLedControllerHasChanges(
+      run.controller, run.firstLedIdx(), run.span());
+}
@@ -0,0 +1,109 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  GatherSegment.h
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#ifndef GATHERSEGMENT_H_
+#define GATHERSEGMENT_H_
+
+#include <stdint.h>
+#include "FastLED_Action.h"
+
+/**
+ * @brief: a segment of leds picked anywhere on its controllers, ie every
+ *         third led or points along a sculpture, in the order they are added
+ *         long runs of evenly spaced leds are stored as a range, the rest
+ *         as lists of deltas, 1 byte a led when next led is within 127
+ *         leds on strip is walked directly instead of a compiled layout,
+ *         list leds evenly spaced are handed to forEachRun as one run, so
+ *         bulk fills, blends and copies works on it as on any segment
+ *         SegmentParts can be added as well, their leds comes first
+ *         NOTE! max 8 controllers
+ */
+class GatherSegment : public Segment {
+public:
+  static const uint8_t MAX_CONTROLLERS = 8;
+  /// shorter runs of evenly spaced leds are stored in a list
+  static const uint8_t MIN_RANGE_COUNT = 16;
+
+  explicit GatherSegment(FastLED_Action *engine = nullptr);
+  ~GatherSegment();
+
+  /// append leds at indices of controller, in this order
+  /// indices outside of controller are skipped
+  /// false if controller is nullptr or there is no room for it
+  bool addIndices(CLEDController *controller, const uint16_t *indices,
+                  uint16_t count);
+  /// append count leds from first, stride apart, negative goes backwards
+  bool addRange(CLEDController *controller, uint16_t first, uint16_t count,
+                int16_t stride = 1);
+  /// remove all gathered leds
+  void clear();
+
+  /// ranges and lists leds are stored as
+  uint16_t rangeCount() const;
+  uint16_t listCount() const;
+  /// bytes used by ranges and lists
+  uint16_t memoryUsage() const;
+
+  // LEDs, reversed, offset and wrap of Segment applies
+  CRGB *operator [] (uint16_t idx);
+  uint16_t size();
+  uint16_t forEachRun(LedRunCallback cb, void *ctx, uint16_t firstIdx = 0);
+  void dirty();
+  void setLed(uint16_t idx, const CRGB &color);
+
+private:
+  struct Entry {
+    uint16_t first,   // led idx in controller
+             count;
+    int16_t stride;   // LIST when leds are deltas in m_deltas
+    uint16_t at,      // list, first delta in m_deltas
+             last;    // list, led idx of last led
+    uint8_t slot;     // in m_controllers
+  };
+  static const int16_t LIST = 0;
+  struct Builder;
+  struct WalkCtx;
+  CLEDController *m_controllers[MAX_CONTROLLERS];
+  Entry *m_entries;
+  uint8_t *m_deltas;
+  uint32_t m_generation;  // of engine when sizes were summed
+  uint16_t m_entryCount,
+           m_deltaCount,
+           m_ledCount,    // gathered, parts not included
+           m_partsSize,
+           // where operator [] was last, sequential reads steps from it
+           m_cursorEntry,
+           m_cursorPos,   // position of first led of entry
+           m_cursorLed,   // led in list, m_cursorAt and m_cursorIdx are of
+           m_cursorAt,
+           m_cursorIdx;
+  uint8_t m_controllerCount;
+
+  int8_t _slot(CLEDController *controller);
+  bool _add(CLEDController *controller, uint16_t count,
+            uint16_t (*idxAt)(uint16_t i, const void *ctx), const void *ctx);
+  void _refresh();
+  uint16_t _position(uint16_t idx);
+  CRGB *_led(uint16_t pos, CLEDController *&controller);
+  void _walk(uint16_t from, uint16_t to, bool backward, WalkCtx &walk);
+  static void _dirtyRun(const LedRun &run, uint16_t logicalIdx, void *ctx);
+};
+
+#endif /* GATHERSEGMENT_H_ */
@@ -0,0 +1,264 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  IndexedSegment.cpp
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#include "IndexedSegment.h"
+#include "Memory.h"
+
+IndexedSegment::IndexedSegment(uint8_t bitsPerLed, FastLED_Action *engine) :
+    Segment(T_Indexed, engine),
+    m_indices(nullptr), m_palette(nullptr),
+    m_count(0), m_paletteSize(0),
+    m_dirtyFirst(0xFFFF), m_dirtyEnd(0),
+    m_bits(bitsPerLed == 4 ? 4 : 8)
+{
+}
+
+IndexedSegment::~IndexedSegment()
+{
+  memDelete(MemoryStats::Layout, m_indices,
+            m_bits == 4 ? (m_count + 1) >> 1 : m_count);
+  memDelete(MemoryStats::Layout, m_palette, m_paletteSize);
+}
+
+void IndexedSegment::setPalette(const CRGB *colors, uint16_t count)
+{
+  uint16_t maxCount = m_bits == 4 ? 16 : 256;
+  if (count > maxCount)
+    count = maxCount;
+  if (count != m_paletteSize) {
+    memDelete(MemoryStats::Layout, m_palette, m_paletteSize);
+    if (count > 0)
+      m_palette = memNew<CRGB>(MemoryStats::Layout, count);
+    m_paletteSize = count;
+  }
+  for (uint16_t i = 0; i < count; ++i)
+    m_palette[i] = colors[i];
+  _changed(0, 0xFFFF);
+}
+
+CRGB IndexedSegment::paletteColor(uint8_t idx) const
+{
+  return idx < m_paletteSize ? m_palette[idx] : CRGB(CRGB::Black);
+}
+
+void IndexedSegment::setPaletteColor(uint8_t idx, CRGB color)
+{
+  if (idx >= m_paletteSize || m_palette[idx] == color)
+    return;
+  m_palette[idx] = color;
+  _changed(0, 0xFFFF);
+}
+
+static void reverseColors(CRGB *colors, uint16_t first, uint16_t end)
+{
+  while (first + 1 < end) {
+    CRGB tmp = colors[first];
+    colors[first++] = colors[--end];
+    colors[end] = tmp;
+  }
+}
+
+void IndexedSegment::rotatePalette(int16_t steps)
+{
+  int16_t n = m_paletteSize;
+  if (n < 2)
+    return;
+  steps %= n;
+  if (steps < 0)
+    steps += n;
+  if (steps == 0)
+    return;
+  // rotate by 3 reversals, no extra memory
+  reverseColors(m_palette, 0, n);
+  reverseColors(m_palette, 0, steps);
+  reverseColors(m_palette, steps, n);
+  _changed(0, 0xFFFF);
+}
+
+uint8_t IndexedSegment::index(uint16_t idx)
+{
+  if (!_ensureIndices(idx))
+    return 0;
+  return _index(idx);
+}
+
+void IndexedSegment::setIndex(uint16_t idx, uint8_t index)
+{
+  if (!_ensureIndices(idx))
+    return;
+  if (m_bits == 4) {
+    index &= 0x0F;
+    uint8_t shift = (idx & 1) << 2,
+            &byte = m_indices[idx >> 1];
+    if (((byte >> shift) & 0x0F) == index)
+      return;
+    byte = (byte & ~(0x0F << shift)) | (index << shift);
+  } else {
+    if (m_indices[idx] == index)
+      return;
+    m_indices[idx] = index;
+  }
+  _changed(idx, idx + 1);
+}
+
+void IndexedSegment::fillIndex(uint8_t index, uint16_t first, uint16_t count)
+{
+  uint16_t sz = size();
+  if (sz == 0 || first >= sz || !_ensureIndices(sz -1))
+    return;
+  uint16_t end = (uint32_t)first + count > sz ? sz : first + count;
+  if (m_bits == 8) {
+    memset(&m_indices[first], index, end - first);
+  } else {
+    // odd leds on the edges, whole bytes between
+    uint16_t i = first;
+    if ((i & 1) && i < end)
+      setIndex(i++, index);
+    uint16_t pairsEnd = end & ~1;
+    if (pairsEnd > i) {
+      index &= 0x0F;
+      memset(&m_indices[i >> 1], index | (index << 4), (pairsEnd - i) >> 1);
+      i = pairsEnd;
+    }
+    if (i < end)
+      setIndex(i, index);
+  }
+  _changed(first, end);
+}
+
+uint16_t IndexedSegment::memoryUsage() const
+{
+  uint16_t indices = m_bits == 4 ? (m_count + 1) >> 1 : m_count;
+  return indices + m_paletteSize * sizeof(CRGB);
+}
+
+void IndexedSegment::expand()
+{
+  uint16_t sz = size();
+  if (sz > m_count)
+    _ensureIndices(sz -1); // parts has been added
+  if (m_dirtyEnd > m_count)
+    m_dirtyEnd = m_count;
+  if (m_dirtyFirst >= m_dirtyEnd)
+    return;
+  forEachRun(&IndexedSegment::_expandRun, this);
+  m_dirtyFirst = 0xFFFF;
+  m_dirtyEnd = 0;
+}
+
+bool IndexedSegment::_ensureIndices(uint16_t idx)
+{
+  if (idx < m_count)
+    return true;
+  uint16_t sz = size();
+  if (idx >= sz)
+    return false;
+
+  // grow, new leds gets index 0
+  uint16_t bytes = m_bits == 4 ? (sz + 1) >> 1 : sz,
+           oldBytes = m_bits == 4 ? (m_count + 1) >> 1 : m_count;
+  uint8_t *indices = memNew<uint8_t>(MemoryStats::Layout, bytes);
+  if (m_indices)
+    memcpy(indices, m_indices, oldBytes);
+  memset(&indices[oldBytes], 0, bytes - oldBytes);
+  memDelete(MemoryStats::Layout, m_indices, oldBytes);
+  m_indices = indices;
+  _changed(m_count, sz);
+  m_count = sz;
+  return true;
+}
+
+void IndexedSegment::_changed(uint16_t first, uint16_t end)
+{
+  if (first < m_dirtyFirst)
+    m_dirtyFirst = first;
+  if (end > m_dirtyEnd)
+    m_dirtyEnd = end;
+}
+
+uint8_t IndexedSegment::_index(uint16_t idx) const
+{
+  if (m_bits == 4)
+    return (m_indices[idx >> 1] >> ((idx & 1) << 2)) & 0x0F;
+  return m_indices[idx];
+}
+
+CRGB IndexedSegment::_color(uint8_t index) const
+{
+  if (m_paletteSize == 0)
+    return CRGB::Black;
+  uint16_t i = index;
+  while (i >= m_paletteSize)
+    i -= m_paletteSize; // wrap around a short palette
+  return m_palette[i];
+}
+
+// static
+void IndexedSegment::_expandRun(const LedRun &run, uint16_t logicalIdx,
+                                void *ctx)
+{
+  IndexedSegment *self = static_cast<IndexedSegment*>(ctx);
+  uint16_t first = self->m_dirtyFirst > logicalIdx ?
+                      self->m_dirtyFirst : logicalIdx,
+           end = logicalIdx + run.size;
+  if (end > self->m_dirtyEnd)
+    end = self->m_dirtyEnd;
+  if (first >= end)
+    return;
+
+  LedRun changed = run.slice(first - logicalIdx, end - first);
+  for (uint16_t i = 0; i < changed.size; ++i)
+    changed[i] = self->_color(self->_index(first + i));
+  self->m_engine->setLedControllerHasChanges(run.controller,
+                                             changed.firstLedIdx(),
+                                             changed.span());
+}
+
+// ----------------------------------------------------
+
+ActionPaletteRotate::ActionPaletteRotate(int8_t step, uint16_t stepTime,
+                                         uint32_t duration) :
+    Action<ActionPaletteRotate>(duration),
+    m_step(step)
+{
+  m_updateTime = stepTime;
+}
+
+ActionPaletteRotate::~ActionPaletteRotate()
+{
+}
+
+void ActionPaletteRotate::onTick(SegmentCommon *owner)
+{
+  _rotate(owner);
+}
+
+void ActionPaletteRotate::_rotate(SegmentCommon *item)
+{
+  if (item->type() == SegmentCommon::T_Indexed) {
+    static_cast<IndexedSegment*>(item)->rotatePalette(m_step);
+  } else if (item->type() == SegmentCommon::T_Compound) {
+    SegmentCompound *comp = static_cast<SegmentCompound*>(item);
+    for (uint16_t i = 0, sz = comp->segmentSize(); i < sz; ++i)
+      _rotate(comp->segmentAt(i));
+    for (uint16_t i = 0, sz = comp->compoundSize(); i < sz; ++i)
+      _rotate(comp->compoundAt(i));
+  }
+}
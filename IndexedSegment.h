@@ -0,0 +1,101 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  IndexedSegment.h
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#ifndef INDEXEDSEGMENT_H_
+#define INDEXEDSEGMENT_H_
+
+#include <stdint.h>
+#include "FastLED_Action.h"
+
+/**
+ * @brief: a segment that stores a 4 or 8 bit palette index for each led
+ *         instead of a color, indices are expanded into the controllers
+ *         leds when engine renders, only for the range that has changed
+ *         changing the palette is O(palette), all leds are expanded
+ *         again on next render
+ *         actions that paint colors still works, but they are painted
+ *         over next time indices or palette changes
+ */
+class IndexedSegment : public Segment {
+public:
+  /// bitsPerLed is 4 (16 colors) or 8 (256 colors)
+  explicit IndexedSegment(uint8_t bitsPerLed = 8,
+                          FastLED_Action *engine = nullptr);
+  ~IndexedSegment();
+
+  uint8_t bitsPerLed() const { return m_bits; }
+
+  /// palette is copied, max 16 colors with 4 bits, 256 with 8 bits
+  void setPalette(const CRGB *colors, uint16_t count);
+  void setPalette(const CRGBPalette16 &palette) {
+    setPalette(palette.entries, 16);
+  }
+  uint16_t paletteSize() const { return m_paletteSize; }
+  CRGB paletteColor(uint8_t idx) const;
+  void setPaletteColor(uint8_t idx, CRGB color);
+  /// move colors steps up in palette, last colors wraps to first
+  void rotatePalette(int16_t steps = 1);
+
+  /// palette index of led at idx
+  uint8_t index(uint16_t idx);
+  void setIndex(uint16_t idx, uint8_t index);
+  void fillIndex(uint8_t index, uint16_t first = 0, uint16_t count = 0xFFFF);
+
+  /// bytes used for indices and palette
+  uint16_t memoryUsage() const;
+
+  /// expands changed indices into leds, called by engine before render
+  void expand();
+
+private:
+  uint8_t *m_indices;
+  CRGB *m_palette;
+  uint16_t m_count,       // how many leds indices has room for
+           m_paletteSize,
+           m_dirtyFirst,  // changed indices since last expand
+           m_dirtyEnd;
+  uint8_t m_bits;
+
+  bool _ensureIndices(uint16_t idx);
+  void _changed(uint16_t first, uint16_t end);
+  uint8_t _index(uint16_t idx) const;
+  CRGB _color(uint8_t index) const;
+  static void _expandRun(const LedRun &run, uint16_t logicalIdx, void *ctx);
+};
+
+// ----------------------------------------------------
+
+/**
+ * @brief: rotates palette of owner step colors each stepTime ms
+ *         a compound rotates the palettes of all its indexed segments
+ *         duration 0 rotates until stopped
+ */
+class ActionPaletteRotate : public Action<ActionPaletteRotate> {
+  friend class Action<ActionPaletteRotate>;
+  int8_t m_step;
+  void onTick(SegmentCommon *owner);
+  void _rotate(SegmentCommon *item);
+public:
+  explicit ActionPaletteRotate(int8_t step = 1, uint16_t stepTime = 50,
+                               uint32_t duration = 0);
+  virtual ~ActionPaletteRotate();
+};
+
+#endif /* INDEXEDSEGMENT_H_ */
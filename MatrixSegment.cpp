@@ -0,0 +1,235 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  MatrixSegment.cpp
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#include "MatrixSegment.h"
+#include "Memory.h"
+
+MatrixSegment::MatrixSegment(uint8_t width, uint8_t height, uint8_t wiring,
+                             FastLED_Action *engine) :
+    Segment(T_Matrix, engine),
+    m_xy(memNew<uint16_t>(MemoryStats::Layout, (uint16_t)width * height)),
+    m_xyGeneration(0),
+    m_width(width), m_height(height),
+    m_wiring(wiring), m_rotation(0),
+    m_panelsX(1), m_panelsY(1),
+    m_controllerCount(0),
+    m_serpentinePanels(false), m_xyChanged(true)
+{
+}
+
+MatrixSegment::~MatrixSegment()
+{
+  memDelete(MemoryStats::Layout, m_xy, (uint16_t)m_width * m_height);
+}
+
+uint8_t MatrixSegment::width() const
+{
+  return m_rotation & 1 ? m_height : m_width;
+}
+
+uint8_t MatrixSegment::height() const
+{
+  return m_rotation & 1 ? m_width : m_height;
+}
+
+void MatrixSegment::setWiring(uint8_t wiring)
+{
+  m_wiring = wiring;
+  m_xyChanged = true;
+}
+
+void MatrixSegment::setRotation(uint8_t quarterTurns)
+{
+  m_rotation = quarterTurns & 3;
+  m_xyChanged = true;
+}
+
+bool MatrixSegment::setPanels(uint8_t panelsX, uint8_t panelsY, bool serpentine)
+{
+  if (panelsX == 0)
+    panelsX = 1;
+  if (panelsY == 0)
+    panelsY = 1;
+  // panels are equal, else a panel could be 0 leds wide
+  if (m_width % panelsX || m_height % panelsY)
+    return false;
+  m_panelsX = panelsX;
+  m_panelsY = panelsY;
+  m_serpentinePanels = serpentine;
+  m_xyChanged = true;
+  return true;
+}
+
+CRGB *MatrixSegment::xy(uint8_t x, uint8_t y)
+{
+  if (x >= width() || y >= height())
+    return nullptr;
+  if (!_xyValid())
+    _compileXY();
+  uint16_t entry = m_xy[(uint16_t)y * width() + x];
+  return entry != NOT_WIRED ? _led(entry) : nullptr;
+}
+
+uint16_t MatrixSegment::forEachRow(uint8_t y, LedRunCallback cb, void *ctx)
+{
+  if (y >= height())
+    return 0;
+  return _forEachLine((uint16_t)y * width(), 1, width(), cb, ctx);
+}
+
+uint16_t MatrixSegment::forEachColumn(uint8_t x, LedRunCallback cb, void *ctx)
+{
+  if (x >= width())
+    return 0;
+  return _forEachLine(x, width(), height(), cb, ctx);
+}
+
+uint16_t MatrixSegment::memoryUsage() const
+{
+  return (uint16_t)m_width * m_height * sizeof(uint16_t);
+}
+
+void MatrixSegment::_compileXY()
+{
+  uint16_t cells = (uint16_t)m_width * m_height;
+  for (uint16_t i = 0; i < cells; ++i)
+    m_xy[i] = NOT_WIRED;
+  m_controllerCount = 0;
+  forEachRun(&MatrixSegment::_mapRun, this);
+  m_xyGeneration = engine()->layoutGeneration();
+  m_xyChanged = false;
+}
+
+void MatrixSegment::_wiredXY(uint16_t wiringIdx, uint8_t &x, uint8_t &y) const
+{
+  uint8_t panelW = m_width / m_panelsX,
+          panelH = m_height / m_panelsY;
+  uint16_t panelSize = (uint16_t)panelW * panelH,
+           panel = wiringIdx / panelSize,
+           i = wiringIdx % panelSize;
+  uint8_t panelX = panel % m_panelsX,
+          panelY = panel / m_panelsX;
+  if (m_serpentinePanels && (panelY & 1))
+    panelX = m_panelsX -1 - panelX;
+
+  uint8_t col, row;
+  if (m_wiring & ColumnMajor) {
+    col = i / panelH;
+    row = i % panelH;
+    if ((m_wiring & Serpentine) && (col & 1))
+      row = panelH -1 - row;
+  } else {
+    row = i / panelW;
+    col = i % panelW;
+    if ((m_wiring & Serpentine) && (row & 1))
+      col = panelW -1 - col;
+  }
+  if (m_wiring & FlipX)
+    col = panelW -1 - col;
+  if (m_wiring & FlipY)
+    row = panelH -1 - row;
+
+  x = panelX * panelW + col;
+  y = panelY * panelH + row;
+}
+
+CRGB *MatrixSegment::_led(uint16_t entry) const
+{
+  return &m_controllers[entry >> SLOT_SHIFT]->leds()[entry & ((1 << SLOT_SHIFT) -1)];
+}
+
+uint16_t MatrixSegment::_forEachLine(uint16_t first, uint16_t step,
+                                     uint8_t count, LedRunCallback cb,
+                                     void *ctx)
+{
+  if (!_xyValid())
+    _compileXY();
+
+  // leds evenly spaced in same controller are merged into one run
+  LedRun run;
+  run.size = 0;
+  uint16_t runStart = 0;
+  for (uint8_t i = 0; i < count; ++i) {
+    uint16_t entry = m_xy[first + i * step];
+    CRGB *led = entry != NOT_WIRED ? _led(entry) : nullptr;
+    if (run.size > 0) {
+      if (led && m_controllers[entry >> SLOT_SHIFT] == run.controller) {
+        int32_t dist = led - &run[run.size -1];
+        if (run.size == 1 && dist != 0 && dist > -0x8000 && dist < 0x8000) {
+          run.stride = dist;
+          ++run.size;
+          continue;
+        }
+        if (dist == run.stride) {
+          ++run.size;
+          continue;
+        }
+      }
+      cb(run, runStart, ctx);
+      run.size = 0;
+    }
+    if (led) {
+      run.controller = m_controllers[entry >> SLOT_SHIFT];
+      run.leds = led;
+      run.size = 1;
+      run.stride = 1;
+      runStart = i;
+    }
+  }
+  if (run.size > 0)
+    cb(run, runStart, ctx);
+  return count;
+}
+
+// static
+void MatrixSegment::_mapRun(const LedRun &run, uint16_t logicalIdx, void *ctx)
+{
+  MatrixSegment *self = static_cast<MatrixSegment*>(ctx);
+  uint8_t slot = 0;
+  while (slot < self->m_controllerCount &&
+         self->m_controllers[slot] != run.controller)
+  {
+    ++slot;
+  }
+  if (slot == self->m_controllerCount) {
+    if (slot == MAX_CONTROLLERS)
+      return; // not room for more
+    self->m_controllers[slot] = run.controller;
+    ++self->m_controllerCount;
+  }
+
+  uint16_t cells = (uint16_t)self->m_width * self->m_height;
+  uint8_t w = self->m_width, h = self->m_height;
+  for (uint16_t i = 0; i < run.size && logicalIdx + i < cells; ++i) {
+    uint16_t idx = &run[i] - run.controller->leds();
+    if (idx >= (1 << SLOT_SHIFT) -1)
+      continue;
+    uint8_t x, y, rx, ry;
+    self->_wiredXY(logicalIdx + i, x, y);
+    switch (self->m_rotation) {
+    case 1:  rx = h -1 - y; ry = x;         break;
+    case 2:  rx = w -1 - x; ry = h -1 - y;  break;
+    case 3:  rx = y;         ry = w -1 - x; break;
+    default: rx = x;         ry = y;        break;
+    }
+    self->m_xy[(uint16_t)ry * self->width() + rx] =
+        ((uint16_t)slot << SLOT_SHIFT) | idx;
+  }
+}
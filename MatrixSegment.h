@@ -0,0 +1,106 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  MatrixSegment.h
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#ifndef MATRIXSEGMENT_H_
+#define MATRIXSEGMENT_H_
+
+#include <stdint.h>
+#include "FastLED_Action.h"
+
+/**
+ * @brief: a segment wired as a 2D matrix of width * height leds
+ *         parts are added in wiring order, as for a Segment, and
+ *         operator [] and forEachRun still goes in wiring order
+ *         the XY lookup is compiled into a table of 2 bytes per led when
+ *         layout changes, so xy(), forEachRow() and forEachColumn() does
+ *         no coordinate math or part lookups
+ *         x goes right and y goes down, after rotation
+ *         NOTE! max 8 controllers and 8191 leds per controller
+ */
+class MatrixSegment : public Segment {
+public:
+  /// how each panel is wired, flags can be combined
+  enum Wiring : uint8_t {
+    Progressive = 0x00,  // each row from left to right
+    Serpentine = 0x01,   // every other row goes back, right to left
+    ColumnMajor = 0x02,  // wired in columns instead of rows
+    FlipX = 0x04,        // first led is at right
+    FlipY = 0x08         // first led is at bottom
+  };
+  static const uint8_t MAX_CONTROLLERS = 8;
+
+  explicit MatrixSegment(uint8_t width, uint8_t height,
+                         uint8_t wiring = Serpentine,
+                         FastLED_Action *engine = nullptr);
+  ~MatrixSegment();
+
+  /// size as seen by xy(), swapped when rotated a quarter turn
+  uint8_t width() const;
+  uint8_t height() const;
+
+  uint8_t wiring() const { return m_wiring; }
+  void setWiring(uint8_t wiring);
+  /// rotate view clockwise in quarter turns
+  uint8_t rotation() const { return m_rotation; }
+  void setRotation(uint8_t quarterTurns);
+  /// matrix is tiled by panelsX * panelsY equal panels, each wired as
+  /// wiring, panels are wired a row of panels at a time from top left,
+  /// every other row of panels goes back if serpentine
+  /// false and panels unchanged if they don't divide width and height
+  bool setPanels(uint8_t panelsX, uint8_t panelsY, bool serpentine = false);
+
+  /// led at x, y, nullptr if outside or not wired
+  CRGB *xy(uint8_t x, uint8_t y);
+  /// runs of row y from left, logicalIdx is x of first led in run
+  /// returns width
+  uint16_t forEachRow(uint8_t y, LedRunCallback cb, void *ctx);
+  /// runs of column x from top, logicalIdx is y of first led in run
+  /// returns height
+  uint16_t forEachColumn(uint8_t x, LedRunCallback cb, void *ctx);
+
+  /// bytes used by XY table
+  uint16_t memoryUsage() const;
+
+private:
+  uint16_t *m_xy;   // controller slot << 13 | led idx, NOT_WIRED if none
+  CLEDController *m_controllers[MAX_CONTROLLERS];
+  uint32_t m_xyGeneration;
+  uint8_t m_width, m_height,   // as wired, before rotation
+          m_wiring, m_rotation,
+          m_panelsX, m_panelsY,
+          m_controllerCount;
+  bool m_serpentinePanels,
+       m_xyChanged;
+
+  static const uint16_t NOT_WIRED = 0xFFFF;
+  static const uint8_t SLOT_SHIFT = 13;
+
+  bool _xyValid() const {
+    return !m_xyChanged && m_xyGeneration == engine()->layoutGeneration();
+  }
+  void _compileXY();
+  void _wiredXY(uint16_t wiringIdx, uint8_t &x, uint8_t &y) const;
+  CRGB *_led(uint16_t entry) const;
+  uint16_t _forEachLine(uint16_t first, uint16_t step, uint8_t count,
+                        LedRunCallback cb, void *ctx);
+  static void _mapRun(const LedRun &run, uint16_t logicalIdx, void *ctx);
+};
+
+#endif /* MATRIXSEGMENT_H_ */
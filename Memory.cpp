@@ -0,0 +1,145 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  Memory.cpp
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#include "Memory.h"
+#include "FastLED_Action.h"
+#include "IndexedSegment.h"
+#include "MirrorSegment.h"
+#include "MatrixSegment.h"
+#include "Correction.h"
+#include "Recorder.h"
+#include "Playback.h"
+#include "NetworkStream.h"
+#include "Filters.h"
+#include "Particles.h"
+#include "Noise.h"
+#include "Audio.h"
+#include "Twinkle.h"
+#include "Timeline.h"
+#include "GatherSegment.h"
+
+uint32_t MemoryStats::s_current[MemoryStats::PoolCount] = { 0 },
+         MemoryStats::s_high[MemoryStats::PoolCount] = { 0 },
+         MemoryStats::s_totalHigh = 0,
+         MemoryStats::s_allocations = 0,
+         MemoryStats::s_frees = 0;
+
+void MemoryStats::allocated(Pool pool, uint32_t bytes)
+{
+  if (pool >= PoolCount)
+    return;
+  ++s_allocations;
+  s_current[pool] += bytes;
+  if (s_current[pool] > s_high[pool])
+    s_high[pool] = s_current[pool];
+  uint32_t sum = total();
+  if (sum > s_totalHigh)
+    s_totalHigh = sum;
+}
+
+void MemoryStats::freed(Pool pool, uint32_t bytes)
+{
+  if (pool >= PoolCount)
+    return;
+  ++s_frees;
+  s_current[pool] = s_current[pool] > bytes ? s_current[pool] - bytes : 0;
+}
+
+uint32_t MemoryStats::total()
+{
+  uint32_t sum = 0;
+  for (uint8_t i = 0; i < PoolCount; ++i)
+    sum += s_current[i];
+  return sum;
+}
+
+void MemoryStats::resetHighWater()
+{
+  for (uint8_t i = 0; i < PoolCount; ++i)
+    s_high[i] = s_current[i];
+  s_totalHigh = total();
+}
+
+const char *MemoryStats::name(Pool pool)
+{
+  switch (pool) {
+  case Lists:   return "lists";
+  case Layout:  return "layout";
+  case Engine:  return "engine";
+  case Frames:  return "frames";
+  case Actions: return "actions";
+  case Audio:   return "audio";
+  default:      return "?";
+  }
+}
+
+void MemoryStats::dump(Print &out)
+{
+  out.println("pool     bytes  high");
+  for (uint8_t i = 0; i < PoolCount; ++i) {
+    out.print(name((Pool)i));
+    out.print(" ");
+    out.print((unsigned long)s_current[i]);
+    out.print(" ");
+    out.println((unsigned long)s_high[i]);
+  }
+  out.print("total ");
+  out.print((unsigned long)total());
+  out.print(" ");
+  out.println((unsigned long)s_totalHigh);
+}
+
+#define PRINT_SIZE(out, cls) \
+  out.print(#cls " "); out.println((unsigned long)sizeof(cls))
+
+void MemoryStats::dumpSizes(Print &out)
+{
+  PRINT_SIZE(out, FastLED_Action);
+  PRINT_SIZE(out, SegmentPart);
+  PRINT_SIZE(out, Segment);
+  PRINT_SIZE(out, SegmentCompound);
+  PRINT_SIZE(out, IndexedSegment);
+  PRINT_SIZE(out, MirrorSegment);
+  PRINT_SIZE(out, MatrixSegment);
+  PRINT_SIZE(out, GatherSegment);
+  PRINT_SIZE(out, LedRun);
+  PRINT_SIZE(out, OutputCorrection);
+  PRINT_SIZE(out, FrameRecorder);
+  PRINT_SIZE(out, RecordingReader);
+  PRINT_SIZE(out, Timeline);
+  PRINT_SIZE(out, ActionColor);
+  PRINT_SIZE(out, ActionColorLadder);
+  PRINT_SIZE(out, ActionWait);
+  PRINT_SIZE(out, ActionGotoColor);
+  PRINT_SIZE(out, ActionFade);
+  PRINT_SIZE(out, ActionFadeIn);
+  PRINT_SIZE(out, ActionEaseInOut);
+  PRINT_SIZE(out, ActionSnake);
+  PRINT_SIZE(out, ActionPaletteRotate);
+  PRINT_SIZE(out, ActionPlayback);
+  PRINT_SIZE(out, ActionNetworkStream);
+  PRINT_SIZE(out, ActionParticles);
+  PRINT_SIZE(out, ActionNoise);
+  PRINT_SIZE(out, ActionTwinkle);
+  PRINT_SIZE(out, AudioAnalyzer);
+  PRINT_SIZE(out, ActionAudio);
+}
+
+#undef PRINT_SIZE
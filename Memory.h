@@ -0,0 +1,100 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  Memory.h
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#ifndef MEMORY_H_
+#define MEMORY_H_
+
+#include <stdint.h>
+#include <Arduino.h>
+
+/**
+ * @brief: heap the library has allocated, by subsystem
+ *         every buffer the library owns is counted where it is allocated
+ *         and freed, through memNew and memDelete, list nodes where they
+ *         are pushed and removed
+ *         high water is the most each pool, and all together, has held
+ *         since start or resetHighWater, so an installation can be run
+ *         through its program on host and sized before it is flashed
+ *         objects the sketch owns, segments, parts and actions, are not
+ *         counted, their sizes are printed by dumpSizes
+ */
+class MemoryStats {
+public:
+  enum Pool : uint8_t {
+    Lists,     // nodes of item, action, part and segment lists
+    Layout,    // segment layout tables, matrix maps, indices and palettes
+    Engine,    // power and dirty blocks, correction scratch
+    Frames,    // transition snapshots, filter layer, recorder buffers
+    Actions,   // buffers owned by actions, ie particles or noise cache
+    Audio,     // analyzer ring, window and FFT buffers
+    PoolCount
+  };
+  /// DList node, a pointer and its links
+  static const uint8_t LIST_NODE = 3 * sizeof(void*);
+
+  static void allocated(Pool pool, uint32_t bytes);
+  static void freed(Pool pool, uint32_t bytes);
+
+  /// bytes held now
+  static uint32_t current(Pool pool) { return pool < PoolCount ? s_current[pool] : 0; }
+  static uint32_t highWater(Pool pool) { return pool < PoolCount ? s_high[pool] : 0; }
+  static uint32_t total();
+  /// most held at once, all pools together
+  static uint32_t totalHighWater() { return s_totalHigh; }
+  /// calls to allocated and freed since start
+  static uint32_t allocations() { return s_allocations; }
+  static uint32_t frees() { return s_frees; }
+  /// high water starts over from what is held now
+  static void resetHighWater();
+
+  static const char *name(Pool pool);
+  /// current and high water of each pool
+  static void dump(Print &out);
+  /// sizeof each class, known at compile time
+  static void dumpSizes(Print &out);
+
+private:
+  static uint32_t s_current[PoolCount],
+                  s_high[PoolCount],
+                  s_totalHigh,
+                  s_allocations,
+                  s_frees;
+};
+
+/// new T[count], counted in pool
+template<class T>
+inline T *memNew(MemoryStats::Pool pool, uint32_t count)
+{
+  MemoryStats::allocated(pool, count * sizeof(T));
+  return new T[count];
+}
+
+/// delete[] ptr of count from memNew and nullptr it
+template<class T>
+inline void memDelete(MemoryStats::Pool pool, T *&ptr, uint32_t count)
+{
+  if (!ptr)
+    return;
+  MemoryStats::freed(pool, count * sizeof(T));
+  delete[] ptr;
+  ptr = nullptr;
+}
+
+#endif /* MEMORY_H_ */
@@ -0,0 +1,158 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  MirrorSegment.cpp
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#include "MirrorSegment.h"
+
+struct MirrorSegment::CheckCtx {
+  FastLED_Action *engine;
+  bool changed;
+};
+
+struct MirrorSegment::CopyCtx {
+  MirrorSegment *self;
+  uint16_t sourceSize;
+};
+
+// a logical range of source into dst
+struct MirrorSegment::ReadCtx {
+  LedRun dst;
+  uint16_t first, count;
+  bool reversed;
+};
+
+MirrorSegment::MirrorSegment(SegmentCommon *source, bool reversed,
+                             uint16_t offset, FastLED_Action *engine) :
+    Segment(T_Mirror, engine),
+    m_source(source), m_sourceOffset(offset),
+    m_sourceReversed(reversed), m_changed(true)
+{
+}
+
+MirrorSegment::MirrorSegment(SegmentCommon &source, bool reversed,
+                             uint16_t offset, FastLED_Action *engine) :
+    Segment(T_Mirror, engine),
+    m_source(&source), m_sourceOffset(offset),
+    m_sourceReversed(reversed), m_changed(true)
+{
+}
+
+MirrorSegment::~MirrorSegment()
+{
+}
+
+void MirrorSegment::setSource(SegmentCommon *source)
+{
+  m_source = source;
+  m_changed = true;
+}
+
+void MirrorSegment::setSourceReversed(bool reversed)
+{
+  m_sourceReversed = reversed;
+  m_changed = true;
+}
+
+void MirrorSegment::setSourceOffset(uint16_t offset)
+{
+  m_sourceOffset = offset;
+  m_changed = true;
+}
+
+void MirrorSegment::mirror()
+{
+  if (!m_source || (!m_changed && !_sourceChanged()))
+    return;
+  uint16_t sourceSize = m_source->size();
+  if (sourceSize == 0)
+    return;
+  m_changed = false;
+  CopyCtx ctx = { this, sourceSize };
+  forEachRun(&MirrorSegment::_copyRun, &ctx);
+}
+
+bool MirrorSegment::_sourceChanged()
+{
+  CheckCtx ctx = { m_engine, false };
+  m_source->forEachRun(&MirrorSegment::_checkRun, &ctx);
+  return ctx.changed;
+}
+
+// static
+void MirrorSegment::_checkRun(const LedRun &run, uint16_t logicalIdx, void *ctx)
+{
+  (void)logicalIdx;
+  CheckCtx *check = static_cast<CheckCtx*>(ctx);
+  if (check->changed)
+    return;
+  check->changed = check->engine->ledControllerHasChanges(run.controller,
+                                                          run.firstLedIdx(),
+                                                          run.span());
+}
+
+// static
+void MirrorSegment::_copyRun(const LedRun &run, uint16_t logicalIdx, void *ctx)
+{
+  CopyCtx *copy = static_cast<CopyCtx*>(ctx);
+  MirrorSegment *self = copy->self;
+  uint16_t sourceSize = copy->sourceSize;
+
+  // each chunk is a contiguous range of source, it wraps at source end
+  for (uint16_t i = 0; i < run.size;) {
+    uint16_t src = ((uint32_t)logicalIdx + i + self->m_sourceOffset) % sourceSize,
+             chunk = sourceSize - src;
+    if (chunk > run.size - i)
+      chunk = run.size - i;
+    ReadCtx read;
+    read.dst = run.slice(i, chunk);
+    read.first = self->m_sourceReversed ? sourceSize - src - chunk : src;
+    read.count = chunk;
+    read.reversed = self->m_sourceReversed;
+    self->m_source->forEachRun(&MirrorSegment::_readRun, &read);
+    i += chunk;
+  }
+
+  self->m_engine->setLedControllerHasChanges(run.controller, run.firstLedIdx(),
+                                             run.span());
+}
+
+// static
+void MirrorSegment::_readRun(const LedRun &run, uint16_t logicalIdx, void *ctx)
+{
+  ReadCtx *read = static_cast<ReadCtx*>(ctx);
+  uint16_t first = read->first > logicalIdx ? read->first : logicalIdx,
+           end = logicalIdx + run.size;
+  if (end > read->first + read->count)
+    end = read->first + read->count;
+  if (first >= end)
+    return;
+
+  LedRun src = run.slice(first - logicalIdx, end - first);
+  if (read->reversed) {
+    uint16_t last = read->first + read->count -1 - first;
+    for (uint16_t i = 0; i < src.size; ++i)
+      read->dst[last - i] = src[i];
+  } else if (src.contiguous() && read->dst.contiguous()) {
+    read->dst.write(first - read->first, src.leds, src.size);
+  } else {
+    LedRun dst = read->dst.slice(first - read->first, src.size);
+    for (uint16_t i = 0; i < src.size; ++i)
+      dst[i] = src[i];
+  }
+}
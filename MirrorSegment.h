@@ -0,0 +1,73 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  MirrorSegment.h
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#ifndef MIRRORSEGMENT_H_
+#define MIRRORSEGMENT_H_
+
+#include <stdint.h>
+#include "FastLED_Action.h"
+
+/**
+ * @brief: a segment that shows what source shows, without running actions
+ *         of its own, source is evaluated once and copied run by run into
+ *         each mirror when engine renders, only when source has changed
+ *         led i shows source led (i + offset) % source size, counted from
+ *         end of source if reversed, so a mirror longer than its source
+ *         repeats it
+ *         source can be a Segment or a SegmentCompound, even another mirror
+ *         NOTE! source must be in the same engine instance
+ */
+class MirrorSegment : public Segment {
+public:
+  explicit MirrorSegment(SegmentCommon *source, bool reversed = false,
+                         uint16_t offset = 0, FastLED_Action *engine = nullptr);
+  explicit MirrorSegment(SegmentCommon &source, bool reversed = false,
+                         uint16_t offset = 0, FastLED_Action *engine = nullptr);
+  ~MirrorSegment();
+
+  SegmentCommon *source() const { return m_source; }
+  void setSource(SegmentCommon *source);
+  /// how source is read, Segment::setReversed/setOffset still applies
+  /// to the mirrors own parts
+  bool sourceReversed() const { return m_sourceReversed; }
+  void setSourceReversed(bool reversed);
+  uint16_t sourceOffset() const { return m_sourceOffset; }
+  void setSourceOffset(uint16_t offset);
+
+  /// copies source into leds if source has changed,
+  /// called by engine before render
+  void mirror();
+
+private:
+  SegmentCommon *m_source;
+  uint16_t m_sourceOffset;
+  bool m_sourceReversed,
+       m_changed;  // copy even if source hasn't changed
+
+  struct CheckCtx;
+  struct CopyCtx;
+  struct ReadCtx;
+  bool _sourceChanged();
+  static void _checkRun(const LedRun &run, uint16_t logicalIdx, void *ctx);
+  static void _copyRun(const LedRun &run, uint16_t logicalIdx, void *ctx);
+  static void _readRun(const LedRun &run, uint16_t logicalIdx, void *ctx);
+};
+
+#endif /* MIRRORSEGMENT_H_ */
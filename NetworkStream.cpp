@@ -0,0 +1,295 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  NetworkStream.cpp
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#include "NetworkStream.h"
+#include <Udp.h>
+
+#ifdef FASTLED_ACTION_HOST
+# include <sys/socket.h>
+# include <netinet/in.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+static const uint8_t ARTNET_HEADER_SIZE = 18;
+static const uint16_t ARTNET_OP_DMX = 0x5000;
+static const uint16_t ARTNET_OP_SYNC = 0x5200;
+static const uint8_t E131_HEADER_SIZE = 126;
+static const int8_t STALE_WINDOW = -20; // as in E1.31 spec
+
+// state passed to _readRun
+struct NetworkReadCtx {
+  PacketSource *source;
+  uint16_t firstLed, endLed, // leds in this packet
+           nextLed;          // next led to read from packet
+};
+
+// discard len bytes of current packet
+static void skipBytes(PacketSource *source, uint16_t len)
+{
+  uint8_t scratch[16];
+  while (len > 0) {
+    uint16_t cnt = source->read(scratch, len > sizeof(scratch) ? sizeof(scratch) : len);
+    if (cnt == 0)
+      return;
+    len -= cnt;
+  }
+}
+
+// --------------------------------------------------------------
+
+uint16_t UdpPacketSource::nextPacket()
+{
+  int sz = m_udp.parsePacket();
+  return sz > 0 ? sz : 0;
+}
+
+uint16_t UdpPacketSource::read(uint8_t *buf, uint16_t len)
+{
+  int cnt = m_udp.read(buf, len);
+  return cnt > 0 ? cnt : 0;
+}
+
+// --------------------------------------------------------------
+
+#ifdef FASTLED_ACTION_HOST
+PosixUdpSource::PosixUdpSource(uint16_t port) :
+    m_fd(-1), m_len(0), m_pos(0)
+{
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0)
+    return;
+  int on = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+    close(fd);
+    return;
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  m_fd = fd;
+}
+
+PosixUdpSource::~PosixUdpSource()
+{
+  if (m_fd >= 0)
+    close(m_fd);
+}
+
+uint16_t PosixUdpSource::nextPacket()
+{
+  m_len = m_pos = 0;
+  if (m_fd < 0)
+    return 0;
+  ssize_t len = recv(m_fd, m_buf, sizeof(m_buf), 0);
+  if (len <= 0)
+    return 0;
+  m_len = len;
+  return m_len;
+}
+
+uint16_t PosixUdpSource::read(uint8_t *buf, uint16_t len)
+{
+  if (len > m_len - m_pos)
+    len = m_len - m_pos;
+  memcpy(buf, m_buf + m_pos, len);
+  m_pos += len;
+  return len;
+}
+#endif
+
+// --------------------------------------------------------------
+
+ActionNetworkStream::ActionNetworkStream(PacketSource &source,
+                                         uint16_t firstUniverse,
+                                         uint8_t ledsPerUniverse,
+                                         uint32_t duration) :
+    Action<ActionNetworkStream>(duration),
+    m_source(source),
+    m_frames(0), m_packets(0), m_stale(0), m_ignored(0),
+    m_firstUniverse(firstUniverse), m_receivedMask(0),
+    m_ledsPerUniverse(ledsPerUniverse > 170 ? 170 : ledsPerUniverse),
+    m_universeCount(0)
+{
+  if (m_ledsPerUniverse == 0)
+    m_ledsPerUniverse = 1;
+}
+
+ActionNetworkStream::~ActionNetworkStream()
+{
+}
+
+void ActionNetworkStream::onStart(SegmentCommon *owner)
+{
+  uint16_t universes = (owner->size() + m_ledsPerUniverse -1) / m_ledsPerUniverse;
+  m_universeCount = universes > MAX_UNIVERSES ? MAX_UNIVERSES : universes;
+  m_receivedMask = 0;
+  for (uint8_t i = 0; i < MAX_UNIVERSES; ++i)
+    m_seqValid[i] = false;
+  m_updateTime = 1; // poll each loop
+  m_nextIterTime = millis();
+}
+
+void ActionNetworkStream::onTick(SegmentCommon *owner)
+{
+  for (uint8_t i = 0; i < MAX_PACKETS_PER_TICK; ++i) {
+    uint16_t size = m_source.nextPacket();
+    if (size == 0)
+      break;
+    ++m_packets;
+    _handlePacket(owner, size);
+  }
+}
+
+void ActionNetworkStream::_handlePacket(SegmentCommon *owner, uint16_t size)
+{
+  uint8_t hdr[E131_HEADER_SIZE];
+  if (size < ARTNET_HEADER_SIZE ||
+      m_source.read(hdr, ARTNET_HEADER_SIZE) != ARTNET_HEADER_SIZE)
+  {
+    ++m_ignored;
+    return;
+  }
+
+  uint16_t universe, channels;
+  uint8_t seq;
+  if (memcmp(hdr, "Art-Net", 8) == 0) {
+    uint16_t opCode = hdr[8] | (hdr[9] << 8);
+    if (opCode == ARTNET_OP_SYNC) {
+      if (m_receivedMask)
+        _commit(owner);
+      return;
+    }
+    if (opCode != ARTNET_OP_DMX) {
+      ++m_ignored;
+      return;
+    }
+    seq = hdr[12];
+    universe = hdr[14] | (hdr[15] << 8);
+    channels = (hdr[16] << 8) | hdr[17];
+  } else if (hdr[0] == 0x00 && hdr[1] == 0x10 &&
+             memcmp(&hdr[4], "ASC-E1.17\0\0\0", 12) == 0 &&
+             size >= E131_HEADER_SIZE &&
+             m_source.read(&hdr[ARTNET_HEADER_SIZE],
+                           E131_HEADER_SIZE - ARTNET_HEADER_SIZE) ==
+                               E131_HEADER_SIZE - ARTNET_HEADER_SIZE)
+  {
+    // preview data and non zero start codes are not for us
+    if ((hdr[112] & 0x80) || hdr[125] != 0) {
+      ++m_ignored;
+      return;
+    }
+    seq = hdr[111];
+    universe = (hdr[113] << 8) | hdr[114];
+    channels = ((hdr[123] << 8) | hdr[124]);
+    channels = channels > 0 ? channels -1 : 0; // count includes start code
+  } else {
+    ++m_ignored;
+    return;
+  }
+
+  if (universe < m_firstUniverse ||
+      universe - m_firstUniverse >= m_universeCount)
+  {
+    ++m_ignored;
+    return;
+  }
+  uint8_t universeIdx = universe - m_firstUniverse;
+  if (!_acceptSequence(universeIdx, seq)) {
+    ++m_stale;
+    return;
+  }
+
+  // a universe again before frame completed, sender has moved on
+  if (m_receivedMask & (1 << universeIdx))
+    _commit(owner);
+
+  _readDmx(owner, universeIdx, channels);
+  m_receivedMask |= 1 << universeIdx;
+  if (m_receivedMask == (uint16_t)((1UL << m_universeCount) -1))
+    _commit(owner);
+}
+
+bool ActionNetworkStream::_acceptSequence(uint8_t universeIdx, uint8_t seq)
+{
+  if (seq == 0)
+    return true; // sequence disabled by sender
+  if (m_seqValid[universeIdx]) {
+    int8_t diff = seq - m_lastSeq[universeIdx];
+    if (diff <= 0 && diff > STALE_WINDOW)
+      return false;
+  }
+  m_lastSeq[universeIdx] = seq;
+  m_seqValid[universeIdx] = true;
+  return true;
+}
+
+void ActionNetworkStream::_commit(SegmentCommon *owner)
+{
+  owner->dirty();
+  m_receivedMask = 0;
+  ++m_frames;
+}
+
+void ActionNetworkStream::_readDmx(SegmentCommon *owner, uint8_t universeIdx,
+                                   uint16_t channels)
+{
+  uint16_t leds = channels / 3;
+  if (leds > m_ledsPerUniverse)
+    leds = m_ledsPerUniverse;
+
+  NetworkReadCtx ctx;
+  ctx.source = &m_source;
+  ctx.firstLed = ctx.nextLed = universeIdx * m_ledsPerUniverse;
+  ctx.endLed = ctx.firstLed + leds;
+  owner->forEachRun(&ActionNetworkStream::_readRun, &ctx);
+}
+
+// static
+void ActionNetworkStream::_readRun(const LedRun &run, uint16_t logicalIdx, void *ctx)
+{
+  NetworkReadCtx *rctx = static_cast<NetworkReadCtx*>(ctx);
+  uint16_t from = logicalIdx > rctx->nextLed ? logicalIdx : rctx->nextLed,
+           to = logicalIdx + run.size < rctx->endLed ?
+                  logicalIdx + run.size : rctx->endLed;
+  if (from >= to)
+    return; // run is not in this packet
+
+  // runs come in logical order, so packet is read from start to end
+  skipBytes(rctx->source, (from - rctx->nextLed) * 3);
+  LedRun dst = run.slice(from - logicalIdx, to - from);
+  if (dst.contiguous()) {
+    rctx->source->read(reinterpret_cast<uint8_t*>(dst.leds), dst.size * 3);
+  } else {
+    // strided or reversed, read a few leds at a time
+    CRGB buf[8];
+    for (uint16_t i = 0; i < dst.size; i += 8) {
+      uint16_t cnt = dst.size - i < 8 ? dst.size - i : 8;
+      rctx->source->read(reinterpret_cast<uint8_t*>(buf), cnt * 3);
+      dst.write(i, buf, cnt);
+    }
+  }
+  rctx->nextLed = to;
+}
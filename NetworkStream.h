@@ -0,0 +1,113 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  NetworkStream.h
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#ifndef NETWORKSTREAM_H_
+#define NETWORKSTREAM_H_
+
+#include <stdint.h>
+#include "FastLED_Action.h"
+
+class UDP;
+
+/**
+ * @brief: where network stream reads packets from
+ *         packets are read in order so DMX data can go straight to leds
+ */
+class PacketSource {
+public:
+  virtual ~PacketSource() {}
+  /// size of next waiting packet, 0 if none
+  virtual uint16_t nextPacket() = 0;
+  /// read from current packet, returns how many bytes read
+  virtual uint16_t read(uint8_t *buf, uint16_t len) = 0;
+};
+
+/// packets from a Arduino UDP, ie EthernetUDP or WiFiUDP, begin() it first
+class UdpPacketSource : public PacketSource {
+  UDP &m_udp;
+public:
+  explicit UdpPacketSource(UDP &udp) : m_udp(udp) {}
+  uint16_t nextPacket();
+  uint16_t read(uint8_t *buf, uint16_t len);
+};
+
+#ifdef FASTLED_ACTION_HOST
+/// packets from a UDP socket on host, ie for tests over loopback
+class PosixUdpSource : public PacketSource {
+  int m_fd;
+  uint16_t m_len, m_pos;
+  uint8_t m_buf[1500];
+public:
+  explicit PosixUdpSource(uint16_t port);
+  ~PosixUdpSource();
+  bool isOpen() const { return m_fd >= 0; }
+  uint16_t nextPacket();
+  uint16_t read(uint8_t *buf, uint16_t len);
+};
+#endif
+
+// ----------------------------------------------------------
+
+/**
+ * @brief: drives owner live from Art-Net (ArtDmx/ArtSync) or E1.31 packets
+ *         universe firstUniverse maps to first led of owner, each universe
+ *         holds ledsPerUniverse leds as r,g,b channels
+ *         DMX data is read straight into owners led runs
+ *         owner is marked dirty once all universes of a frame has arrived,
+ *         on ArtSync, or when a new frame starts before last was complete
+ *         packets older than last seen sequence of a universe are dropped
+ *         duration of 0 runs until stopped
+ */
+class ActionNetworkStream : public Action<ActionNetworkStream> {
+  friend class Action<ActionNetworkStream>;
+public:
+  static const uint8_t MAX_UNIVERSES = 16;
+  static const uint8_t MAX_PACKETS_PER_TICK = 16;
+
+  explicit ActionNetworkStream(PacketSource &source, uint16_t firstUniverse,
+                               uint8_t ledsPerUniverse = 170,
+                               uint32_t duration = 0);
+  virtual ~ActionNetworkStream();
+
+  uint32_t frames() const { return m_frames; }
+  uint32_t packets() const { return m_packets; }
+  /// packets dropped due to old sequence
+  uint32_t stalePackets() const { return m_stale; }
+  /// packets not understood or for other universes
+  uint32_t ignoredPackets() const { return m_ignored; }
+
+private:
+  PacketSource &m_source;
+  uint32_t m_frames, m_packets, m_stale, m_ignored;
+  uint16_t m_firstUniverse, m_receivedMask;
+  uint8_t m_ledsPerUniverse, m_universeCount;
+  uint8_t m_lastSeq[MAX_UNIVERSES];
+  bool m_seqValid[MAX_UNIVERSES];
+
+  void onStart(SegmentCommon *owner);
+  void onTick(SegmentCommon *owner);
+  void _handlePacket(SegmentCommon *owner, uint16_t size);
+  bool _acceptSequence(uint8_t universeIdx, uint8_t seq);
+  void _commit(SegmentCommon *owner);
+  void _readDmx(SegmentCommon *owner, uint8_t universeIdx, uint16_t channels);
+  static void _readRun(const LedRun &run, uint16_t logicalIdx, void *ctx);
+};
+
+#endif /* NETWORKSTREAM_H_ */
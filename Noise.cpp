@@ -0,0 +1,275 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  Noise.cpp
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#include "Noise.h"
+#include "MatrixSegment.h"
+#include "Easing.h"
+#include "Memory.h"
+
+typedef EaseTableData<CurveSmoothStep, 256> SmoothStep;
+
+static inline uint8_t smoothStep(uint8_t x)
+{
+  return pgm_read_byte(SmoothStep::values + x);
+}
+
+// one octave along a line, lattice values are reused until x leaves cell
+struct ActionNoise::Octave {
+  int32_t t0, y0,     // lattice time and row
+          cell;       // cell v0 and v1 are for
+  uint8_t ft, fy,     // smoothstepped fractions
+          v0, v1,     // lattice values at cell and cell + 1
+          shift,      // lattice spacing 1 << shift leds
+          octave;
+  bool matrix;
+};
+
+struct ActionNoise::LineCtx {
+  Octave octaves[MAX_OCTAVES];
+  FastLED_Action *engine;
+  ActionNoise *self;
+  uint16_t base;      // cache idx of line
+  bool refresh;       // evaluate cached octaves
+};
+
+ActionNoise::ActionNoise(const CRGBPalette16 &palette, uint8_t scale,
+                         uint16_t speed, uint8_t octaves, uint32_t duration) :
+    Action<ActionNoise>(duration),
+    m_palette(palette),
+    m_cache(nullptr),
+    m_elapsed(0), m_lastMs(0), m_cacheTime(0),
+    m_speed(speed),
+    m_cacheSize(0), m_cacheRefreshes(0),
+    m_scale(scale > MAX_SCALE ? MAX_SCALE : scale),
+    m_octaves(octaves < 1 ? 1 : (octaves > MAX_OCTAVES ? MAX_OCTAVES : octaves)),
+    m_cachedOctaves(1),
+    m_brightness(255),
+    m_seed(0),
+    m_cacheValid(false)
+{
+  m_updateTime = 16;
+  _buildWeights();
+}
+
+ActionNoise::~ActionNoise()
+{
+  memDelete(MemoryStats::Actions, m_cache, m_cacheSize);
+}
+
+void ActionNoise::setScale(uint8_t scale)
+{
+  m_scale = scale > MAX_SCALE ? MAX_SCALE : scale;
+  m_cacheValid = false;
+}
+
+void ActionNoise::setOctaves(uint8_t octaves)
+{
+  m_octaves = octaves < 1 ? 1 : (octaves > MAX_OCTAVES ? MAX_OCTAVES : octaves);
+  _buildWeights();
+  m_cacheValid = false;
+}
+
+void ActionNoise::setCachedOctaves(uint8_t octaves)
+{
+  m_cachedOctaves = octaves > MAX_OCTAVES ? MAX_OCTAVES : octaves;
+  m_cacheValid = false;
+}
+
+void ActionNoise::setSeed(uint8_t seed)
+{
+  m_seed = seed;
+  m_cacheValid = false;
+}
+
+void ActionNoise::render(SegmentCommon *owner, uint32_t time)
+{
+  bool matrix = owner->type() == SegmentCommon::T_Matrix;
+  MatrixSegment *mat = matrix ? static_cast<MatrixSegment*>(owner) : nullptr;
+  uint16_t cells = matrix ? (uint16_t)mat->width() * mat->height() :
+                            owner->size();
+  if (cells == 0)
+    return;
+
+  uint8_t cached = m_cachedOctaves < m_octaves ? m_cachedOctaves : m_octaves;
+  if (cached > 0 && cells > m_cacheSize) {
+    // only when owner grows, never per frame
+    memDelete(MemoryStats::Actions, m_cache, m_cacheSize);
+    m_cache = memNew<uint8_t>(MemoryStats::Actions, cells);
+    m_cacheSize = cells;
+    m_cacheValid = false;
+  }
+
+  LineCtx ctx;
+  ctx.engine = owner->engine();
+  ctx.self = this;
+  ctx.base = 0;
+  uint32_t cacheTime = _cacheTime(time);
+  ctx.refresh = cached > 0 && (!m_cacheValid || cacheTime != m_cacheTime);
+  if (ctx.refresh) {
+    m_cacheTime = cacheTime;
+    m_cacheValid = true;
+    ++m_cacheRefreshes;
+  }
+
+  if (matrix) {
+    for (uint8_t y = 0; y < mat->height(); ++y) {
+      for (uint8_t o = 0; o < m_octaves; ++o)
+        _setupOctave(ctx.octaves[o], o, o < cached ? cacheTime : time, y, true);
+      ctx.base = (uint16_t)y * mat->width();
+      mat->forEachRow(y, &ActionNoise::_renderRun, &ctx);
+    }
+  } else {
+    for (uint8_t o = 0; o < m_octaves; ++o)
+      _setupOctave(ctx.octaves[o], o, o < cached ? cacheTime : time, 0, false);
+    owner->forEachRun(&ActionNoise::_renderRun, &ctx);
+  }
+}
+
+uint8_t ActionNoise::sample(uint16_t x, uint16_t y, uint32_t time) const
+{
+  uint8_t cached = m_cachedOctaves < m_octaves ? m_cachedOctaves : m_octaves;
+  uint16_t cachedSum = 0, sum = 0;
+  for (uint8_t o = 0; o < m_octaves; ++o) {
+    Octave oct;
+    _setupOctave(oct, o, o < cached ? _cacheTime(time) : time, y, true);
+    if (o < cached)
+      cachedSum += _value(oct, x) * m_weight[o];
+    else
+      sum += _value(oct, x) * m_weight[o];
+  }
+  return (cachedSum >> 8) + (sum >> 8);
+}
+
+void ActionNoise::onStart(SegmentCommon *owner)
+{
+  (void)owner;
+  m_elapsed = 0;
+  m_lastMs = millis();
+}
+
+void ActionNoise::onTick(SegmentCommon *owner)
+{
+  uint32_t now = millis();
+  m_elapsed += now - m_lastMs;
+  m_lastMs = now;
+  render(owner, ((uint64_t)m_elapsed * m_speed) / 1000);
+}
+
+void ActionNoise::_buildWeights()
+{
+  // each octave half of the one before, all sums to max 256
+  uint16_t total = (1 << m_octaves) -1;
+  for (uint8_t o = 0; o < m_octaves; ++o)
+    m_weight[o] = (256U << (m_octaves -1 - o)) / total;
+}
+
+uint32_t ActionNoise::_cacheTime(uint32_t time) const
+{
+  // fastest cached octave may move 1/16 cell
+  uint8_t cached = m_cachedOctaves < m_octaves ? m_cachedOctaves : m_octaves;
+  uint8_t shift = 8 - CACHE_SHIFT;
+  shift = cached > 1 ? shift - (cached -1) : shift;
+  return time & ~((1UL << shift) -1);
+}
+
+void ActionNoise::_setupOctave(Octave &oct, uint8_t octave, uint32_t time,
+                               uint16_t y, bool matrix) const
+{
+  uint32_t t = time << octave;
+  oct.octave = octave;
+  oct.shift = m_scale > octave ? m_scale - octave : 0;
+  oct.t0 = t >> 8;
+  oct.ft = smoothStep(t & 0xFF);
+  oct.matrix = matrix;
+  oct.y0 = y >> oct.shift;
+  oct.fy = oct.shift > 0 ?
+             smoothStep((y & ((1 << oct.shift) -1)) << (8 - oct.shift)) : 0;
+  oct.cell = -2; // no cell yet
+}
+
+uint8_t ActionNoise::_lattice(const Octave &oct, int32_t x) const
+{
+  uint16_t seed = ((uint16_t)m_seed << 8) | oct.octave;
+  uint8_t v = lerp8by8(_hash(x, oct.y0, oct.t0, seed),
+                       _hash(x, oct.y0, oct.t0 +1, seed), oct.ft);
+  if (oct.matrix && oct.fy > 0) {
+    uint8_t below = lerp8by8(_hash(x, oct.y0 +1, oct.t0, seed),
+                             _hash(x, oct.y0 +1, oct.t0 +1, seed), oct.ft);
+    v = lerp8by8(v, below, oct.fy);
+  }
+  return v;
+}
+
+uint8_t ActionNoise::_value(Octave &oct, uint16_t x) const
+{
+  int32_t cell = x >> oct.shift;
+  if (cell != oct.cell) {
+    // next cell shares a lattice point with this one
+    oct.v0 = cell == oct.cell +1 ? oct.v1 : _lattice(oct, cell);
+    oct.v1 = _lattice(oct, cell +1);
+    oct.cell = cell;
+  }
+  if (oct.shift == 0)
+    return oct.v0;
+  uint8_t frac = (x & ((1 << oct.shift) -1)) << (8 - oct.shift);
+  return lerp8by8(oct.v0, oct.v1, smoothStep(frac));
+}
+
+void ActionNoise::_renderLine(LineCtx &ctx, const LedRun &run, uint16_t x)
+{
+  uint8_t cached = m_cachedOctaves < m_octaves ? m_cachedOctaves : m_octaves;
+  for (uint16_t i = 0; i < run.size; ++i, ++x) {
+    uint8_t vlu = 0;
+    uint16_t sum = 0;
+    if (cached > 0 && ctx.base + x < m_cacheSize) {
+      uint8_t &slot = m_cache[ctx.base + x];
+      if (ctx.refresh) {
+        for (uint8_t o = 0; o < cached; ++o)
+          sum += _value(ctx.octaves[o], x) * m_weight[o];
+        slot = sum >> 8;
+        sum = 0;
+      }
+      vlu = slot;
+    }
+    for (uint8_t o = cached; o < m_octaves; ++o)
+      sum += _value(ctx.octaves[o], x) * m_weight[o];
+    run[i] = ColorFromPalette(m_palette, vlu + (sum >> 8), m_brightness);
+  }
+  ctx.engine->setLedControllerHasChanges(run.controller, run.firstLedIdx(),
+                                         run.span());
+}
+
+// static
+uint8_t ActionNoise::_hash(int32_t x, int32_t y, int32_t t, uint16_t octave)
+{
+  uint32_t h = (uint32_t)x * 0x8DA6B343UL ^ (uint32_t)y * 0xD8163841UL ^
+               (uint32_t)t * 0xCB1AB31FUL ^ (uint32_t)octave * 0x165667B1UL;
+  h ^= h >> 15;
+  h *= 0x2C1B3C6DUL;
+  h ^= h >> 12;
+  return h >> 24;
+}
+
+// static
+void ActionNoise::_renderRun(const LedRun &run, uint16_t logicalIdx, void *ctx)
+{
+  LineCtx *line = static_cast<LineCtx*>(ctx);
+  line->self->_renderLine(*line, run, logicalIdx);
+}
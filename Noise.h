@@ -0,0 +1,113 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  Noise.h
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#ifndef NOISE_H_
+#define NOISE_H_
+
+#include <stdint.h>
+#include "FastLED_Action.h"
+#include "Actions.h"
+
+/**
+ * @brief: animated value noise along the logical leds of owner, or in
+ *         x and y on a MatrixSegment, mapped through a palette
+ *         octave 0 has a lattice point each 1 << scale leds, each next
+ *         octave has twice as many points, moves twice as fast and
+ *         weights half as much
+ *         lattice points are hashed once each frame, leds between them
+ *         only does a smoothstep lookup and a lerp for each octave
+ *         the lowest cachedOctaves octaves are kept in a buffer of one
+ *         byte per led and only evaluated again when their time has
+ *         moved 1/16 of a lattice cell
+ *         time is in 1/256 of a lattice cell, speed is cells per second
+ *         in 1/256
+ */
+class ActionNoise : public Action<ActionNoise> {
+  friend class Action<ActionNoise>;
+public:
+  static const uint8_t MAX_OCTAVES = 4,
+                       MAX_SCALE = 8,
+                       CACHE_SHIFT = 4; // cache is valid 1/16 cell
+
+  explicit ActionNoise(const CRGBPalette16 &palette, uint8_t scale = 4,
+                       uint16_t speed = 64, uint8_t octaves = 2,
+                       uint32_t duration = 0);
+  virtual ~ActionNoise();
+
+  const CRGBPalette16 &palette() const { return m_palette; }
+  void setPalette(const CRGBPalette16 &palette) { m_palette = palette; }
+  /// lattice spacing of octave 0 is 1 << scale leds, 0-8
+  uint8_t scale() const { return m_scale; }
+  void setScale(uint8_t scale);
+  uint16_t speed() const { return m_speed; }
+  void setSpeed(uint16_t speed) { m_speed = speed; }
+  uint8_t octaves() const { return m_octaves; }
+  void setOctaves(uint8_t octaves);
+  /// how many of the lowest octaves are cached between frames, 0 none
+  uint8_t cachedOctaves() const { return m_cachedOctaves; }
+  void setCachedOctaves(uint8_t octaves);
+  uint8_t brightness() const { return m_brightness; }
+  void setBrightness(uint8_t brightness) { m_brightness = brightness; }
+  uint8_t seed() const { return m_seed; }
+  void setSeed(uint8_t seed);
+
+  /// draw noise at time onto owner, called each tick
+  void render(SegmentCommon *owner, uint32_t time);
+  /// noise at x, y evaluated on its own, same as render gives
+  uint8_t sample(uint16_t x, uint16_t y, uint32_t time) const;
+
+  /// how many times cached octaves has been evaluated
+  uint16_t cacheRefreshes() const { return m_cacheRefreshes; }
+  /// bytes used by cache
+  uint16_t memoryUsage() const { return m_cacheSize; }
+
+private:
+  struct Octave;
+  struct LineCtx;
+  CRGBPalette16 m_palette;
+  uint8_t *m_cache;
+  uint32_t m_elapsed,   // ms since start
+           m_lastMs,
+           m_cacheTime; // time cache was evaluated at
+  uint16_t m_speed,
+           m_cacheSize,
+           m_cacheRefreshes;
+  uint16_t m_weight[MAX_OCTAVES]; // sums to max 256
+  uint8_t m_scale,
+          m_octaves,
+          m_cachedOctaves,
+          m_brightness,
+          m_seed;
+  bool m_cacheValid;
+
+  void onStart(SegmentCommon *owner);
+  void onTick(SegmentCommon *owner);
+  void _buildWeights();
+  uint32_t _cacheTime(uint32_t time) const;
+  void _setupOctave(Octave &oct, uint8_t octave, uint32_t time,
+                    uint16_t y, bool matrix) const;
+  uint8_t _lattice(const Octave &oct, int32_t x) const;
+  uint8_t _value(Octave &oct, uint16_t x) const;
+  void _renderLine(LineCtx &ctx, const LedRun &run, uint16_t x);
+  static uint8_t _hash(int32_t x, int32_t y, int32_t t, uint16_t octave);
+  static void _renderRun(const LedRun &run, uint16_t logicalIdx, void *ctx);
+};
+
+#endif /* NOISE_H_ */
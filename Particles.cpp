@@ -0,0 +1,214 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  Particles.cpp
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#include "Particles.h"
+#include "Memory.h"
+
+struct ActionParticles::FadeCtx {
+  ActionParticles *self;
+  FastLED_Action *engine;
+};
+
+ActionParticles::ActionParticles(uint16_t capacity, uint32_t duration) :
+    Action<ActionParticles>(duration),
+    m_position(memNew<int32_t>(MemoryStats::Actions, capacity)),
+    m_velocity(memNew<int32_t>(MemoryStats::Actions, capacity)),
+    m_color(memNew<CRGB>(MemoryStats::Actions, capacity)),
+    m_life(memNew<uint16_t>(MemoryStats::Actions, capacity)),
+    m_live(nullptr), m_hit(nullptr),
+    m_emitCB(nullptr), m_emitCtx(nullptr),
+    m_acceleration(0), m_lastMs(0),
+    m_capacity(capacity), m_count(0),
+    m_maskSize(0), m_fadeMs(0),
+    m_trail(0)
+{
+  m_updateTime = 16; // ~60 frames per second
+}
+
+ActionParticles::~ActionParticles()
+{
+  memDelete(MemoryStats::Actions, m_position, m_capacity);
+  memDelete(MemoryStats::Actions, m_velocity, m_capacity);
+  memDelete(MemoryStats::Actions, m_color, m_capacity);
+  memDelete(MemoryStats::Actions, m_life, m_capacity);
+  memDelete(MemoryStats::Actions, m_live, m_maskSize);
+  memDelete(MemoryStats::Actions, m_hit, m_maskSize);
+}
+
+bool ActionParticles::emit(int32_t position, int32_t velocity, CRGB color,
+                           uint16_t lifeMs)
+{
+  if (m_count >= m_capacity)
+    return false;
+  m_position[m_count] = position;
+  m_velocity[m_count] = velocity;
+  m_color[m_count] = color;
+  m_life[m_count] = lifeMs;
+  ++m_count;
+  return true;
+}
+
+void ActionParticles::step(SegmentCommon *owner, uint16_t deltaMs)
+{
+  uint16_t leds = owner->size();
+  if (leds == 0)
+    return;
+  _ensureMasks(leds);
+  if (m_emitCB)
+    m_emitCB(*this, owner, deltaMs, m_emitCtx);
+  _move(deltaMs, leds);
+
+  // blocks particles covers this frame
+  memset(m_hit, 0, m_maskSize);
+  for (uint16_t i = 0; i < m_count; ++i) {
+    uint16_t led = m_position[i] >> 8,
+             block = led >> BLOCK_SHIFT;
+    m_hit[block >> 3] |= 1 << (block & 7);
+    if (led +1 < leds) {
+      block = (led +1) >> BLOCK_SHIFT;
+      m_hit[block >> 3] |= 1 << (block & 7);
+    }
+  }
+  for (uint16_t i = 0; i < m_maskSize; ++i)
+    m_live[i] |= m_hit[i];
+
+  // fade lit blocks, those still lit are added to hit
+  FadeCtx ctx = { this, owner->engine() };
+  owner->forEachRun(&ActionParticles::_fadeRun, &ctx);
+  uint8_t *live = m_live;
+  m_live = m_hit;
+  m_hit = live;
+
+  _draw(owner, leds);
+}
+
+uint16_t ActionParticles::memoryUsage() const
+{
+  return m_capacity * (2 * sizeof(int32_t) + sizeof(CRGB) + sizeof(uint16_t)) +
+         m_maskSize * 2;
+}
+
+void ActionParticles::onStart(SegmentCommon *owner)
+{
+  (void)owner;
+  m_lastMs = millis();
+}
+
+void ActionParticles::onTick(SegmentCommon *owner)
+{
+  uint32_t now = millis(),
+           delta = now - m_lastMs;
+  m_lastMs = now;
+  step(owner, delta > 250 ? 250 : delta);
+}
+
+void ActionParticles::_ensureMasks(uint16_t leds)
+{
+  uint16_t blocks = ((uint32_t)leds + (1 << BLOCK_SHIFT) -1) >> BLOCK_SHIFT,
+           bytes = (blocks + 7) >> 3;
+  if (bytes <= m_maskSize)
+    return;
+  // only when owner grows, never per frame
+  memDelete(MemoryStats::Actions, m_live, m_maskSize);
+  memDelete(MemoryStats::Actions, m_hit, m_maskSize);
+  m_live = memNew<uint8_t>(MemoryStats::Actions, bytes);
+  m_hit = memNew<uint8_t>(MemoryStats::Actions, bytes);
+  memset(m_live, 0, bytes);
+  m_maskSize = bytes;
+}
+
+void ActionParticles::_move(uint16_t deltaMs, uint16_t leds)
+{
+  // seconds in 16.16 fixed point
+  int32_t dt = (((uint32_t)deltaMs << 16) + 500) / 1000;
+  int32_t dv = ((int64_t)m_acceleration * dt + 0x8000) >> 16,
+          end = (int32_t)leds << 8;
+  for (uint16_t i = 0; i < m_count;) {
+    if (m_life[i] > deltaMs) {
+      m_life[i] -= deltaMs;
+      m_velocity[i] += dv;
+      m_position[i] += ((int64_t)m_velocity[i] * dt + 0x8000) >> 16;
+      if (m_position[i] >= 0 && m_position[i] < end) {
+        ++i;
+        continue;
+      }
+    }
+    // dead, last takes its place
+    --m_count;
+    m_position[i] = m_position[m_count];
+    m_velocity[i] = m_velocity[m_count];
+    m_color[i] = m_color[m_count];
+    m_life[i] = m_life[m_count];
+  }
+}
+
+void ActionParticles::_draw(SegmentCommon *owner, uint16_t leds)
+{
+  uint32_t fadeRecip = m_fadeMs > 0 ? (255UL << 16) / m_fadeMs : 0;
+  for (uint16_t i = 0; i < m_count; ++i) {
+    CRGB color = m_color[i];
+    if (m_life[i] < m_fadeMs)
+      color.nscale8((m_life[i] * fadeRecip) >> 16);
+    uint16_t led = m_position[i] >> 8;
+    uint8_t frac = m_position[i] & 0xFF;
+    CRGB *dst = (*owner)[led];
+    if (dst)
+      *dst += CRGB(color).nscale8(255 - frac);
+    if (frac > 0 && led +1 < leds && (dst = (*owner)[led +1]))
+      *dst += CRGB(color).nscale8(frac);
+  }
+}
+
+// static
+void ActionParticles::_fadeRun(const LedRun &run, uint16_t logicalIdx,
+                               void *ctx)
+{
+  FadeCtx *fade = static_cast<FadeCtx*>(ctx);
+  ActionParticles *self = fade->self;
+  uint32_t end = (uint32_t)logicalIdx + run.size;
+  for (uint16_t block = logicalIdx >> BLOCK_SHIFT;
+       ((uint32_t)block << BLOCK_SHIFT) < end; ++block)
+  {
+    uint8_t bit = 1 << (block & 7);
+    if (!(self->m_live[block >> 3] & bit))
+      continue;
+    uint32_t first = (uint32_t)block << BLOCK_SHIFT,
+             last = first + (1 << BLOCK_SHIFT);
+    if (first < logicalIdx)
+      first = logicalIdx;
+    if (last > end)
+      last = end;
+    LedRun slice = run.slice(first - logicalIdx, last - first);
+    if (self->m_trail == 0) {
+      slice.fill(CRGB::Black);
+    } else {
+      bool lit = false;
+      for (uint16_t i = 0; i < slice.size; ++i) {
+        CRGB &led = slice[i];
+        led.nscale8(self->m_trail);
+        lit = lit || led.r || led.g || led.b;
+      }
+      if (lit)
+        self->m_hit[block >> 3] |= bit;
+    }
+    fade->engine->setLedControllerHasChanges(run.controller,
+                                             slice.firstLedIdx(), slice.span());
+  }
+}
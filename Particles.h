@@ -0,0 +1,106 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  Particles.h
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#ifndef PARTICLES_H_
+#define PARTICLES_H_
+
+#include <stdint.h>
+#include "FastLED_Action.h"
+#include "Actions.h"
+
+/**
+ * @brief: a pool of particles moving along the logical leds of owner
+ *         pool is allocated once with room for capacity particles, kept
+ *         as one array for each property, dead particles are swapped
+ *         with the last one so the live ones stays packed
+ *         each tick particles are moved and added onto the leds,
+ *         antialiased over 2 leds
+ *         only blocks of 16 leds that particles cover, or that still
+ *         fades from earlier frames, are touched
+ *         positions and velocities are in 1/256 led, velocity per second
+ */
+class ActionParticles : public Action<ActionParticles> {
+  friend class Action<ActionParticles>;
+public:
+  /// called each tick before particles move, ie to emit new ones
+  typedef void (*EmitCallback)(ActionParticles &particles,
+                               SegmentCommon *owner, uint16_t deltaMs,
+                               void *ctx);
+  static const uint8_t BLOCK_SHIFT = 4; // 16 leds in each block
+
+  explicit ActionParticles(uint16_t capacity, uint32_t duration = 0);
+  virtual ~ActionParticles();
+
+  uint16_t capacity() const { return m_capacity; }
+  /// particles alive
+  uint16_t count() const { return m_count; }
+  /// add a particle, false if pool is full
+  bool emit(int32_t position, int32_t velocity, CRGB color, uint16_t lifeMs);
+  /// kill all particles
+  void clear() { m_count = 0; }
+
+  void setEmitter(EmitCallback cb, void *ctx) { m_emitCB = cb; m_emitCtx = ctx; }
+  /// added to velocity each second, ie gravity
+  int32_t acceleration() const { return m_acceleration; }
+  void setAcceleration(int32_t acceleration) { m_acceleration = acceleration; }
+  /// how much of led color stays each frame, 0 clears, 255 long trails
+  uint8_t trail() const { return m_trail; }
+  void setTrail(uint8_t keep) { m_trail = keep; }
+  /// particles fades out during last fadeMs of their life
+  uint16_t fadeTime() const { return m_fadeMs; }
+  void setFadeTime(uint16_t fadeMs) { m_fadeMs = fadeMs; }
+
+  int32_t position(uint16_t idx) const { return m_position[idx]; }
+  int32_t velocity(uint16_t idx) const { return m_velocity[idx]; }
+  uint16_t life(uint16_t idx) const { return m_life[idx]; }
+
+  /// move particles deltaMs and draw them onto owner, called each tick
+  void step(SegmentCommon *owner, uint16_t deltaMs);
+
+  /// bytes allocated for pool and block masks
+  uint16_t memoryUsage() const;
+
+private:
+  struct FadeCtx;
+  int32_t *m_position,
+          *m_velocity;
+  CRGB *m_color;
+  uint16_t *m_life;
+  uint8_t *m_live,   // blocks with lit leds, 1 bit each
+          *m_hit;    // blocks covered by a particle this frame
+  EmitCallback m_emitCB;
+  void *m_emitCtx;
+  int32_t m_acceleration;
+  uint32_t m_lastMs;
+  uint16_t m_capacity,
+           m_count,
+           m_maskSize,   // bytes in each block mask
+           m_fadeMs;
+  uint8_t m_trail;
+
+  void onStart(SegmentCommon *owner);
+  void onTick(SegmentCommon *owner);
+  void _ensureMasks(uint16_t leds);
+  void _move(uint16_t deltaMs, uint16_t leds);
+  void _draw(SegmentCommon *owner, uint16_t leds);
+  static void _fadeRun(const LedRun &run, uint16_t logicalIdx, void *ctx);
+};
+
+#endif /* PARTICLES_H_ */
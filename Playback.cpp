@@ -0,0 +1,223 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  Playback.cpp
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#include "Playback.h"
+
+#ifdef FASTLED_ACTION_HOST
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+static uint32_t readU32(const uint8_t *buf)
+{
+  return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) |
+         ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
+// --------------------------------------------------------------
+
+uint16_t MemoryFrameSource::read(uint32_t pos, uint8_t *buf, uint16_t len)
+{
+  if (pos >= m_size)
+    return 0;
+  if (pos + len > m_size)
+    len = m_size - pos;
+  memcpy(buf, m_data + pos, len);
+  return len;
+}
+
+const uint8_t *MemoryFrameSource::map(uint32_t pos, uint32_t len)
+{
+  if (pos + len > m_size)
+    return nullptr;
+  return m_data + pos;
+}
+
+// --------------------------------------------------------------
+
+#ifdef FASTLED_ACTION_HOST
+MmapFrameSource::MmapFrameSource(const char *path) :
+    m_data(nullptr), m_size(0)
+{
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return;
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED) {
+      m_data = static_cast<const uint8_t*>(data);
+      m_size = st.st_size;
+    }
+  }
+  close(fd); // mapping stays valid
+}
+
+MmapFrameSource::~MmapFrameSource()
+{
+  if (m_data)
+    munmap(const_cast<uint8_t*>(m_data), m_size);
+}
+
+uint16_t MmapFrameSource::read(uint32_t pos, uint8_t *buf, uint16_t len)
+{
+  if (!m_data || pos >= m_size)
+    return 0;
+  if (pos + len > m_size)
+    len = m_size - pos;
+  memcpy(buf, m_data + pos, len);
+  return len;
+}
+
+const uint8_t *MmapFrameSource::map(uint32_t pos, uint32_t len)
+{
+  if (!m_data || pos + len > m_size)
+    return nullptr;
+  return m_data + pos;
+}
+#endif
+
+// --------------------------------------------------------------
+
+// state passed to _writeRun
+struct PlaybackWriteCtx {
+  FrameSource *source;
+  uint32_t framePos;
+  uint16_t ledCount;
+};
+
+ActionPlayback::ActionPlayback(FrameSource &source, uint32_t duration) :
+    Action<ActionPlayback>(duration),
+    m_source(source),
+    m_frameCount(0), m_frame(0),
+    m_startFrame(0), m_originFrame(0), m_originTime(0),
+    m_ledCount(0), m_fps(0), m_valid(false)
+{
+}
+
+ActionPlayback::~ActionPlayback()
+{
+}
+
+void ActionPlayback::seek(uint32_t frame)
+{
+  m_startFrame = frame;
+  m_originFrame = m_frameCount ? frame % m_frameCount : frame;
+  m_originTime = millis();
+  if (isRunning())
+    m_nextIterTime = m_originTime; // show it on next loop
+}
+
+void ActionPlayback::onStart(SegmentCommon *owner)
+{
+  m_valid = _readHeader();
+  if (!m_valid)
+    return;
+  m_updateTime = 1000 / m_fps;
+  if (m_updateTime == 0)
+    m_updateTime = 1;
+  m_originFrame = m_startFrame % m_frameCount;
+  m_originTime = millis();
+  m_nextIterTime = m_originTime + m_updateTime; // tick in sync with frames
+  _showFrame(owner, m_originFrame);
+}
+
+void ActionPlayback::onTick(SegmentCommon *owner)
+{
+  if (!m_valid)
+    return;
+  uint32_t elapsed = millis() - m_originTime;
+  if (elapsed >= 1000) {
+    // each whole second is exactly fps frames, moving origin by them
+    // keeps elapsed * fps from overflowing however long it plays
+    uint32_t secs = elapsed / 1000;
+    m_originTime += secs * 1000;
+    m_originFrame = (m_originFrame +
+                     (uint64_t)(secs % m_frameCount) * m_fps % m_frameCount)
+                    % m_frameCount;
+    elapsed -= secs * 1000;
+  }
+  uint32_t frame = (m_originFrame + elapsed * m_fps / 1000) % m_frameCount;
+  if (frame != m_frame)
+    _showFrame(owner, frame);
+}
+
+bool ActionPlayback::_readHeader()
+{
+  uint8_t hdr[PLAYBACK_HEADER_SIZE];
+  if (m_source.read(0, hdr, PLAYBACK_HEADER_SIZE) != PLAYBACK_HEADER_SIZE)
+    return false;
+  if (hdr[0] != 'F' || hdr[1] != 'L' || hdr[2] != 'A' || hdr[3] != 'P' ||
+      hdr[4] != PLAYBACK_VERSION || hdr[5] == 0)
+  {
+    return false;
+  }
+  m_fps = hdr[5];
+  m_ledCount = hdr[6] | (hdr[7] << 8);
+  m_frameCount = readU32(&hdr[8]);
+  return m_frameCount > 0;
+}
+
+void ActionPlayback::_showFrame(SegmentCommon *owner, uint32_t frame)
+{
+  // constant time seek through frame index
+  uint8_t buf[4];
+  uint32_t idxPos = PLAYBACK_HEADER_SIZE + frame * 4;
+  if (m_source.read(idxPos, buf, 4) != 4)
+    return;
+
+  PlaybackWriteCtx ctx;
+  ctx.source = &m_source;
+  ctx.framePos = readU32(buf);
+  ctx.ledCount = m_ledCount;
+  owner->forEachRun(&ActionPlayback::_writeRun, &ctx);
+  m_frame = frame;
+  owner->dirty();
+}
+
+// static
+void ActionPlayback::_writeRun(const LedRun &run, uint16_t logicalIdx, void *ctx)
+{
+  PlaybackWriteCtx *wctx = static_cast<PlaybackWriteCtx*>(ctx);
+  if (logicalIdx >= wctx->ledCount)
+    return; // frame has fewer leds than segment
+  uint16_t cnt = run.size;
+  if (logicalIdx + cnt > wctx->ledCount)
+    cnt = wctx->ledCount - logicalIdx;
+
+  // CRGB is packed r,g,b so frame data goes straight into controller buffer
+  uint32_t pos = wctx->framePos + (uint32_t)logicalIdx * 3;
+  const uint8_t *mapped = wctx->source->map(pos, cnt * 3);
+  if (mapped) {
+    run.write(0, reinterpret_cast<const CRGB*>(mapped), cnt);
+  } else if (run.contiguous()) {
+    wctx->source->read(pos, reinterpret_cast<uint8_t*>(run.leds), cnt * 3);
+  } else {
+    // strided or reversed, read a few leds at a time
+    CRGB buf[8];
+    for (uint16_t i = 0; i < cnt; i += 8) {
+      uint16_t n = cnt - i < 8 ? cnt - i : 8;
+      wctx->source->read(pos + i * 3, reinterpret_cast<uint8_t*>(buf), n * 3);
+      run.write(i, buf, n);
+    }
+  }
+}
@@ -0,0 +1,144 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  Playback.h
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#ifndef PLAYBACK_H_
+#define PLAYBACK_H_
+
+#include <stdint.h>
+#include "FastLED_Action.h"
+
+/**
+ * Frame file layout, all values little endian
+ *   0: 'F','L','A','P'       magic
+ *   4: uint8_t  version      1
+ *   5: uint8_t  fps
+ *   6: uint16_t ledCount     leds in each frame
+ *   8: uint32_t frameCount
+ *  12: uint32_t index[frameCount]  file offset to each frame
+ *   n: frames, ledCount * r,g,b bytes each
+ */
+static const uint8_t PLAYBACK_HEADER_SIZE = 12;
+static const uint8_t PLAYBACK_VERSION = 1;
+
+/**
+ * @brief: where playback reads frames from
+ */
+class FrameSource {
+public:
+  virtual ~FrameSource() {}
+  /// read len bytes at pos into buf, returns how many bytes read
+  virtual uint16_t read(uint32_t pos, uint8_t *buf, uint16_t len) = 0;
+  /// pointer to len bytes at pos if source is memory mapped, else nullptr
+  virtual const uint8_t *map(uint32_t pos, uint32_t len) {
+    (void)pos; (void)len;
+    return nullptr;
+  }
+};
+
+/// frames stored in RAM
+class MemoryFrameSource : public FrameSource {
+  const uint8_t *m_data;
+  uint32_t m_size;
+public:
+  explicit MemoryFrameSource(const uint8_t *data, uint32_t size) :
+    m_data(data), m_size(size)
+  {}
+  uint16_t read(uint32_t pos, uint8_t *buf, uint16_t len);
+  const uint8_t *map(uint32_t pos, uint32_t len);
+};
+
+/// frames stored in a file, FileT must have seek(pos) and read(buf, len)
+/// ie SD File, reads go straight to leds in chunks of ChunkSize
+template<class FileT, uint16_t ChunkSize = 512>
+class FileFrameSource : public FrameSource {
+  FileT &m_file;
+  uint32_t m_filePos;
+public:
+  explicit FileFrameSource(FileT &file) :
+    m_file(file), m_filePos(0xFFFFFFFF)
+  {}
+  uint16_t read(uint32_t pos, uint8_t *buf, uint16_t len) {
+    if (pos != m_filePos)  // sequential frames needs no seek
+      m_file.seek(pos);
+    uint16_t done = 0;
+    while (done < len) {
+      uint16_t chunk = len - done > ChunkSize ? ChunkSize : len - done;
+      int cnt = m_file.read(buf + done, chunk);
+      if (cnt <= 0)
+        break;
+      done += cnt;
+    }
+    m_filePos = pos + done;
+    return done;
+  }
+};
+
+#ifdef FASTLED_ACTION_HOST
+/// frames in a memory mapped file on host
+class MmapFrameSource : public FrameSource {
+  const uint8_t *m_data;
+  uint32_t m_size;
+public:
+  explicit MmapFrameSource(const char *path);
+  ~MmapFrameSource();
+  bool isOpen() const { return m_data != nullptr; }
+  uint16_t read(uint32_t pos, uint8_t *buf, uint16_t len);
+  const uint8_t *map(uint32_t pos, uint32_t len);
+};
+#endif
+
+// ----------------------------------------------------------
+
+/**
+ * @brief: streams a frame file onto owner at the files fps
+ *         frames are written straight into owners LED runs
+ *         duration of 0 plays until stopped, file repeats when at end
+ */
+class ActionPlayback : public Action<ActionPlayback> {
+  friend class Action<ActionPlayback>;
+  FrameSource &m_source;
+  uint32_t m_frameCount,
+           m_frame,
+           m_startFrame,
+           m_originFrame,  // frame shown at m_originTime
+           m_originTime;
+  uint16_t m_ledCount;
+  uint8_t m_fps;
+  bool m_valid;
+  void onStart(SegmentCommon *owner);
+  void onTick(SegmentCommon *owner);
+  bool _readHeader();
+  void _showFrame(SegmentCommon *owner, uint32_t frame);
+  static void _writeRun(const LedRun &run, uint16_t logicalIdx, void *ctx);
+public:
+  explicit ActionPlayback(FrameSource &source, uint32_t duration = 0);
+  virtual ~ActionPlayback();
+
+  /// valid after start, false if header is missing or broken
+  bool isValid() const { return m_valid; }
+  uint32_t frameCount() const { return m_frameCount; }
+  uint8_t fps() const { return m_fps; }
+  /// frame currently shown
+  uint32_t currentFrame() const { return m_frame; }
+  /// jump to frame, constant time through frame index
+  void seek(uint32_t frame);
+};
+
+#endif /* PLAYBACK_H_ */
@@ -0,0 +1,351 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  Recorder.cpp
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#include "Recorder.h"
+#include "Memory.h"
+
+static const uint16_t SPAN_END = 0xFFFF;
+static const uint8_t SPAN_MAX = 128;
+
+// xor of led at i in cur and prev, packed so it can be compared
+static inline uint32_t xorAt(const uint8_t *cur, const uint8_t *prev, uint16_t i)
+{
+  const uint8_t *c = cur + i * 3, *p = prev + i * 3;
+  return ((uint32_t)(c[0] ^ p[0]) << 16) |
+         ((uint32_t)(c[1] ^ p[1]) << 8) | (c[2] ^ p[2]);
+}
+
+FrameRecorder::FrameRecorder(Print &sink, uint16_t ringSize,
+                             uint16_t keyframeInterval) :
+    m_sink(sink), m_ring(memNew<uint8_t>(MemoryStats::Frames, ringSize)),
+    m_ringSize(ringSize), m_head(0), m_tail(0), m_used(0),
+    m_keyframeInterval(keyframeInterval), m_writeBudget(64),
+    m_frames(0), m_dropped(0), m_written(0)
+{
+  for (uint8_t i = 0; i < MAX_CONTROLLERS; ++i) {
+    m_channels[i].prev = nullptr;
+    m_channels[i].ledCount = 0;
+    m_channels[i].sinceKey = 0;
+    m_channels[i].needKey = true;
+  }
+
+  const uint8_t hdr[] = { 'F', 'L', 'R', 'C', RECORDING_VERSION };
+  _putBytes(hdr, sizeof(hdr));
+}
+
+FrameRecorder::~FrameRecorder()
+{
+  flush();
+  for (uint8_t i = 0; i < MAX_CONTROLLERS; ++i)
+    memDelete(MemoryStats::Frames, m_channels[i].prev,
+              (uint32_t)m_channels[i].ledCount * 3);
+  memDelete(MemoryStats::Frames, m_ring, m_ringSize);
+}
+
+void FrameRecorder::beginFrame(uint32_t time)
+{
+  if (_free() < 5) {
+    ++m_dropped;
+    return;
+  }
+  _put(REC_Frame);
+  _put16(time & 0xFFFF);
+  _put16(time >> 16);
+  ++m_frames;
+}
+
+void FrameRecorder::capture(uint8_t controllerIdx, const CRGB *leds,
+                            uint16_t ledCount)
+{
+  if (controllerIdx >= MAX_CONTROLLERS)
+    return;
+  Channel &ch = m_channels[controllerIdx];
+  const uint8_t *raw = reinterpret_cast<const uint8_t*>(leds);
+
+  if (ch.ledCount != ledCount) {
+    memDelete(MemoryStats::Frames, ch.prev, (uint32_t)ch.ledCount * 3);
+    ch.prev = memNew<uint8_t>(MemoryStats::Frames, (uint32_t)ledCount * 3);
+    ch.ledCount = ledCount;
+    ch.needKey = true;
+  }
+
+  bool key = ch.needKey || ch.sinceKey >= m_keyframeInterval;
+  // worst case for delta is every other led changed
+  uint32_t need = key ? 4 + (uint32_t)ledCount * 3 :
+                        4 + (uint32_t)ledCount * 3 + ((ledCount / 2) + 1) * 3;
+  if (need > _free()) {
+    if (_free() >= 2) {
+      _put(REC_Dropped);
+      _put(controllerIdx);
+    }
+    ch.needKey = true;
+    ++m_dropped;
+    return;
+  }
+
+  if (key)
+    _keyframe(controllerIdx, raw, ledCount);
+  else
+    _delta(controllerIdx, raw, ledCount);
+  memcpy(ch.prev, raw, ledCount * 3);
+}
+
+void FrameRecorder::service()
+{
+  uint16_t budget = m_writeBudget;
+  while (m_used > 0 && budget > 0) {
+    // contiguous bytes up to end of ring
+    uint16_t len = m_tail + m_used > m_ringSize ? m_ringSize - m_tail : m_used;
+    if (len > budget)
+      len = budget;
+    size_t cnt = m_sink.write(&m_ring[m_tail], len);
+    if (cnt == 0)
+      return; // sink is full, try again later
+    m_tail = (m_tail + cnt) % m_ringSize;
+    m_used -= cnt;
+    m_written += cnt;
+    budget -= cnt;
+  }
+}
+
+void FrameRecorder::flush()
+{
+  uint16_t budget = m_writeBudget;
+  m_writeBudget = m_ringSize;
+  while (m_used > 0) {
+    uint16_t used = m_used;
+    service();
+    if (used == m_used)
+      break; // sink refuses
+  }
+  m_writeBudget = budget;
+}
+
+void FrameRecorder::_put(uint8_t byte)
+{
+  m_ring[m_head] = byte;
+  m_head = (m_head + 1) % m_ringSize;
+  ++m_used;
+}
+
+void FrameRecorder::_put16(uint16_t vlu)
+{
+  _put(vlu & 0xFF);
+  _put(vlu >> 8);
+}
+
+void FrameRecorder::_putBytes(const uint8_t *bytes, uint16_t len)
+{
+  for (uint16_t i = 0; i < len; ++i)
+    _put(bytes[i]);
+}
+
+void FrameRecorder::_keyframe(uint8_t controllerIdx, const uint8_t *raw,
+                              uint16_t ledCount)
+{
+  _put(REC_Key);
+  _put(controllerIdx);
+  _put16(ledCount);
+  _putBytes(raw, ledCount * 3);
+  m_channels[controllerIdx].sinceKey = 0;
+  m_channels[controllerIdx].needKey = false;
+}
+
+void FrameRecorder::_delta(uint8_t controllerIdx, const uint8_t *raw,
+                           uint16_t ledCount)
+{
+  const uint8_t *prev = m_channels[controllerIdx].prev;
+  _put(REC_Delta);
+  _put(controllerIdx);
+
+  uint16_t skip = 0, i = 0;
+  while (i < ledCount) {
+    uint32_t x = xorAt(raw, prev, i);
+    if (x == 0) {
+      ++skip;
+      ++i;
+      continue;
+    }
+
+    // same xor repeated, ie a part that changed to a new solid color
+    uint16_t len = 1;
+    while (i + len < ledCount && len < SPAN_MAX && xorAt(raw, prev, i + len) == x)
+      ++len;
+
+    _put16(skip);
+    skip = 0;
+    if (len > 1) {
+      _put(0x80 | (len -1));
+      _put(x >> 16);
+      _put(x >> 8);
+      _put(x);
+    } else {
+      // literal until unchanged led or a repeat begins
+      while (i + len < ledCount && len < SPAN_MAX) {
+        uint32_t nx = xorAt(raw, prev, i + len);
+        if (nx == 0 || (i + len + 1 < ledCount &&
+                        nx == xorAt(raw, prev, i + len + 1)))
+        {
+          break;
+        }
+        ++len;
+      }
+      _put(len -1);
+      for (uint16_t j = i; j < i + len; ++j) {
+        uint32_t lx = xorAt(raw, prev, j);
+        _put(lx >> 16);
+        _put(lx >> 8);
+        _put(lx);
+      }
+    }
+    i += len;
+  }
+  _put16(SPAN_END);
+  ++m_channels[controllerIdx].sinceKey;
+}
+
+// ----------------------------------------------------------
+
+RecordingReader::RecordingReader(const uint8_t *data, uint32_t size) :
+    m_data(data), m_size(size), m_pos(5), m_frameTime(0),
+    m_changedMask(0)
+{
+  for (uint8_t i = 0; i < FrameRecorder::MAX_CONTROLLERS; ++i) {
+    m_leds[i] = nullptr;
+    m_counts[i] = 0;
+  }
+  m_valid = size >= 5 && data[0] == 'F' && data[1] == 'L' &&
+            data[2] == 'R' && data[3] == 'C' && data[4] == RECORDING_VERSION;
+}
+
+RecordingReader::~RecordingReader()
+{
+  for (uint8_t i = 0; i < FrameRecorder::MAX_CONTROLLERS; ++i)
+    memDelete(MemoryStats::Frames, m_leds[i], m_counts[i]);
+}
+
+bool RecordingReader::nextFrame()
+{
+  if (!m_valid || !_has(5) || m_data[m_pos] != REC_Frame)
+    return false;
+  ++m_pos;
+  m_frameTime = _get16();
+  m_frameTime |= (uint32_t)_get16() << 16;
+  m_changedMask = 0;
+
+  while (_has(2) && m_data[m_pos] != REC_Frame) {
+    uint8_t tag = m_data[m_pos++];
+    switch (tag) {
+    case REC_Key:
+      if (!_readKey())
+        return false;
+      break;
+    case REC_Delta:
+      if (!_readDelta())
+        return false;
+      break;
+    case REC_Dropped:
+      ++m_pos; // controller is unchanged in this frame
+      break;
+    default:
+      return false;
+    }
+  }
+  return true;
+}
+
+const CRGB *RecordingReader::leds(uint8_t controllerIdx) const
+{
+  return controllerIdx < FrameRecorder::MAX_CONTROLLERS ?
+            m_leds[controllerIdx] : nullptr;
+}
+
+uint16_t RecordingReader::ledCount(uint8_t controllerIdx) const
+{
+  return controllerIdx < FrameRecorder::MAX_CONTROLLERS ?
+            m_counts[controllerIdx] : 0;
+}
+
+bool RecordingReader::changed(uint8_t controllerIdx) const
+{
+  return (m_changedMask >> controllerIdx) & 1;
+}
+
+uint16_t RecordingReader::_get16()
+{
+  uint16_t vlu = m_data[m_pos] | (m_data[m_pos +1] << 8);
+  m_pos += 2;
+  return vlu;
+}
+
+bool RecordingReader::_readKey()
+{
+  if (!_has(3))
+    return false;
+  uint8_t ctrl = m_data[m_pos++];
+  uint16_t cnt = _get16();
+  if (ctrl >= FrameRecorder::MAX_CONTROLLERS || !_has(cnt * 3))
+    return false;
+  if (m_counts[ctrl] != cnt) {
+    memDelete(MemoryStats::Frames, m_leds[ctrl], m_counts[ctrl]);
+    m_leds[ctrl] = memNew<CRGB>(MemoryStats::Frames, cnt);
+    m_counts[ctrl] = cnt;
+  }
+  memcpy(reinterpret_cast<uint8_t*>(m_leds[ctrl]), &m_data[m_pos], cnt * 3);
+  m_pos += cnt * 3;
+  m_changedMask |= 1 << ctrl;
+  return true;
+}
+
+bool RecordingReader::_readDelta()
+{
+  uint8_t ctrl = m_data[m_pos++];
+  if (ctrl >= FrameRecorder::MAX_CONTROLLERS || !m_leds[ctrl])
+    return false; // delta without keyframe
+  uint8_t *raw = reinterpret_cast<uint8_t*>(m_leds[ctrl]);
+  uint16_t led = 0;
+
+  for (;;) {
+    if (!_has(2))
+      return false;
+    uint16_t skip = _get16();
+    if (skip == SPAN_END)
+      break;
+    if (!_has(4))
+      return false;
+    led += skip;
+    uint8_t hdr = m_data[m_pos++];
+    uint16_t len = (hdr & 0x7F) + 1;
+    if (led + len > m_counts[ctrl])
+      return false;
+    bool repeat = hdr & 0x80;
+    if (!_has(repeat ? 3 : len * 3))
+      return false;
+    for (uint16_t i = 0; i < len; ++i, ++led) {
+      const uint8_t *x = &m_data[m_pos + (repeat ? 0 : i * 3)];
+      raw[led * 3]     ^= x[0];
+      raw[led * 3 + 1] ^= x[1];
+      raw[led * 3 + 2] ^= x[2];
+    }
+    m_pos += repeat ? 3 : len * 3;
+  }
+  m_changedMask |= 1 << ctrl;
+  return true;
+}
@@ -0,0 +1,143 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  Recorder.h
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#ifndef RECORDER_H_
+#define RECORDER_H_
+
+#include <stdint.h>
+#include <FastLED.h>
+#include <Arduino.h>
+
+/**
+ * Recording layout, all values little endian
+ *   'F','L','R','C', uint8_t version 1
+ * then records:
+ *   REC_Frame:    uint32_t time ms, starts a new frame
+ *   REC_Key:      uint8_t controller, uint16_t ledCount, ledCount * r,g,b
+ *   REC_Delta:    uint8_t controller, then spans until skip == 0xFFFF
+ *                   uint16_t skip      unchanged leds before span
+ *                   uint8_t  hdr       bit 7 set: (hdr & 0x7F) +1 leds all
+ *                                      XOR:ed with the same 3 bytes that follows
+ *                                      else hdr +1 leds with 3 XOR bytes each
+ *   REC_Dropped:  uint8_t controller, frame was dropped as buffer was full
+ *                 next record for controller is a keyframe
+ */
+enum RecordTag : uint8_t {
+  REC_Frame = 0xF0,
+  REC_Key = 0xC1,
+  REC_Delta = 0xC2,
+  REC_Dropped = 0xCD
+};
+static const uint8_t RECORDING_VERSION = 1;
+
+/**
+ * @brief: records what FastLED_Action renders to each controller
+ *         frames are encoded into a ring buffer during render and written
+ *         to sink in small pieces by service(), so sink never stalls render
+ *         set it with FastLED_Action::setRecorder()
+ */
+class FrameRecorder {
+public:
+  static const uint8_t MAX_CONTROLLERS = 10;
+
+  /// ringSize is how many bytes that can wait to be written to sink
+  /// keyframeInterval is how many frames between each keyframe
+  explicit FrameRecorder(Print &sink, uint16_t ringSize = 1024,
+                         uint16_t keyframeInterval = 100);
+  ~FrameRecorder();
+
+  /// max bytes written to sink on each service()
+  void setWriteBudget(uint16_t bytes) { m_writeBudget = bytes; }
+
+  /// called by engine when a render has changes
+  void beginFrame(uint32_t time);
+  /// called by engine for each controller that is sent
+  void capture(uint8_t controllerIdx, const CRGB *leds, uint16_t ledCount);
+  /// writes pending bytes to sink, within write budget
+  /// called by engine after each render, call it from idle time too
+  void service();
+  /// write everything pending, blocks
+  void flush();
+
+  uint32_t recordedFrames() const { return m_frames; }
+  uint32_t droppedFrames() const { return m_dropped; }
+  uint32_t bytesWritten() const { return m_written; }
+  uint16_t pending() const { return m_used; }
+
+private:
+  struct Channel {
+    uint8_t *prev;       // last recorded frame, for delta
+    uint16_t ledCount;
+    uint16_t sinceKey;   // frames since last keyframe
+    bool needKey;
+  };
+
+  Print &m_sink;
+  uint8_t *m_ring;
+  uint16_t m_ringSize, m_head, m_tail, m_used,
+           m_keyframeInterval, m_writeBudget;
+  uint32_t m_frames, m_dropped, m_written;
+  Channel m_channels[MAX_CONTROLLERS];
+
+  uint16_t _free() const { return m_ringSize - m_used; }
+  void _put(uint8_t byte);
+  void _put16(uint16_t vlu);
+  void _putBytes(const uint8_t *bytes, uint16_t len);
+  void _keyframe(uint8_t controllerIdx, const uint8_t *raw, uint16_t ledCount);
+  void _delta(uint8_t controllerIdx, const uint8_t *raw, uint16_t ledCount);
+};
+
+// ----------------------------------------------------------
+
+/**
+ * @brief: decodes a recording in memory, ie for regression tests
+ *         against a golden recording
+ */
+class RecordingReader {
+public:
+  explicit RecordingReader(const uint8_t *data, uint32_t size);
+  ~RecordingReader();
+
+  /// false if header is wrong
+  bool isValid() const { return m_valid; }
+  /// decode next frame, false when at end or data is broken
+  bool nextFrame();
+  uint32_t frameTime() const { return m_frameTime; }
+  /// leds of controller as of current frame, nullptr if not recorded yet
+  const CRGB *leds(uint8_t controllerIdx) const;
+  uint16_t ledCount(uint8_t controllerIdx) const;
+  /// true if controller was sent in current frame
+  bool changed(uint8_t controllerIdx) const;
+
+private:
+  const uint8_t *m_data;
+  uint32_t m_size, m_pos, m_frameTime;
+  CRGB *m_leds[FrameRecorder::MAX_CONTROLLERS];
+  uint16_t m_counts[FrameRecorder::MAX_CONTROLLERS];
+  uint16_t m_changedMask;
+  bool m_valid;
+
+  bool _has(uint32_t len) const { return m_pos + len <= m_size; }
+  uint16_t _get16();
+  bool _readKey();
+  bool _readDelta();
+};
+
+#endif /* RECORDER_H_ */
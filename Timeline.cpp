@@ -0,0 +1,266 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  Timeline.cpp
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#include "Timeline.h"
+#include "FastLED_Action.h"
+
+struct PaintCtx {
+  FastLED_Action *engine;
+  CRGB from,
+       to;
+  uint16_t ladderSize; // 0 fills with from
+};
+
+static void paintRun(const LedRun &run, uint16_t logicalIdx, void *ctx)
+{
+  const PaintCtx *paint = static_cast<const PaintCtx*>(ctx);
+  if (paint->ladderSize > 1) {
+    for (uint16_t i = 0; i < run.size; ++i) {
+      fract8 fract = ((uint32_t)(logicalIdx + i) * 255) / (paint->ladderSize -1);
+      run[i] = blend(paint->from, paint->to, fract);
+    }
+  } else {
+    run.fill(paint->from);
+  }
+  paint->engine->setLedControllerHasChanges(run.controller, run.firstLedIdx(),
+                                            run.span());
+}
+
+Timeline::Timeline(TimelineSource &source,
+                   SegmentCommon **segments, uint8_t segmentCount) :
+    m_source(source), m_segments(segments),
+    m_waitUntil(0), m_pc(0),
+    m_segmentCount(segmentCount), m_loopDepth(0),
+    m_running(false), m_error(false)
+{
+  for (uint8_t i = 0; i < MAX_SLOTS; ++i)
+    m_slots[i].op = TL_OpEnd; // free
+}
+
+Timeline::~Timeline()
+{
+}
+
+void Timeline::start()
+{
+  stop();
+  m_error = false;
+  m_running = true;
+}
+
+void Timeline::stop()
+{
+  for (uint8_t i = 0; i < MAX_SLOTS; ++i)
+    m_slots[i].op = TL_OpEnd;
+  m_pc = 0;
+  m_loopDepth = 0;
+  m_waitUntil = 0;
+  m_running = false;
+}
+
+uint8_t Timeline::activeSlots() const
+{
+  uint8_t cnt = 0;
+  for (uint8_t i = 0; i < MAX_SLOTS; ++i)
+    if (m_slots[i].op != TL_OpEnd)
+      ++cnt;
+  return cnt;
+}
+
+void Timeline::update()
+{
+  uint32_t now = millis();
+
+  // advance running steps
+  for (uint8_t i = 0; i < MAX_SLOTS; ++i) {
+    if (m_slots[i].op != TL_OpEnd)
+      _updateSlot(&m_slots[i], now);
+  }
+
+  if (!m_running || (m_waitUntil && (int32_t)(now - m_waitUntil) < 0))
+    return; // signed difference, safe when millis() rolls over
+  m_waitUntil = 0;
+
+  // run program until it has to wait
+  for (uint8_t ops = 0; m_running && ops < MAX_OPS_PER_UPDATE; ++ops) {
+    if (!_exec())
+      break;
+  }
+}
+
+bool Timeline::_exec()
+{
+  uint16_t opPc = m_pc;
+  uint8_t op = m_source.read(m_pc++);
+
+  switch (op) {
+  case TL_OpEnd:
+    m_running = false;
+    return false;
+
+  case TL_OpColor: case TL_OpGotoColor: case TL_OpLadder: {
+    uint8_t seg = m_source.read(m_pc++);
+    if (seg >= m_segmentCount) {
+      _fail();
+      return false;
+    }
+    Slot *slot = _slotFor(seg);
+    if (!slot) {
+      m_pc = opPc; // all slots busy, retry next update
+      return false;
+    }
+    slot->seg = seg;
+    slot->from = _readRGB();
+    slot->to = op == TL_OpColor ? slot->from : _readRGB();
+    slot->duration = _readU16();
+    slot->op = op;
+    _startSlot(slot);
+  } return true;
+
+  case TL_OpWait:
+    m_waitUntil = millis() + _readU16();
+    return false;
+
+  case TL_OpSync:
+    if (activeSlots() > 0) {
+      m_pc = opPc;
+      return false;
+    }
+    return true;
+
+  case TL_OpSyncSeg: {
+    uint8_t seg = m_source.read(m_pc++);
+    for (uint8_t i = 0; i < MAX_SLOTS; ++i) {
+      if (m_slots[i].op != TL_OpEnd && m_slots[i].seg == seg) {
+        m_pc = opPc;
+        return false;
+      }
+    }
+  } return true;
+
+  case TL_OpLoop: {
+    if (m_loopDepth >= MAX_LOOP_DEPTH) {
+      _fail();
+      return false;
+    }
+    LoopFrame &frame = m_loops[m_loopDepth++];
+    frame.remaining = m_source.read(m_pc++);
+    frame.pc = m_pc;
+  } return true;
+
+  case TL_OpEndLoop: {
+    if (m_loopDepth == 0) {
+      _fail();
+      return false;
+    }
+    LoopFrame &frame = m_loops[m_loopDepth -1];
+    if (frame.remaining == 0 || --frame.remaining > 0)
+      m_pc = frame.pc; // next turn
+    else
+      --m_loopDepth; // loop done
+  } return true;
+
+  default:
+    _fail();
+    return false;
+  }
+}
+
+void Timeline::_fail()
+{
+  stop();
+  m_error = true;
+}
+
+uint16_t Timeline::_readU16()
+{
+  uint16_t vlu = m_source.read(m_pc++);
+  vlu |= (uint16_t)m_source.read(m_pc++) << 8;
+  return vlu;
+}
+
+CRGB Timeline::_readRGB()
+{
+  CRGB rgb;
+  rgb.r = m_source.read(m_pc++);
+  rgb.g = m_source.read(m_pc++);
+  rgb.b = m_source.read(m_pc++);
+  return rgb;
+}
+
+Timeline::Slot *Timeline::_slotFor(uint8_t seg)
+{
+  Slot *freeSlot = nullptr;
+  for (uint8_t i = 0; i < MAX_SLOTS; ++i) {
+    if (m_slots[i].op == TL_OpEnd) {
+      if (!freeSlot)
+        freeSlot = &m_slots[i];
+    } else if (m_slots[i].seg == seg)
+      return &m_slots[i]; // replace step running on same segment
+  }
+  return freeSlot;
+}
+
+void Timeline::_startSlot(Slot *slot)
+{
+  SegmentCommon *owner = m_segments[slot->seg];
+  slot->startTime = millis();
+  slot->lastFract = 0;
+  slot->lastColor = cRgbToUInt(slot->from);
+
+  _paint(owner, slot->from, slot->to, slot->op == TL_OpLadder);
+
+  if (slot->duration == 0)
+    slot->op = TL_OpEnd; // instant step, slot is free directly
+}
+
+void Timeline::_updateSlot(Slot *slot, uint32_t now)
+{
+  uint32_t elapsed = now - slot->startTime;
+  if (elapsed >= slot->duration) {
+    if (slot->op == TL_OpGotoColor)
+      _paint(m_segments[slot->seg], slot->to, slot->to, false);
+    slot->op = TL_OpEnd; // free slot
+    return;
+  }
+
+  if (slot->op != TL_OpGotoColor)
+    return; // static steps only occupy their segment
+
+  fract8 fract = (elapsed * 255) / slot->duration;
+  if (fract == slot->lastFract)
+    return; // no visible change
+  slot->lastFract = fract;
+
+  CRGB rgb = blend(slot->from, slot->to, fract);
+  uint32_t color = cRgbToUInt(rgb);
+  if (color == slot->lastColor)
+    return; // close colors, same 8 bit value
+  slot->lastColor = color;
+  _paint(m_segments[slot->seg], rgb, rgb, false);
+}
+
+void Timeline::_paint(SegmentCommon *owner, CRGB from, CRGB to, bool ladder)
+{
+  // run by run, only ranges written are marked changed
+  PaintCtx ctx = { owner->engine(), from, to,
+                   (uint16_t)(ladder ? owner->size() : 0) };
+  owner->forEachRun(paintRun, &ctx);
+}
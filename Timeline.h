@@ -0,0 +1,189 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  Timeline.h
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#ifndef TIMELINE_H_
+#define TIMELINE_H_
+
+#include <stdint.h>
+#include <FastLED.h>
+#include <Arduino.h>
+
+class SegmentCommon;
+
+/**
+ * @brief: opcodes for compact timeline programs
+ *         all multibyte values are little endian
+ *         seg is a index into the segment table given to Timeline
+ */
+enum TimelineOp : uint8_t {
+  TL_OpEnd = 0,   // end of program
+  TL_OpColor,     // seg, r, g, b, ms16: set color, occupy seg for ms
+  TL_OpGotoColor, // seg, r, g, b, r, g, b, ms16: from -> to during ms
+  TL_OpLadder,    // seg, r, g, b, r, g, b, ms16: left -> right, occupy seg for ms
+  TL_OpWait,      // ms16: pause program
+  TL_OpSync,      // wait until all steps has finished
+  TL_OpSyncSeg,   // seg: wait until step on seg has finished
+  TL_OpLoop,      // count: repeat until TL_OpEndLoop count times, 0 is forever
+  TL_OpEndLoop,
+  TL_OpInvalid    // must be last
+};
+
+// helpers to write programs as byte arrays, ie:
+// const uint8_t show[] PROGMEM = {
+//   TL_LOOP(3),
+//     TL_COLOR(0, 0xFF0000, 500), TL_GOTO_COLOR(1, 0x000000, 0x0000FF, 500),
+//     TL_SYNC(),
+//   TL_END_LOOP(),
+//   TL_END()
+// };
+#define TL_U16(v) (uint8_t)((v) & 0xFF), (uint8_t)(((v) >> 8) & 0xFF)
+#define TL_RGB(c) (uint8_t)(((c) >> 16) & 0xFF), (uint8_t)(((c) >> 8) & 0xFF), \
+                  (uint8_t)((c) & 0xFF)
+#define TL_END() TL_OpEnd
+#define TL_COLOR(seg, rgb, ms) TL_OpColor, (seg), TL_RGB(rgb), TL_U16(ms)
+#define TL_GOTO_COLOR(seg, from, to, ms) \
+  TL_OpGotoColor, (seg), TL_RGB(from), TL_RGB(to), TL_U16(ms)
+#define TL_LADDER(seg, left, right, ms) \
+  TL_OpLadder, (seg), TL_RGB(left), TL_RGB(right), TL_U16(ms)
+#define TL_WAIT(ms) TL_OpWait, TL_U16(ms)
+#define TL_SYNC() TL_OpSync
+#define TL_SYNC_SEG(seg) TL_OpSyncSeg, (seg)
+#define TL_LOOP(count) TL_OpLoop, (count)
+#define TL_END_LOOP() TL_OpEndLoop
+
+// ----------------------------------------------------------
+
+/**
+ * @brief: where timeline reads its program from
+ */
+class TimelineSource {
+public:
+  virtual ~TimelineSource() {}
+  virtual uint8_t read(uint16_t pos) = 0;
+};
+
+/// program stored in flash
+class TimelineProgmemSource : public TimelineSource {
+  const uint8_t *m_code;
+public:
+  explicit TimelineProgmemSource(const uint8_t *code) : m_code(code) {}
+  uint8_t read(uint16_t pos) { return pgm_read_byte(m_code + pos); }
+};
+
+/// program stored in RAM
+class TimelineRamSource : public TimelineSource {
+  const uint8_t *m_code;
+public:
+  explicit TimelineRamSource(const uint8_t *code) : m_code(code) {}
+  uint8_t read(uint16_t pos) { return m_code[pos]; }
+};
+
+/// program stored in a file, FileT must have seek(pos) and read(buf, len)
+/// ie SD File, reads are cached in chunks
+template<class FileT, uint8_t ChunkSize = 16>
+class TimelineFileSource : public TimelineSource {
+  FileT &m_file;
+  uint16_t m_chunkPos;
+  uint8_t m_chunkLen;
+  uint8_t m_chunk[ChunkSize];
+public:
+  explicit TimelineFileSource(FileT &file) :
+    m_file(file), m_chunkPos(0), m_chunkLen(0)
+  {}
+  uint8_t read(uint16_t pos) {
+    if (pos < m_chunkPos || pos >= m_chunkPos + m_chunkLen) {
+      m_file.seek(pos);
+      int len = m_file.read(m_chunk, ChunkSize);
+      m_chunkPos = pos;
+      m_chunkLen = len > 0 ? len : 0;
+      if (m_chunkLen == 0)
+        return TL_OpEnd; // read past end, stop program
+    }
+    return m_chunk[pos - m_chunkPos];
+  }
+};
+
+// ----------------------------------------------------------
+
+/**
+ * @brief: a small interpreter for timeline programs
+ *         RAM use is bounded by MAX_SLOTS, not by program length
+ *         each step occupies a slot while it runs, starting a new step on
+ *         a segment replaces the step running on that segment
+ *         if all slots are busy program waits until one is free
+ */
+class Timeline {
+public:
+  static const uint8_t MAX_SLOTS = 4;  // how many steps that can run at the same time
+  static const uint8_t MAX_LOOP_DEPTH = 4;
+  static const uint8_t MAX_OPS_PER_UPDATE = 32; // guard against empty forever loops
+
+  explicit Timeline(TimelineSource &source,
+                    SegmentCommon **segments, uint8_t segmentCount);
+  ~Timeline();
+
+  /// starts program from beginning
+  void start();
+  /// stops program and all running steps, leds are left as is
+  void stop();
+  bool isRunning() const { return m_running; }
+  /// true if program ended because of a bad opcode or segment
+  bool hasError() const { return m_error; }
+  /// how many steps that is running right now
+  uint8_t activeSlots() const;
+
+  /// call from loop() before FastLED_Action::loop()
+  void update();
+
+private:
+  struct Slot {
+    uint8_t op, seg;
+    CRGB from, to;
+    uint32_t startTime;
+    uint32_t lastColor; // last written, from cRgbToUInt
+    uint16_t duration;
+    uint8_t lastFract;
+  };
+  struct LoopFrame {
+    uint16_t pc;
+    uint8_t remaining; // 0 is forever
+  };
+
+  TimelineSource &m_source;
+  SegmentCommon **m_segments;
+  uint32_t m_waitUntil;
+  uint16_t m_pc;
+  uint8_t m_segmentCount,
+          m_loopDepth;
+  bool m_running, m_error;
+  Slot m_slots[MAX_SLOTS];
+  LoopFrame m_loops[MAX_LOOP_DEPTH];
+
+  bool _exec(); // returns false when program must wait
+  void _fail();
+  uint16_t _readU16();
+  CRGB _readRGB();
+  Slot *_slotFor(uint8_t seg);
+  void _startSlot(Slot *slot);
+  void _updateSlot(Slot *slot, uint32_t now);
+  void _paint(SegmentCommon *owner, CRGB from, CRGB to, bool ladder);
+};
+
+#endif /* TIMELINE_H_ */
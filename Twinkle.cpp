@@ -0,0 +1,174 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  Twinkle.cpp
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#include "Twinkle.h"
+#include "Memory.h"
+
+static void fillBackground(const LedRun &run, uint16_t logicalIdx, void *ctx)
+{
+  (void)logicalIdx;
+  run.fill(*static_cast<const CRGB*>(ctx));
+}
+
+ActionTwinkle::ActionTwinkle(CRGB color, uint8_t maxActive,
+                             uint16_t twinkleMs, uint32_t duration) :
+    Action<ActionTwinkle>(duration),
+    m_idx(memNew<uint16_t>(MemoryStats::Actions, maxActive)),
+    m_age(memNew<uint16_t>(MemoryStats::Actions, maxActive)),
+    m_colors(memNew<CRGB>(MemoryStats::Actions, maxActive)),
+    m_color(color),
+    m_background(CRGB::Black),
+    m_random(1), m_lastMs(0),
+    m_twinkleMs(twinkleMs),
+    m_rate(0), m_spawn(0), m_seed(0),
+    m_capacity(maxActive), m_count(0),
+    m_usePalette(false)
+{
+  m_updateTime = 16;
+  // keeps set about full
+  m_rate = twinkleMs > 0 ? (uint32_t)maxActive * 1000 / twinkleMs : 60;
+}
+
+ActionTwinkle::~ActionTwinkle()
+{
+  memDelete(MemoryStats::Actions, m_idx, m_capacity);
+  memDelete(MemoryStats::Actions, m_age, m_capacity);
+  memDelete(MemoryStats::Actions, m_colors, m_capacity);
+}
+
+void ActionTwinkle::step(SegmentCommon *owner, uint16_t deltaMs)
+{
+  uint16_t size = owner->size();
+  if (size == 0)
+    return;
+
+  for (uint8_t i = 0; i < m_count;) {
+    uint32_t age = (uint32_t)m_age[i] + deltaMs;
+    if (age >= m_twinkleMs || age > 0xFFFF) {
+      // done, last takes its place
+      owner->setLed(m_idx[i], m_background);
+      --m_count;
+      m_idx[i] = m_idx[m_count];
+      m_age[i] = m_age[m_count];
+      m_colors[i] = m_colors[m_count];
+      continue;
+    }
+    m_age[i] = age;
+    owner->setLed(m_idx[i], blend(m_background, m_colors[i], _level(age)));
+    ++i;
+  }
+
+  uint32_t spawn = m_spawn + (uint32_t)m_rate * deltaMs;
+  for (; spawn >= 1000; spawn -= 1000) {
+    if (m_count >= m_capacity) {
+      spawn = 0; // set full, don't owe any
+      break;
+    }
+    _spawn(owner, size);
+  }
+  m_spawn = spawn;
+}
+
+uint16_t ActionTwinkle::memoryUsage() const
+{
+  return m_capacity * (2 * sizeof(uint16_t) + sizeof(CRGB));
+}
+
+void ActionTwinkle::onStart(SegmentCommon *owner)
+{
+  // differs between owners, same each run
+  uint32_t ptr = (uint32_t)(uintptr_t)owner;
+  m_random = (ptr * 2654435761UL) ^ ((uint32_t)m_seed << 16 | m_seed);
+  if (m_random == 0)
+    m_random = 1;
+  m_count = 0;
+  m_spawn = 0;
+  m_lastMs = millis();
+  owner->forEachRun(fillBackground, &m_background);
+  owner->dirty();
+}
+
+void ActionTwinkle::onTick(SegmentCommon *owner)
+{
+  uint32_t now = millis(),
+           delta = now - m_lastMs;
+  m_lastMs = now;
+  step(owner, delta > 250 ? 250 : delta);
+}
+
+void ActionTwinkle::onEnd(SegmentCommon *owner)
+{
+  for (uint8_t i = 0; i < m_count; ++i)
+    owner->setLed(m_idx[i], m_background);
+  m_count = 0;
+}
+
+uint8_t ActionTwinkle::_level(uint16_t age) const
+{
+  if (m_twinkleMs == 0)
+    return 255;
+  // up then down, eased at both ends
+  uint8_t pos = ((uint32_t)age * 255) / m_twinkleMs,
+          tri = pos < 128 ? pos << 1 : (255 - pos) << 1;
+  return ease8InOutQuad(tri);
+}
+
+uint16_t ActionTwinkle::_random(uint16_t below)
+{
+  // xorshift32
+  m_random ^= m_random << 13;
+  m_random ^= m_random >> 17;
+  m_random ^= m_random << 5;
+  return ((m_random >> 16) * (uint32_t)below) >> 16;
+}
+
+void ActionTwinkle::_spawn(SegmentCommon *owner, uint16_t size)
+{
+  // a few tries to find a led not already twinkling
+  uint16_t idx = 0;
+  bool taken = true;
+  for (uint8_t tries = 0; tries < 4 && taken; ++tries) {
+    idx = _random(size);
+    taken = false;
+    for (uint8_t i = 0; i < m_count && !taken; ++i)
+      taken = m_idx[i] == idx;
+  }
+  if (taken)
+    return;
+  m_idx[m_count] = idx;
+  m_age[m_count] = 0;
+  m_colors[m_count] = m_usePalette ?
+                        ColorFromPalette(m_palette, _random(256)) : m_color;
+  owner->setLed(idx, blend(m_background, m_colors[m_count], _level(0)));
+  ++m_count;
+}
+
+// ----------------------------------------------------------
+
+ActionSparkle::ActionSparkle(CRGB color, uint16_t perSecond,
+                             uint8_t maxActive, uint32_t duration) :
+    ActionTwinkle(color, maxActive, 0, duration)
+{
+  m_rate = perSecond;
+}
+
+ActionSparkle::~ActionSparkle()
+{
+}
@@ -0,0 +1,106 @@
+/**
+*  Copyright (c) 2026 FastLED_Action contributors. All right reserved.
+*  This library is free software; you can redistribute it and/or
+*  modify it under the terms of the GNU Lesser General Public
+*  License as published by the Free Software Foundation; either
+*  version 2.1 of the License, or (at your option) any later version.
+*  This library is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*  Lesser General Public License for more details.
+*  You should have received a copy of the GNU Lesser General Public
+*  License along with this library; if not, write to the Free Software
+*  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*
+*  Twinkle.h
+*
+*  Created on: 18 okt 2026
+*      Author: FastLED_Action contributors
+*/
+
+#ifndef TWINKLE_H_
+#define TWINKLE_H_
+
+#include <stdint.h>
+#include "FastLED_Action.h"
+#include "Actions.h"
+
+/**
+ * @brief: random leds that fades up from background and back again
+ *         only a small set of active leds is kept, allocated once with
+ *         room for maxActive, each tick only those are written, through
+ *         SegmentCommon::setLed, so only their blocks are sent changed
+ *         background is filled once when started
+ *         random numbers comes from a xorshift seeded by owner, so
+ *         segments sharing a seed still twinkles differently
+ */
+class ActionTwinkle : public Action<ActionTwinkle> {
+  friend class Action<ActionTwinkle>;
+public:
+  explicit ActionTwinkle(CRGB color, uint8_t maxActive = 8,
+                         uint16_t twinkleMs = 800, uint32_t duration = 0);
+  virtual ~ActionTwinkle();
+
+  CRGB color() const { return m_color; }
+  void setColor(CRGB color) { m_color = color; m_usePalette = false; }
+  /// each twinkle gets a random color from palette instead
+  void setPalette(const CRGBPalette16 &palette) {
+    m_palette = palette;
+    m_usePalette = true;
+  }
+  CRGB background() const { return m_background; }
+  void setBackground(CRGB background) { m_background = background; }
+  /// time from start to end of each twinkle, 0 lasts one tick
+  uint16_t twinkleTime() const { return m_twinkleMs; }
+  void setTwinkleTime(uint16_t twinkleMs) { m_twinkleMs = twinkleMs; }
+  /// new twinkles each second, by default enough to keep set full
+  uint16_t rate() const { return m_rate; }
+  void setRate(uint16_t perSecond) { m_rate = perSecond; }
+  void setSeed(uint16_t seed) { m_seed = seed; }
+
+  uint8_t maxActive() const { return m_capacity; }
+  /// leds twinkling now
+  uint8_t active() const { return m_count; }
+  int32_t activeIdx(uint8_t i) const { return i < m_count ? m_idx[i] : -1; }
+
+  /// age all twinkles deltaMs, spawn new ones and write them to owner
+  void step(SegmentCommon *owner, uint16_t deltaMs);
+
+  uint16_t memoryUsage() const;
+
+protected:
+  CRGBPalette16 m_palette;
+  uint16_t *m_idx,
+           *m_age;     // ms since twinkle started
+  CRGB *m_colors,
+       m_color,
+       m_background;
+  uint32_t m_random,
+           m_lastMs;
+  uint16_t m_twinkleMs,
+           m_rate,
+           m_spawn,    // spawns owed, in 1/1000
+           m_seed;
+  uint8_t m_capacity,
+          m_count;
+  bool m_usePalette;
+
+  void onStart(SegmentCommon *owner);
+  void onTick(SegmentCommon *owner);
+  void onEnd(SegmentCommon *owner);
+  uint8_t _level(uint16_t age) const;
+  uint16_t _random(uint16_t below);
+  void _spawn(SegmentCommon *owner, uint16_t size);
+};
+
+// ----------------------------------------------------------
+
+/// leds flash color for one tick, perSecond of them each second
+class ActionSparkle : public ActionTwinkle {
+public:
+  explicit ActionSparkle(CRGB color = CRGB::White, uint16_t perSecond = 60,
+                         uint8_t maxActive = 8, uint32_t duration = 0);
+  virtual ~ActionSparkle();
+};
+
+#endif /* TWINKLE_H_ */
@@ -0,0 +1,393 @@
+// benchmarks for FastLED wrapper, results are printed on Serial
+
+#include <Arduino.h>
+#include <FastLED_Action.h>
+#include <Particles.h>
+#include <Noise.h>
+#include <Audio.h>
+#include <Memory.h>
+#include <GatherSegment.h>
+
+const uint8_t OUTPIN_CH1 = 3,
+              OUTPIN_CH2 = 4;
+const uint8_t NUMLEDS_CH1 = 150,
+              NUMLEDS_CH2 = 150;
+const uint16_t ITERATIONS = 10000,
+               FRAMES = 1000,
+               PARTICLES = 300;
+
+CRGB leds_ch1[NUMLEDS_CH1],
+     leds_ch2[NUMLEDS_CH2];
+
+void report(const char *name, uint32_t micros, uint32_t iterations)
+{
+  Serial.print(name);
+  Serial.print(" ns/iteration:");
+  Serial.println((unsigned long)((uint64_t)micros * 1000 / iterations));
+}
+
+// ----------------------------------------------------------
+// event dispatch
+
+// old style, only virtual onEvent
+class BenchVirtual : public ActionBase {
+public:
+  uint32_t ticks;
+  BenchVirtual() : ActionBase(0), ticks(0) { m_updateTime = 0; }
+  void onEvent(SegmentCommon *owner, EvtType evtType) {
+    (void)owner;
+    if (evtType == Tick)
+      ++ticks;
+  }
+};
+
+// old style, callback that upcasts and then calls virtual onEvent
+class BenchCallback : public ActionBase {
+public:
+  uint32_t ticks;
+  BenchCallback() : ActionBase(0), ticks(0) {
+    m_updateTime = 0;
+    m_eventCB = &BenchCallback::eventCB;
+  }
+  static void eventCB(ActionBase *self, SegmentCommon *owner, EvtType evtType) {
+    reinterpret_cast<BenchCallback*>(self)->onEvent(owner, evtType);
+  }
+  void onEvent(SegmentCommon *owner, EvtType evtType) {
+    (void)owner;
+    if (evtType == Tick)
+      ++ticks;
+  }
+};
+
+// statically dispatched through Action<Derived>
+class BenchStatic : public Action<BenchStatic> {
+  friend class Action<BenchStatic>;
+  void onTick(SegmentCommon *owner) {
+    (void)owner;
+    ++ticks;
+  }
+public:
+  uint32_t ticks;
+  BenchStatic() : Action<BenchStatic>(0), ticks(0) { m_updateTime = 0; }
+};
+
+// each loop ticks the action as update time is 0
+uint32_t benchLoop(ActionBase &action, Segment &seg)
+{
+  seg.addAction(action);
+  uint32_t start = micros();
+  for (uint16_t i = 0; i < ITERATIONS; ++i)
+    action.loop(&seg);
+  uint32_t time = micros() - start;
+  seg.removeAction(action);
+  return time;
+}
+
+void benchDispatch(Segment &seg)
+{
+  BenchVirtual actVirtual;
+  BenchCallback actCallback;
+  BenchStatic actStatic;
+  report("dispatch virtual", benchLoop(actVirtual, seg), ITERATIONS);
+  report("dispatch callback+virtual", benchLoop(actCallback, seg), ITERATIONS);
+  report("dispatch static", benchLoop(actStatic, seg), ITERATIONS);
+}
+
+// ----------------------------------------------------------
+// particles, a 60 fps frame over 2 controllers
+
+uint16_t benchRandom()
+{
+  static uint16_t seed = 1234;
+  seed = seed * 25173 + 13849;
+  return seed;
+}
+
+// keeps pool full
+void benchEmit(ActionParticles &particles, SegmentCommon *owner,
+               uint16_t deltaMs, void *ctx)
+{
+  (void)deltaMs; (void)ctx;
+  int32_t end = (int32_t)owner->size() << 8;
+  while (particles.emit(benchRandom() % end, (int16_t)benchRandom() >> 4,
+                        CHSV(benchRandom() >> 8, 255, 255),
+                        500 + (benchRandom() & 1023)))
+  {}
+}
+
+void benchParticles(Segment &seg, uint8_t trail, const char *name)
+{
+  ActionParticles particles(PARTICLES);
+  particles.setEmitter(benchEmit, nullptr);
+  particles.setTrail(trail);
+  particles.setFadeTime(200);
+  uint32_t start = micros();
+  for (uint16_t i = 0; i < FRAMES; ++i)
+    particles.step(&seg, 16);
+  report(name, micros() - start, FRAMES);
+}
+
+// ----------------------------------------------------------
+// noise, cost of each led each frame
+
+void benchNoise(Segment &seg)
+{
+  CRGBPalette16 palette(CRGB::Blue, CRGB::Orange);
+  ActionNoise noise(palette, 4, 64, 3);
+  uint32_t pixels = (uint32_t)FRAMES * seg.size();
+
+  uint32_t start = micros();
+  for (uint16_t i = 0; i < FRAMES; ++i)
+    noise.render(&seg, i * 4);
+  report("noise 3 octaves 1 cached, led", micros() - start, pixels);
+
+  noise.setCachedOctaves(0);
+  start = micros();
+  for (uint16_t i = 0; i < FRAMES; ++i)
+    noise.render(&seg, i * 4);
+  report("noise 3 octaves uncached, led", micros() - start, pixels);
+
+  // each led on its own, no lattice reuse
+  start = micros();
+  for (uint16_t i = 0; i < FRAMES; ++i) {
+    for (uint16_t x = 0; x < seg.size(); ++x)
+      *seg[x] = ColorFromPalette(palette, noise.sample(x, 0, i * 4));
+  }
+  report("noise 3 octaves sampled, led", micros() - start, pixels);
+}
+
+// ----------------------------------------------------------
+// audio analysis, each block is one FFT, bands and beat
+
+int16_t audioSamples[1024];
+
+void benchAudio(uint8_t fftBits, const char *name)
+{
+  MemorySampleSource source(audioSamples, 1024, true);
+  AudioAnalyzer analyzer(source, 22050, fftBits, 8);
+  analyzer.setRealtime(false);
+  uint32_t start = micros();
+  for (uint16_t i = 0; i < FRAMES; ++i)
+    analyzer.update(1);
+  report(name, micros() - start, FRAMES);
+}
+
+// ----------------------------------------------------------
+// scheduler churn, programs that adds and removes actions all the time
+// random ops on random segments, each op timed for worst case
+
+#ifdef FASTLED_ACTION_HOST
+const uint16_t CHURN_SEGMENTS = 2000;
+const uint32_t CHURN_OPS = 200000;
+#else
+const uint16_t CHURN_SEGMENTS = 16;
+const uint32_t CHURN_OPS = 2000;
+#endif
+const uint8_t CHURN_POOL = 32,    // actions segments draws from
+              CHURN_ACTIONS = 8;  // most actions in a segment
+
+void benchChurn()
+{
+  FastLED_Action engine;
+  Segment **segs = new Segment*[CHURN_SEGMENTS];
+  for (uint16_t i = 0; i < CHURN_SEGMENTS; ++i)
+    segs[i] = new Segment(&engine);
+  ActionWait *pool[CHURN_POOL];
+  for (uint8_t i = 0; i < CHURN_POOL; ++i)
+    pool[i] = new ActionWait(60000);
+
+  uint32_t allocations = MemoryStats::allocations(),
+           updates = 0, updateTime = 0, worstUpdate = 0,
+           total = 0, worst = 0;
+  MemoryStats::resetHighWater();
+  for (uint32_t op = 0; op < CHURN_OPS; ++op) {
+    Segment *seg = segs[benchRandom() % CHURN_SEGMENTS];
+    ActionWait *action = pool[benchRandom() % CHURN_POOL];
+    uint16_t r = benchRandom();
+    uint32_t start = micros();
+    switch (r & 7) {
+    case 0: case 1: case 2:
+      if (seg->actionsSize() < CHURN_ACTIONS)
+        seg->addAction(action);
+      else
+        seg->removeActionByIdx((r >> 8) % CHURN_ACTIONS);
+      break;
+    case 3: case 4:
+      seg->removeAction(action);
+      break;
+    case 5:
+      seg->nextAction();
+      break;
+    default:
+      if (seg->actionsSize() > 0)
+        seg->setCurrentActionIdx((r >> 8) % seg->actionsSize());
+    }
+    uint32_t time = micros() - start;
+    total += time;
+    if (time > worst)
+      worst = time;
+
+    if ((op & 1023) == 1023) {
+      // a frame over all segments, between ops
+      start = micros();
+      engine.update();
+      time = micros() - start;
+      updateTime += time;
+      if (time > worstUpdate)
+        worstUpdate = time;
+      ++updates;
+    }
+  }
+
+  report("churn add/remove/next/setIdx, op", total, CHURN_OPS);
+  Serial.print("churn ops/s:");
+  Serial.println((unsigned long)(total ? (uint64_t)CHURN_OPS * 1000000 / total : 0));
+  Serial.print("churn worst op us:");
+  Serial.println((unsigned long)worst);
+  Serial.print("churn allocations:");
+  Serial.println((unsigned long)(MemoryStats::allocations() - allocations));
+  Serial.print("churn list bytes high water:");
+  Serial.println((unsigned long)MemoryStats::highWater(MemoryStats::Lists));
+  report("churn update all segments, update", updateTime, updates ? updates : 1);
+  Serial.print("churn worst update us:");
+  Serial.println((unsigned long)worstUpdate);
+
+  for (uint16_t i = 0; i < CHURN_SEGMENTS; ++i)
+    delete segs[i];
+  delete[] segs;
+  for (uint8_t i = 0; i < CHURN_POOL; ++i)
+    delete pool[i];
+}
+
+// ----------------------------------------------------------
+// gather, every third led and scattered points, as one led parts
+// against a GatherSegment
+
+const uint8_t GATHER_POINTS = 50;
+
+void gatherFill(const LedRun &run, uint16_t logicalIdx, void *ctx)
+{
+  (void)logicalIdx;
+  run.fill(*static_cast<const CRGB*>(ctx));
+}
+
+uint32_t gatherBytes()
+{
+  return MemoryStats::current(MemoryStats::Lists) +
+         MemoryStats::current(MemoryStats::Layout);
+}
+
+void gatherCount(const LedRun &run, uint16_t logicalIdx, void *ctx)
+{
+  (void)run; (void)logicalIdx;
+  ++*static_cast<uint16_t*>(ctx);
+}
+
+void benchGatherSeg(Segment &seg, uint32_t objBytes, const char *name)
+{
+  uint32_t before = gatherBytes();
+  uint16_t runs = 0;
+  seg.forEachRun(gatherCount, &runs); // first walk sets up layout
+  CRGB color = CRGB::Red;
+  uint32_t start = micros();
+  for (uint16_t i = 0; i < FRAMES; ++i) {
+    color.r = i;
+    seg.forEachRun(gatherFill, &color);
+  }
+  uint32_t fillTime = micros() - start;
+
+  uint32_t sum = 0;
+  uint16_t size = seg.size();
+  start = micros();
+  for (uint16_t i = 0; i < FRAMES; ++i) {
+    for (uint16_t j = 0; j < size; ++j)
+      sum += seg[j]->r;
+  }
+  uint32_t idxTime = micros() - start;
+
+  Serial.print(name);
+  Serial.print(" runs:");
+  Serial.print(runs);
+  Serial.print(" bytes:");
+  Serial.println((unsigned long)(objBytes + gatherBytes() - before));
+  report("  fill, frame", fillTime, FRAMES);
+  report("  seg[idx], led", idxTime, (uint32_t)FRAMES * size);
+  if (sum == 1)
+    Serial.println(); // keeps reads
+}
+
+void benchGather(CLEDController *cont_ch1, CLEDController *cont_ch2)
+{
+  uint16_t points[GATHER_POINTS];
+  for (uint8_t i = 0; i < GATHER_POINTS; ++i)
+    points[i] = benchRandom() % NUMLEDS_CH2;
+
+  {
+    uint32_t before = gatherBytes();
+    Segment seg;
+    SegmentPart *parts[GATHER_POINTS * 2];
+    for (uint8_t i = 0; i < GATHER_POINTS; ++i) {
+      parts[i] = new SegmentPart(cont_ch1, i * 3, 1);
+      parts[GATHER_POINTS + i] = new SegmentPart(cont_ch2, points[i], 1);
+    }
+    for (uint8_t i = 0; i < GATHER_POINTS * 2; ++i)
+      seg.addSegmentPart(parts[i]);
+    benchGatherSeg(seg, sizeof(seg) + GATHER_POINTS * 2 * sizeof(SegmentPart) +
+                        gatherBytes() - before,
+                   "gather 100 one led parts");
+    for (uint8_t i = 0; i < GATHER_POINTS * 2; ++i)
+      delete parts[i];
+  }
+
+  {
+    uint32_t before = gatherBytes();
+    GatherSegment seg;
+    seg.addRange(cont_ch1, 0, GATHER_POINTS, 3);
+    seg.addIndices(cont_ch2, points, GATHER_POINTS);
+    benchGatherSeg(seg, sizeof(seg) + gatherBytes() - before,
+                   "gather GatherSegment 100");
+  }
+}
+
+// ----------------------------------------------------------
+
+void FastLED_Action::program()
+{
+  CLEDController
+    *cont_ch1 = &FastLED.addLeds<UCS1903, OUTPIN_CH1, BRG>(leds_ch1, NUMLEDS_CH1),
+    *cont_ch2 = &FastLED.addLeds<UCS1903, OUTPIN_CH2, BRG>(leds_ch2, NUMLEDS_CH2);
+  Segment seg;
+  SegmentPart part(cont_ch1, 0, 100);
+  seg.addSegmentPart(part);
+
+  benchDispatch(seg);
+
+  Segment strip;
+  SegmentPart strip_ch1(cont_ch1, 0, NUMLEDS_CH1),
+              strip_ch2(cont_ch2, 0, NUMLEDS_CH2);
+  strip_ch2.setReversed(true);
+  strip.addSegmentPart(strip_ch1);
+  strip.addSegmentPart(strip_ch2);
+  benchParticles(strip, 0, "particles 300, frame");
+  benchParticles(strip, 192, "particles 300 trails, frame");
+  benchNoise(strip);
+
+  for (uint16_t i = 0; i < 1024; ++i)
+    audioSamples[i] = (int16_t)(random16() - 32768) / 4 + sin16(i * 1500) / 2;
+  benchAudio(7, "audio fft 128, block");
+  benchAudio(8, "audio fft 256, block");
+
+  benchChurn();
+  benchGather(cont_ch1, cont_ch2);
+}
+
+void setup() {
+  delay(100);
+  Serial.begin(115200);
+}
+
+void loop(){
+  FastLED_Action::runProgram();
+  while(true)
+    yield(); // done
+}
@@ -3,6 +3,27 @@
 #include <testmacros.h>
 #include <Arduino.h>
 #include <FastLED_Action.h>
+#include <Timeline.h>
+#include <Playback.h>
+#include <Recorder.h>
+#include <NetworkStream.h>
+#include <Correction.h>
+#include <IndexedSegment.h>
+#include <MirrorSegment.h>
+#include <MatrixSegment.h>
+#include <Filters.h>
+#include <Particles.h>
+#include <Noise.h>
+#include <Audio.h>
+#include <Twinkle.h>
+#include <Memory.h>
+#include <GatherSegment.h>
+#ifdef FASTLED_ACTION_HOST
+# include <sys/socket.h>
+# include <netinet/in.h>
+# include <unistd.h>
+# include <stdio.h>
+#endif
 
 initTests();
 
@@ -460,9 +481,12 @@ void testActions(){
     seg1.addAction(actBright1);
     FastLED_Action::loop();
     testTypeHint(cRgbToUInt(*seg1[seg1.size() -1]), 0xFFFFFF, uint32_t);
+    test(seg1.brightness(), 255);
     FastLED_Action::loop();
     seg1.yieldUntilAction();
-    testTypeHint(cRgbToUInt(*seg1[seg1.size() -1]), 0x111111, uint32_t);
+    // faded level is in the leds when done, brightness is back
+    testTypeHint(cRgbToUInt(*seg1[seg1.size() -1]), 0x191919, uint32_t);
+    test(seg1.brightness(), 255);
 
     while(seg1.actionsSize())
       seg1.removeActionByIdx(0);
@@ -502,13 +526,2225 @@ void testActions(){
 
     FastLED_Action::loop();
     seg1.yieldUntilAction();
-    testTypeHint(cRgbToUInt(*seg1[0]), 0x666666, uint32_t);
+    testTypeHint(cRgbToUInt(*seg1[0]), CRGB::Gray, uint32_t);
 
     FastLED_Action::loop();
     seg1.yieldUntilAction();
     testTypeHint(cRgbToUInt(*seg1[0]), 0xFFFFFF, uint32_t);
 }
 
+// eases only half way
+struct EaseHalf {
+  static uint8_t ease(uint8_t x) { return x / 2; }
+};
+
+void testTween(){
+  setAllBlack();
+
+  CLEDController
+    *cont_ch1 = &FastLED.addLeds<UCS1903, OUTPIN_CH1, BRG>(leds_ch1, NUMLEDS_CH1);
+  FastLED_Action engine;
+  Segment seg1(&engine);
+  SegmentPart segPart1_ch1(cont_ch1, 10, 15);
+  seg1.addSegmentPart(segPart1_ch1);
+
+  ActionTween<TweenColor, EaseHalf>
+      actTween(TweenColor(CRGB::Black, CRGB::White), 100);
+  actTween.setSingleShot(true);
+  seg1.addAction(actTween);
+  uint32_t time = millis();
+  engine.update();
+  checkAllSegmentPartColors(segPart1_ch1, CRGB::Black, __LINE__);
+  while(millis() - time < 50) {
+    engine.update();
+    testDelay(1);
+  }
+  test(leds_ch1[10].r > 0 && leds_ch1[10].r < 0x7F, true);
+  while(seg1.actionsSize() > 0 && millis() - time < 200) {
+    engine.update();
+    testDelay(1);
+  }
+  test(seg1.actionsSize(), 0);
+  checkAllSegmentPartColors(segPart1_ch1, 0x7F7F7F, __LINE__);
+
+  // ease out starts from current color and is ahead of linear half way
+  ActionEaseInOut actEase(CRGB::Red, -1, 100);
+  actEase.setSingleShot(true);
+  seg1.addAction(actEase);
+  time = millis();
+  engine.update();
+  checkAllSegmentPartColors(segPart1_ch1, 0x7F7F7F, __LINE__);
+  while(millis() - time < 35) {
+    engine.update();
+    testDelay(1);
+  }
+  test(leds_ch1[10].g < 0x50, true); // first tick, linear would be 0x59
+  while(seg1.actionsSize() > 0 && millis() - time < 200) {
+    engine.update();
+    testDelay(1);
+  }
+  checkAllSegmentPartColors(segPart1_ch1, CRGB::Red, __LINE__);
+}
+
+void testEasing(){
+  setAllBlack();
+
+  // tables are generated at compile time, endpoints are exact
+  typedef EaseTable<CurveInOut<CurveQuad> > InOutQuad;
+  test(InOutQuad::ease(0), 0);
+  test(InOutQuad::ease(255), 255);
+  test(InOutQuad::ease(128) >= 126 && InOutQuad::ease(128) <= 130, true);
+  test(InOutQuad::ease(64) < 40, true); // 0.125 of way
+  test(EaseTable<CurveExpo>::ease(0), 0);
+  test(EaseTable<CurveExpo>::ease(255), 255);
+  test(EaseTable<CurveExpo>::ease(128) < 10, true);
+  typedef EaseTable<CurveOut<CurveBounce>, 65> OutBounce;
+  test(OutBounce::ease(255), 255);
+  test(OutBounce::ease(93) > 240, true); // first bounce
+  typedef EaseTable<CurveSine, 2> TwoPoints;
+  test(TwoPoints::ease(128) >= 127 && TwoPoints::ease(128) <= 129, true); // linear
+  typedef EaseTable<CurveBezier<107, 0, 148, 255> > Bezier;
+  test(Bezier::ease(128) >= 126 && Bezier::ease(128) <= 130, true);
+  test(Bezier::ease(32) < 16, true);
+  test(pgm_read_byte(Bezier::table() + 32), 255);
+
+  // runtime chosen curve, default is linear
+  EasingCurve linear, cubic(EaseTable<CurveCubic>::curve());
+  test(linear.ease(77), 77);
+  test(cubic.ease(255), 255);
+  test(cubic.ease(128) >= 30 && cubic.ease(128) <= 34, true);
+
+  CLEDController
+    *cont_ch1 = &FastLED.addLeds<UCS1903, OUTPIN_CH1, BRG>(leds_ch1, NUMLEDS_CH1);
+  FastLED_Action engine;
+  Segment seg1(&engine);
+  SegmentPart segPart1_ch1(cont_ch1, 10, 15);
+  seg1.addSegmentPart(segPart1_ch1);
+
+  ActionTween<TweenColor, EaseTable<CurveIn<CurveCubic> > >
+      actTween(TweenColor(CRGB::Black, CRGB::White), 100);
+  actTween.setSingleShot(true);
+  seg1.addAction(actTween);
+  uint32_t time = millis();
+  engine.update();
+  while(millis() - time < 50) {
+    engine.update();
+    testDelay(1);
+  }
+  test(leds_ch1[10].r < 0x40, true); // cubic is slow to start
+  while(seg1.actionsSize() > 0 && millis() - time < 200) {
+    engine.update();
+    testDelay(1);
+  }
+  checkAllSegmentPartColors(segPart1_ch1, CRGB::White, __LINE__);
+
+  ActionEaseInOut actEase(CRGB::Blue, EaseTable<CurveOut<CurveExpo> >::curve(), 100);
+  actEase.setSingleShot(true);
+  seg1.addAction(actEase);
+  time = millis();
+  while(seg1.actionsSize() > 0 && millis() - time < 200) {
+    engine.update();
+    testDelay(1);
+  }
+  checkAllSegmentPartColors(segPart1_ch1, CRGB::Blue, __LINE__);
+}
+
+void testEngineInstances(){
+  setAllBlack();
+
+  CLEDController
+    *cont_ch1 = &FastLED.addLeds<UCS1903, OUTPIN_CH1, BRG>(leds_ch1, NUMLEDS_CH1),
+    *cont_ch2 = &FastLED.addLeds<UCS1903, OUTPIN_CH2, BRG>(leds_ch2, NUMLEDS_CH2);
+
+  FastLED_Action engine;
+  Segment segDefault, segOwn(&engine);
+  SegmentPart segPart1_ch1(cont_ch1, 10, 15),
+              segPart1_ch2(cont_ch2, 5, 20);
+  segDefault.addSegmentPart(&segPart1_ch1);
+  segOwn.addSegmentPart(&segPart1_ch2);
+
+  test((uint32_t)segDefault.engine(), (uint32_t)&FastLED_Action::instance());
+  test((uint32_t)segOwn.engine(), (uint32_t)&engine);
+  test(engine.isAttached(&segOwn), true);
+  test(FastLED_Action::instance().isAttached(&segOwn), false);
+
+  ActionColor actColor1(CRGB::Red), actColor2(CRGB::Green);
+  segDefault.addAction(actColor1);
+  segOwn.addAction(actColor2);
+
+  // default instance should not touch segments in other instance
+  FastLED_Action::loop();
+  checkAllSegmentPartColors(segPart1_ch1, CRGB::Red, __LINE__);
+  checkAllSegmentPartColors(segPart1_ch2, CRGB::Black, __LINE__);
+  test(engine.stats().loops, 0);
+
+  engine.update();
+  checkAllSegmentPartColors(segPart1_ch2, CRGB::Green, __LINE__);
+  test(engine.stats().loops, 1);
+  test(engine.stats().frames, 1);
+  test(engine.stats().shows, 1);
+  test(engine.ledControllerHasChanges(cont_ch2), false);
+
+  // nothing changed, nothing sent
+  engine.update();
+  test(engine.stats().loops, 2);
+  test(engine.stats().frames, 1);
+
+  // compound moves its sub segments to its own instance
+  SegmentCompound compound(&engine);
+  compound.addSegment(segDefault);
+  test((uint32_t)segDefault.engine(), (uint32_t)&engine);
+  test(FastLED_Action::instance().isAttached(&segDefault), false);
+  compound.removeSegment(segDefault);
+  test(engine.isAttached(&segDefault), true);
+
+  segDefault.setEngine(nullptr);
+  test((uint32_t)segDefault.engine(), (uint32_t)&FastLED_Action::instance());
+  test(FastLED_Action::instance().isAttached(&segDefault), true);
+  test(engine.isAttached(&segDefault), false);
+
+  engine.clearActions();
+  test(segOwn.actionsSize(), 0);
+  FastLED_Action::clearAllActions();
+}
+
+const uint8_t timelineProgram[] PROGMEM = {
+  TL_LOOP(2),
+    TL_COLOR(0, 0xFF0000, 100),
+    TL_GOTO_COLOR(1, 0x000000, 0x0000FF, 200),
+    TL_SYNC_SEG(0),
+    TL_COLOR(0, CRGB::Green, 0),
+    TL_SYNC(),
+  TL_END_LOOP(),
+  TL_WAIT(50),
+  TL_LADDER(0, 0x000000, 0xFFFFFF, 0),
+  TL_END()
+};
+
+void testTimeline(){
+  setAllBlack();
+
+  CLEDController
+    *cont_ch1 = &FastLED.addLeds<UCS1903, OUTPIN_CH1, BRG>(leds_ch1, NUMLEDS_CH1);
+  Segment seg1, seg2;
+  SegmentPart segPart1_ch1(cont_ch1, 10, 15),
+              segPart2_ch1(cont_ch1, 30, 20);
+  seg1.addSegmentPart(segPart1_ch1);
+  seg2.addSegmentPart(segPart2_ch1);
+
+  SegmentCommon *segments[] = { &seg1, &seg2 };
+  TimelineProgmemSource source(timelineProgram);
+  Timeline timeline(source, segments, 2);
+  test(timeline.isRunning(), false);
+  FastLED_Action::loop(); // sends what setAllBlack changed
+  timeline.start();
+  test(timeline.isRunning(), true);
+
+  uint32_t time = millis();
+  timeline.update();
+  test(timeline.activeSlots(), 2);
+  checkAllSegmentPartColors(segPart1_ch1, CRGB::Red, __LINE__);
+  checkAllSegmentPartColors(segPart2_ch1, CRGB::Black, __LINE__);
+  test(FastLED_Action::instance().ledControllerHasChanges(cont_ch1), true);
+  // only leds written are marked changed
+  test(FastLED_Action::instance().ledControllerHasChanges(cont_ch1, 10, 40), true);
+  test(FastLED_Action::instance().ledControllerHasChanges(cont_ch1, 64, 86), false);
+
+  // seg1 gets green when its first step is done, seg2 still fading
+  while(millis() - time < 120) {
+    timeline.update();
+    testDelay(1);
+  }
+  checkAllSegmentPartColors(segPart1_ch1, CRGB::Green, __LINE__);
+  test(timeline.activeSlots(), 1);
+  test(leds_ch1[30].b > 0 && leds_ch1[30].b < 255, true);
+
+  // second turn and the wait after
+  while(timeline.isRunning() && millis() - time < 1000) {
+    timeline.update();
+    testDelay(1);
+  }
+  test(timeline.isRunning(), false);
+  test(timeline.hasError(), false);
+  checkTime(millis() - time, 470, __LINE__);
+  checkAllSegmentPartColors(segPart2_ch1, CRGB::Blue, __LINE__);
+  testTypeHint(cRgbToUInt(*seg1[0]), CRGB::Black, uint32_t);
+  testTypeHint(cRgbToUInt(*seg1[seg1.size() -1]), 0xFFFFFF, uint32_t);
+
+  // bad segment idx stops program
+  const uint8_t badProgram[] = { TL_COLOR(5, 0xFF0000, 10), TL_END() };
+  TimelineRamSource badSource(badProgram);
+  Timeline badTimeline(badSource, segments, 2);
+  badTimeline.start();
+  badTimeline.update();
+  test(badTimeline.isRunning(), false);
+  test(badTimeline.hasError(), true);
+}
+
+void testPlayback(){
+  setAllBlack();
+
+  CLEDController
+    *cont_ch1 = &FastLED.addLeds<UCS1903, OUTPIN_CH1, BRG>(leds_ch1, NUMLEDS_CH1),
+    *cont_ch2 = &FastLED.addLeds<UCS1903, OUTPIN_CH2, BRG>(leds_ch2, NUMLEDS_CH2);
+  Segment seg1;
+  SegmentPart segPart1_ch1(cont_ch1, 10, 4),
+              segPart1_ch2(cont_ch2, 5, 4);
+  seg1.addSegmentPart(segPart1_ch1);
+  seg1.addSegmentPart(segPart1_ch2);
+
+  // 3 frames of 8 leds at 10fps, frame n has all leds at r,g,b = n+1
+  const uint8_t frameCnt = 3, ledCnt = 8;
+  const uint16_t dataPos = PLAYBACK_HEADER_SIZE + frameCnt * 4;
+  uint8_t file[dataPos + frameCnt * ledCnt * 3];
+  const uint8_t hdr[] = { 'F','L','A','P', PLAYBACK_VERSION, 10, ledCnt, 0,
+                          frameCnt, 0, 0, 0 };
+  memcpy(file, hdr, sizeof(hdr));
+  for (uint8_t f = 0; f < frameCnt; ++f) {
+    uint16_t pos = dataPos + f * ledCnt * 3;
+    uint8_t *idx = &file[PLAYBACK_HEADER_SIZE + f * 4];
+    idx[0] = pos & 0xFF; idx[1] = pos >> 8; idx[2] = idx[3] = 0;
+    memset(&file[pos], f + 1, ledCnt * 3);
+  }
+
+  MemoryFrameSource source(file, sizeof(file));
+  ActionPlayback actPlayback(source);
+  seg1.addAction(actPlayback);
+
+  FastLED_Action::loop();
+  test(actPlayback.isValid(), true);
+  test(actPlayback.frameCount(), 3);
+  test(actPlayback.currentFrame(), 0);
+  checkAllSegmentPartColors(segPart1_ch1, 0x010101, __LINE__);
+  checkAllSegmentPartColors(segPart1_ch2, 0x010101, __LINE__);
+  testTypeHint(cRgbToUInt(leds_ch1[14]), CRGB::Black, uint32_t);
+
+  testDelay(110);
+  test(actPlayback.currentFrame(), 1);
+  checkAllSegmentPartColors(segPart1_ch2, 0x020202, __LINE__);
+
+  // wraps around to first frame
+  testDelay(200);
+  test(actPlayback.currentFrame(), 0);
+
+  actPlayback.seek(2);
+  testDelay(40);
+  test(actPlayback.currentFrame(), 2);
+  checkAllSegmentPartColors(segPart1_ch1, 0x030303, __LINE__);
+
+  // keeps time over whole seconds, 2040ms is 20 frames from frame 2
+  testDelay(2000);
+  test(actPlayback.currentFrame(), 1);
+  checkAllSegmentPartColors(segPart1_ch1, 0x020202, __LINE__);
+  seg1.removeAction(actPlayback);
+
+  // broken header does nothing
+  file[0] = 'X';
+  ActionPlayback actBroken(source);
+  seg1.addAction(actBroken);
+  FastLED_Action::loop();
+  test(actBroken.isValid(), false);
+  checkAllSegmentPartColors(segPart1_ch1, 0x020202, __LINE__);
+  seg1.removeAction(actBroken);
+}
+
+// collects everything written to it
+class MemoryPrint : public Print {
+public:
+  uint8_t buf[1024];
+  uint16_t len;
+  MemoryPrint() : len(0) {}
+  size_t write(uint8_t c) {
+    if (len >= sizeof(buf))
+      return 0;
+    buf[len++] = c;
+    return 1;
+  }
+};
+
+void testRecorder(){
+  setAllBlack();
+
+  CLEDController
+    *cont_ch2 = &FastLED.addLeds<UCS1903, OUTPIN_CH2, BRG>(leds_ch2, NUMLEDS_CH2);
+  FastLED_Action engine;
+  Segment seg1(&engine);
+  SegmentPart segPart1_ch2(cont_ch2, 5, 20);
+  seg1.addSegmentPart(segPart1_ch2);
+
+  MemoryPrint sink;
+  FrameRecorder recorder(sink, 512, 10);
+  engine.setRecorder(&recorder);
+
+  ActionColor actColor(CRGB::Red, 100);
+  seg1.addAction(actColor);
+  engine.update(); // keyframe
+  leds_ch2[7] = CRGB::Blue;
+  leds_ch2[8] = CRGB::Green;
+  seg1.dirty();
+  engine.update(); // small delta
+  engine.update(); // nothing changed, no frame
+  test(recorder.recordedFrames(), 2);
+  test(recorder.droppedFrames(), 0);
+  recorder.flush();
+  test(recorder.pending(), 0);
+
+  // keyframe is 5 header + 5 frame + 4 + leds, delta is a lot smaller
+  uint16_t keySize = 5 + 5 + 4 + NUMLEDS_CH2 * 3;
+  test(sink.len > keySize, true);
+  test(sink.len < keySize + 5 + 20, true);
+
+  RecordingReader reader(sink.buf, sink.len);
+  test(reader.isValid(), true);
+  test(reader.nextFrame(), true);
+  test(reader.changed(0), true);
+  test(reader.ledCount(0), NUMLEDS_CH2);
+  testTypeHint(cRgbToUInt(reader.leds(0)[5]), CRGB::Red, uint32_t);
+  testTypeHint(cRgbToUInt(reader.leds(0)[4]), CRGB::Black, uint32_t);
+  test(reader.nextFrame(), true);
+  for (uint8_t i = 0; i < NUMLEDS_CH2; ++i)
+    testTypeHint(cRgbToUInt(reader.leds(0)[i]), cRgbToUInt(leds_ch2[i]), uint32_t);
+  test(reader.nextFrame(), false);
+
+  engine.setRecorder(nullptr);
+  seg1.removeAction(actColor);
+}
+
+void testOutputCorrection(){
+  setAllBlack();
+
+  // tables
+  OutputCorrection linear;
+  for (uint16_t v = 0; v < 256; ++v)
+    test(linear.lookup(1, v), v);
+  OutputCorrection gamma(2.0f);
+  test(gamma.lookup(0, 0), 0);
+  test(gamma.lookup(0, 128), 64);
+  test(gamma.lookup(0, 255), 255);
+
+  CRGB src[2] = { CRGB(0x10, 0x80, 0xFF), CRGB(0xFF, 0, 0) },
+       dst[2];
+  OutputCorrection brg(1.0f, CRGB(255, 128, 255), BRG);
+  brg.apply(src, dst, 2);
+  test(dst[0].r, 0xFF); // blue first
+  test(dst[0].g, 0x10);
+  test(dst[0].b, 0x40); // green at half balance
+  test(dst[1].g, 0xFF);
+
+  // render sends corrected leds, buffer stays linear
+  CLEDController
+    *cont_ch2 = &FastLED.addLeds<UCS1903, OUTPIN_CH2, BRG>(leds_ch2, NUMLEDS_CH2);
+  FastLED_Action engine;
+  Segment seg1(&engine);
+  SegmentPart segPart1_ch2(cont_ch2, 5, 20);
+  seg1.addSegmentPart(segPart1_ch2);
+  engine.setOutputCorrection(cont_ch2, &brg);
+  test(engine.outputCorrection(cont_ch2) == &brg, true);
+
+  MemoryPrint sink;
+  FrameRecorder recorder(sink, 512, 10);
+  engine.setRecorder(&recorder);
+
+  ActionColor actColor(CRGB(0x20, 0x80, 0x40), 100);
+  seg1.addAction(actColor);
+  engine.update();
+  recorder.flush();
+  checkAllSegmentPartColors(segPart1_ch2, 0x208040, __LINE__);
+
+  RecordingReader reader(sink.buf, sink.len);
+  test(reader.nextFrame(), true);
+  testTypeHint(cRgbToUInt(reader.leds(0)[5]), 0x402040, uint32_t);
+  testTypeHint(cRgbToUInt(reader.leds(0)[4]), 0, uint32_t);
+
+  engine.setRecorder(nullptr);
+  engine.setOutputCorrection(cont_ch2, nullptr);
+  seg1.removeAction(actColor);
+}
+
+void testBrightness(){
+  setAllBlack();
+
+  CLEDController
+    *cont_ch1 = &FastLED.addLeds<UCS1903, OUTPIN_CH1, BRG>(leds_ch1, NUMLEDS_CH1),
+    *cont_ch2 = &FastLED.addLeds<UCS1903, OUTPIN_CH2, BRG>(leds_ch2, NUMLEDS_CH2);
+  FastLED_Action engine;
+  Segment seg1(&engine), seg2(&engine);
+  SegmentPart segPart1_ch1(cont_ch1, 0, 10),
+              segPart1_ch2(cont_ch2, 0, 10),
+              segPart2_ch2(cont_ch2, 10, 10);
+  seg1.addSegmentPart(segPart1_ch1);
+  seg1.addSegmentPart(segPart1_ch2);
+  seg2.addSegmentPart(segPart2_ch2);
+  SegmentCompound comp(&engine);
+  comp.addSegment(seg1);
+  comp.addSegment(seg2);
+
+  MemoryPrint sink;
+  FrameRecorder recorder(sink, 4096, 100);
+  engine.setRecorder(&recorder);
+
+  ActionColor actColor(CRGB(0x80, 0x80, 0x80), 0);
+  comp.addAction(actColor);
+  engine.update();
+
+  // compound halves, seg1 halves again
+  comp.setBrightness(128);
+  seg1.setBrightness(128);
+  test(engine.ledControllerHasChanges(cont_ch1), true);
+  engine.update();
+  checkAllSegmentPartColors(segPart1_ch1, 0x808080, __LINE__);
+
+  // fade back up with kept brightness, colors are restored exactly
+  ActionFade actUpComp(100, 10, true), actUpSeg1(100, 10, true);
+  comp.removeAction(actColor);
+  seg1.addAction(actUpSeg1);
+  seg1.loop(); // engine loops comp, not segments in it
+  seg1.yieldUntilAction();
+  seg1.removeAction(actUpSeg1);
+  comp.addAction(actUpComp);
+  comp.yieldUntilAction();
+  test(comp.brightness(), 255);
+  test(seg1.brightness(), 255);
+  engine.update();
+  recorder.flush();
+
+  RecordingReader reader(sink.buf, sink.len);
+  test(reader.nextFrame(), true);
+  test(reader.nextFrame(), true);
+  // controllers registered in order ch1 = 0, ch2 = 1
+  testTypeHint(cRgbToUInt(reader.leds(0)[0]), 0x202020, uint32_t);
+  testTypeHint(cRgbToUInt(reader.leds(1)[0]), 0x202020, uint32_t);
+  testTypeHint(cRgbToUInt(reader.leds(1)[10]), 0x404040, uint32_t);
+  testTypeHint(cRgbToUInt(reader.leds(1)[20]), 0, uint32_t);
+  test(reader.nextFrame(), true);
+  while (reader.nextFrame())
+    ; // last frame of fade
+  testTypeHint(cRgbToUInt(reader.leds(0)[0]), 0x808080, uint32_t);
+  testTypeHint(cRgbToUInt(reader.leds(1)[10]), 0x808080, uint32_t);
+
+  // ActionFade with kept brightness only touches brightness
+  ActionFade actFade(50, 100, true);
+  comp.removeAction(actUpComp);
+  comp.addAction(actFade);
+  comp.yieldUntilAction();
+  engine.update();
+  test(comp.brightness(), 127);
+  checkAllSegmentPartColors(segPart2_ch2, 0x808080, __LINE__);
+  comp.removeAction(actFade);
+
+  // else faded level goes into leds and brightness is restored
+  // 25% is 63 of 127
+  ActionFade actFadeOut(25, 100);
+  comp.addAction(actFadeOut);
+  comp.yieldUntilAction();
+  engine.update();
+  test(comp.brightness(), 127);
+  checkAllSegmentPartColors(segPart2_ch2, 0x3F3F3F, __LINE__);
+  comp.removeAction(actFadeOut);
+
+  // a led set while dimmed is dimmed when sent, only its block is redone
+  MemoryPrint sink2;
+  FrameRecorder recorder2(sink2, 4096, 100);
+  engine.setRecorder(&recorder2);
+  seg2.setBrightness(128);
+  engine.update();
+  seg2.setLed(0, CRGB::White);
+  engine.update();
+  recorder2.flush();
+  uint8_t bright = scale8(scale8(255, comp.brightness()), 128);
+  RecordingReader reader2(sink2.buf, sink2.len);
+  while (reader2.nextFrame())
+    ;
+  testTypeHint(cRgbToUInt(reader2.leds(1)[10]),
+               cRgbToUInt(CRGB(CRGB::White).nscale8(bright)), uint32_t);
+  testTypeHint(cRgbToUInt(reader2.leds(1)[11]),
+               cRgbToUInt(CRGB(0x3F3F3F).nscale8(bright)), uint32_t);
+  testTypeHint(cRgbToUInt(reader2.leds(1)[0]),
+               cRgbToUInt(CRGB(0x3F3F3F).nscale8(comp.brightness())), uint32_t);
+  seg2.setBrightness(255);
+
+  engine.setRecorder(nullptr);
+}
+
+void testPowerLimit(){
+  setAllBlack();
+
+  CLEDController
+    *cont_ch1 = &FastLED.addLeds<UCS1903, OUTPIN_CH1, BRG>(leds_ch1, NUMLEDS_CH1),
+    *cont_ch2 = &FastLED.addLeds<UCS1903, OUTPIN_CH2, BRG>(leds_ch2, NUMLEDS_CH2);
+  FastLED_Action engine;
+  Segment seg1(&engine), seg2(&engine);
+  SegmentPart segPart1_ch1(cont_ch1, 0, 50),
+              segPart2_ch2(cont_ch2, 0, 10);
+  seg1.addSegmentPart(segPart1_ch1);
+  seg2.addSegmentPart(segPart2_ch2);
+
+  ActionColor actWhite(CRGB::White, 0);
+  seg1.addAction(actWhite);
+  engine.update();
+  test(engine.estimatedMilliamps(cont_ch1), 0); // not tracked without limit
+  test(engine.stats().headroom, FastLED_Action::NO_POWER_LIMIT);
+
+  // 50 white leds at 16+11+15 mA and 150 idle leds at 1 mA
+  engine.setPowerLimit(1000);
+  engine.update();
+  test(engine.estimatedMilliamps(cont_ch1), 50 * 42 + 150);
+  test(engine.stats().milliamps, 2250);
+  test(engine.stats().headroom, 1000 - 2250);
+  test(engine.stats().powerScale, (1000 - 150) * 255 / 2100);
+  checkAllSegmentPartColors(segPart1_ch1, 0xFFFFFF, __LINE__); // leds untouched
+
+  // only changed range is summed again
+  *seg1[0] = *seg1[1] = CRGB::Black;
+  engine.setLedControllerHasChanges(cont_ch1, 0, 2);
+  engine.update();
+  test(engine.estimatedMilliamps(cont_ch1), 48 * 42 + 150);
+
+  // supply 1 only feeds ch2
+  engine.setPowerLimit(0);
+  engine.setControllerSupply(cont_ch2, 1);
+  engine.setSupplyLimit(1, 100);
+  ActionColor actRed(CRGB::Red, 0);
+  seg2.addAction(actRed);
+  engine.update();
+  test(engine.estimatedMilliamps(cont_ch2), 10 * 16 + 55);
+  test(engine.stats().headroom, 100 - 215);
+  test(engine.stats().powerScale, (100 - 55) * 255 / 160);
+
+  engine.setSupplyLimit(1, 0);
+  engine.update();
+  test(engine.stats().headroom, FastLED_Action::NO_POWER_LIMIT);
+  test(engine.stats().powerScale, 255);
+
+  seg1.removeAction(actWhite);
+  seg2.removeAction(actRed);
+
+  // sums are dropped without limit, next limit scans all again
+  fill_solid(seg1[0], 50, CRGB::White);
+  seg1.dirty();
+  engine.setPowerLimit(100000);
+  engine.update();
+  test(engine.estimatedMilliamps(cont_ch1), 50 * 42 + 150);
+  engine.setPowerLimit(0);
+  engine.update();
+  test(engine.estimatedMilliamps(cont_ch1), 0);
+  fill_solid(seg1[0], 50, CRGB::Black);
+  seg1.dirty();
+  engine.update();
+  engine.setPowerLimit(100000);
+  engine.update();
+  test(engine.estimatedMilliamps(cont_ch1), 150);
+  engine.setPowerLimit(0);
+  engine.update();
+  fill_solid(seg1[0], 50, CRGB::White);
+  seg1.dirty();
+  engine.update();
+  engine.setPowerLimit(100000);
+  engine.update();
+  test(engine.estimatedMilliamps(cont_ch1), 50 * 42 + 150);
+
+  // estimate is after segment brightness, before correction
+  engine.setPowerLimit(1000);
+  seg1.setBrightness(0);
+  engine.update();
+  test(engine.estimatedMilliamps(cont_ch1), 150);
+  test(engine.stats().powerScale, 255);
+  seg1.setBrightness(128);
+  engine.update();
+  test(engine.estimatedMilliamps(cont_ch1),
+       50 * 42 * scale8(255, 128) / 255 + 150);
+  seg1.setBrightness(255);
+  engine.update();
+  test(engine.estimatedMilliamps(cont_ch1), 50 * 42 + 150);
+  checkAllSegmentPartColors(segPart1_ch1, 0xFFFFFF, __LINE__);
+}
+
+// feeds queued packets to ActionNetworkStream
+class MemoryPacketSource : public PacketSource {
+public:
+  uint8_t packets[4][64];
+  uint16_t sizes[4];
+  uint8_t count, current;
+  uint16_t pos;
+  MemoryPacketSource() : count(0), current(0), pos(0) {}
+  uint16_t nextPacket() {
+    if (current >= count) {
+      count = current = 0;
+      return 0;
+    }
+    pos = 0;
+    return sizes[current++];
+  }
+  uint16_t read(uint8_t *buf, uint16_t len) {
+    uint8_t *pkt = packets[current -1];
+    uint16_t size = sizes[current -1];
+    if (len > size - pos)
+      len = size - pos;
+    memcpy(buf, pkt + pos, len);
+    pos += len;
+    return len;
+  }
+};
+
+// builds a ArtDmx packet with all leds set to vlu
+uint16_t makeArtDmx(uint8_t *pkt, uint16_t universe, uint8_t seq,
+                    uint8_t leds, uint8_t vlu)
+{
+  memcpy(pkt, "Art-Net", 8);
+  pkt[8] = 0x00; pkt[9] = 0x50; // OpDmx
+  pkt[10] = 0; pkt[11] = 14;
+  pkt[12] = seq; pkt[13] = 0;
+  pkt[14] = universe & 0xFF; pkt[15] = universe >> 8;
+  pkt[16] = 0; pkt[17] = leds * 3;
+  memset(&pkt[18], vlu, leds * 3);
+  return 18 + leds * 3;
+}
+
+void testNetworkStream(){
+  setAllBlack();
+
+  CLEDController
+    *cont_ch1 = &FastLED.addLeds<UCS1903, OUTPIN_CH1, BRG>(leds_ch1, NUMLEDS_CH1),
+    *cont_ch2 = &FastLED.addLeds<UCS1903, OUTPIN_CH2, BRG>(leds_ch2, NUMLEDS_CH2);
+  Segment seg1;
+  SegmentPart segPart1_ch1(cont_ch1, 10, 6),
+              segPart1_ch2(cont_ch2, 5, 6);
+  seg1.addSegmentPart(segPart1_ch1);
+  seg1.addSegmentPart(segPart1_ch2);
+
+  // 12 leds in 3 universes of 4 leds, universe 2 spans both controllers
+  MemoryPacketSource source;
+  ActionNetworkStream actStream(source, 1, 4);
+  seg1.addAction(actStream);
+  FastLED_Action::loop(); // start
+  FastLED_Action::loop();
+
+  source.sizes[0] = makeArtDmx(source.packets[0], 1, 1, 4, 0x10);
+  source.sizes[1] = makeArtDmx(source.packets[1], 2, 1, 4, 0x20);
+  source.count = 2;
+  testDelay(2);
+  test(actStream.packets(), 2);
+  test(actStream.frames(), 0); // waits for universe 3
+  testTypeHint(cRgbToUInt(leds_ch1[10]), 0x101010, uint32_t);
+  testTypeHint(cRgbToUInt(leds_ch1[15]), 0x202020, uint32_t);
+  testTypeHint(cRgbToUInt(leds_ch2[5]), 0x202020, uint32_t);
+  testTypeHint(cRgbToUInt(leds_ch2[6]), 0x202020, uint32_t);
+  testTypeHint(cRgbToUInt(leds_ch2[7]), CRGB::Black, uint32_t);
+  testTypeHint(cRgbToUInt(leds_ch1[16]), CRGB::Black, uint32_t);
+
+  source.sizes[0] = makeArtDmx(source.packets[0], 3, 1, 4, 0x30);
+  source.sizes[1] = makeArtDmx(source.packets[1], 1, 1, 4, 0x40); // stale
+  source.sizes[2] = makeArtDmx(source.packets[2], 9, 1, 4, 0x40); // not ours
+  source.count = 3;
+  testDelay(2);
+  test(actStream.frames(), 1);
+  test(actStream.stalePackets(), 1);
+  test(actStream.ignoredPackets(), 1);
+  testTypeHint(cRgbToUInt(leds_ch2[7]), 0x303030, uint32_t);
+  testTypeHint(cRgbToUInt(leds_ch2[10]), 0x303030, uint32_t);
+  testTypeHint(cRgbToUInt(leds_ch2[11]), CRGB::Black, uint32_t);
+
+  // partial frame is committed when sender starts next frame
+  source.sizes[0] = makeArtDmx(source.packets[0], 1, 2, 4, 0x50);
+  source.sizes[1] = makeArtDmx(source.packets[1], 1, 3, 4, 0x60);
+  source.count = 2;
+  testDelay(2);
+  test(actStream.frames(), 2);
+  testTypeHint(cRgbToUInt(leds_ch1[10]), 0x606060, uint32_t);
+
+  // ArtSync commits right away
+  memcpy(source.packets[0], "Art-Net", 8);
+  source.packets[0][8] = 0x00; source.packets[0][9] = 0x52;
+  source.sizes[0] = 18;
+  source.count = 1;
+  testDelay(2);
+  test(actStream.frames(), 3);
+  seg1.removeAction(actStream);
+
+#ifdef FASTLED_ACTION_HOST
+  // real packets over loopback
+  PosixUdpSource udpSource(6454);
+  test(udpSource.isOpen(), true);
+  ActionNetworkStream actUdp(udpSource, 0, 12);
+  seg1.addAction(actUdp);
+  FastLED_Action::loop();
+
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(6454);
+  uint16_t len = makeArtDmx(source.packets[0], 0, 7, 12, 0x70);
+  sendto(fd, source.packets[0], len, 0,
+         reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+  close(fd);
+
+  testDelay(2);
+  test(actUdp.frames(), 1);
+  checkAllSegmentPartColors(segPart1_ch1, 0x707070, __LINE__);
+  checkAllSegmentPartColors(segPart1_ch2, 0x707070, __LINE__);
+  seg1.removeAction(actUdp);
+#endif
+}
+
+void testIndexed(){
+  setAllBlack();
+
+  CLEDController
+    *cont_ch1 = &FastLED.addLeds<UCS1903, OUTPIN_CH1, BRG>(leds_ch1, NUMLEDS_CH1),
+    *cont_ch2 = &FastLED.addLeds<UCS1903, OUTPIN_CH2, BRG>(leds_ch2, NUMLEDS_CH2);
+  FastLED_Action engine;
+  IndexedSegment seg4(4, &engine);
+  SegmentPart segPart1_ch1(cont_ch1, 10, 15);
+  seg4.addSegmentPart(segPart1_ch1);
+  test(seg4.bitsPerLed(), 4);
+
+  const CRGB colors[] = { CRGB::Red, CRGB::Green, CRGB::Blue, CRGB::White };
+  seg4.setPalette(colors, 4);
+  seg4.fillIndex(1);
+  test(seg4.memoryUsage(), 8 + 4 * 3); // 15 leds in 8 bytes
+  test(engine.ledControllerHasChanges(cont_ch1), false); // not until render
+  engine.update();
+  checkAllSegmentPartColors(segPart1_ch1, CRGB::Green, __LINE__);
+  testTypeHint(cRgbToUInt(leds_ch1[9]), CRGB::Black, uint32_t);
+  testTypeHint(cRgbToUInt(leds_ch1[25]), CRGB::Black, uint32_t);
+
+  seg4.setIndex(3, 2);
+  seg4.setIndex(4, 18); // only 4 bits
+  test(seg4.index(3), 2);
+  test(seg4.index(4), 2);
+  test(seg4.index(5), 1);
+  engine.update();
+  testTypeHint(cRgbToUInt(leds_ch1[12]), CRGB::Green, uint32_t);
+  testTypeHint(cRgbToUInt(leds_ch1[13]), CRGB::Blue, uint32_t);
+  testTypeHint(cRgbToUInt(leds_ch1[14]), CRGB::Blue, uint32_t);
+
+  // only changed indices are expanded
+  leds_ch1[20] = CRGB::Black;
+  seg4.setIndex(0, 0);
+  engine.update();
+  testTypeHint(cRgbToUInt(leds_ch1[10]), CRGB::Red, uint32_t);
+  testTypeHint(cRgbToUInt(leds_ch1[20]), CRGB::Black, uint32_t);
+
+  // palette change expands all, indices beyond palette wraps
+  seg4.setIndex(5, 6);
+  seg4.rotatePalette(1); // white, red, green, blue
+  test(cRgbToUInt(seg4.paletteColor(0)), CRGB::White);
+  engine.update();
+  testTypeHint(cRgbToUInt(leds_ch1[10]), CRGB::White, uint32_t);
+  testTypeHint(cRgbToUInt(leds_ch1[13]), CRGB::Green, uint32_t);
+  testTypeHint(cRgbToUInt(leds_ch1[15]), CRGB::Green, uint32_t);
+  testTypeHint(cRgbToUInt(leds_ch1[20]), CRGB::Red, uint32_t);
+  seg4.rotatePalette(-1);
+  engine.update();
+  testTypeHint(cRgbToUInt(leds_ch1[10]), CRGB::Red, uint32_t);
+
+  // 8 bit within a compound, rotated by action
+  IndexedSegment seg8(8, &engine);
+  SegmentPart segPart1_ch2(cont_ch2, 5, 10),
+              segPart2_ch2(cont_ch2, 30, 10);
+  seg8.addSegmentPart(segPart1_ch2);
+  seg8.addSegmentPart(segPart2_ch2);
+  SegmentCompound comp(&engine);
+  comp.addSegment(seg8);
+  CRGBPalette16 palette(CRGB::Black, CRGB::White);
+  seg8.setPalette(palette);
+  for(uint16_t i = 0; i < seg8.size(); ++i)
+    seg8.setIndex(i, i);
+  test(seg8.memoryUsage(), 20 + 16 * 3);
+  engine.update();
+  testTypeHint(cRgbToUInt(leds_ch2[5]), cRgbToUInt(palette[0]), uint32_t);
+  testTypeHint(cRgbToUInt(leds_ch2[31]), cRgbToUInt(palette[11]), uint32_t);
+  testTypeHint(cRgbToUInt(leds_ch2[39]), cRgbToUInt(palette[3]), uint32_t);
+
+  ActionPaletteRotate actRotate(1, 10);
+  comp.addAction(actRotate);
+  uint32_t time = millis();
+  while(millis() - time < 35) {
+    engine.update();
+    testDelay(1);
+  }
+  test(cRgbToUInt(seg8.paletteColor(0)) != cRgbToUInt(palette[0]), true);
+  for(uint16_t i = 0; i < seg8.size(); ++i)
+    testTypeHint(cRgbToUInt(*seg8[i]),
+                 cRgbToUInt(seg8.paletteColor(seg8.index(i) & 0x0F)), uint32_t);
+  comp.removeAction(actRotate);
+}
+
+void testMirror(){
+  setAllBlack();
+
+  CLEDController
+    *cont_ch1 = &FastLED.addLeds<UCS1903, OUTPIN_CH1, BRG>(leds_ch1, NUMLEDS_CH1),
+    *cont_ch2 = &FastLED.addLeds<UCS1903, OUTPIN_CH2, BRG>(leds_ch2, NUMLEDS_CH2),
+    *cont_ch3 = &FastLED.addLeds<UCS1903, OUTPIN_CH3, BRG>(leds_ch3, NUMLEDS_CH3);
+  FastLED_Action engine;
+  Segment source(&engine);
+  SegmentPart srcPart1_ch1(cont_ch1, 10, 6),
+              srcPart2_ch1(cont_ch1, 20, 4);
+  source.addSegmentPart(srcPart1_ch1);
+  source.addSegmentPart(srcPart2_ch1);
+
+  MirrorSegment clone(source, false, 0, &engine),
+                reversed(source, true, 0, &engine),
+                offset(&source, false, 3, &engine);
+  SegmentPart clonePart_ch1(cont_ch1, 40, 10),
+              revPart1_ch2(cont_ch2, 0, 3),
+              revPart2_ch2(cont_ch2, 10, 7),
+              offsetPart_ch3(cont_ch3, 0, 15);
+  clone.addSegmentPart(clonePart_ch1);
+  reversed.addSegmentPart(revPart1_ch2);
+  reversed.addSegmentPart(revPart2_ch2);
+  offset.addSegmentPart(offsetPart_ch3);
+  test(clone.type(), SegmentCommon::T_Mirror);
+  test(clone.isSegment(), true);
+
+  for(uint16_t i = 0; i < source.size(); ++i)
+    *source[i] = CRGB(i + 1, 0, 0);
+  source.dirty();
+  engine.update();
+  for(uint16_t i = 0; i < 10; ++i) {
+    test(clone[i]->r, i + 1);
+    test(reversed[i]->r, 10 - i);
+  }
+  testTypeHint(cRgbToUInt(leds_ch2[3]), CRGB::Black, uint32_t);
+  // longer than source repeats it
+  for(uint16_t i = 0; i < 15; ++i)
+    test(offset[i]->r, (i + 3) % 10 + 1);
+
+  // copies only when source has changed
+  leds_ch1[40] = CRGB::Black;
+  engine.update();
+  testTypeHint(cRgbToUInt(leds_ch1[40]), CRGB::Black, uint32_t);
+  ActionColor actColor(CRGB::Blue, 0);
+  source.addAction(actColor);
+  engine.update();
+  checkAllSegmentPartColors(clonePart_ch1, CRGB::Blue, __LINE__);
+  checkAllSegmentPartColors(revPart2_ch2, CRGB::Blue, __LINE__);
+  checkAllSegmentPartColors(offsetPart_ch3, CRGB::Blue, __LINE__);
+  test(engine.ledControllerHasChanges(cont_ch3), false);
+  source.removeAction(actColor);
+
+  // source offset is the mirrors, reversed parts are the segments
+  for(uint16_t i = 0; i < source.size(); ++i)
+    *source[i] = CRGB(i + 1, 0, 0);
+  source.dirty();
+  offset.setSourceOffset(1);
+  test(offset.sourceOffset(), 1);
+  clone.setReversed(true);
+  engine.update();
+  test(offset[0]->r, 2);
+  test(leds_ch1[49].r, 1);
+  clone.setReversed(false);
+  offset.setSourceOffset(3);
+  for(uint16_t i = 0; i < source.size(); ++i)
+    *source[i] = CRGB::Blue;
+  source.dirty();
+  engine.update();
+
+  // mirror of a compound
+  SegmentCompound comp(&engine);
+  comp.addSegment(source);
+  MirrorSegment compMirror(comp, true, 0, &engine);
+  SegmentPart compPart_ch3(cont_ch3, 100, 10);
+  compMirror.addSegmentPart(compPart_ch3);
+  *source[0] = CRGB::Red;
+  source.dirty();
+  engine.update();
+  testTypeHint(cRgbToUInt(leds_ch3[109]), CRGB::Red, uint32_t);
+  testTypeHint(cRgbToUInt(leds_ch3[108]), CRGB::Blue, uint32_t);
+  testTypeHint(cRgbToUInt(leds_ch1[40]), CRGB::Red, uint32_t);
+  comp.removeSegment(source);
+}
+
+void testLayout(){
+  setAllBlack();
+
+  CLEDController
+    *cont_ch1 = &FastLED.addLeds<UCS1903, OUTPIN_CH1, BRG>(leds_ch1, NUMLEDS_CH1),
+    *cont_ch2 = &FastLED.addLeds<UCS1903, OUTPIN_CH2, BRG>(leds_ch2, NUMLEDS_CH2);
+  FastLED_Action engine;
+  Segment seg(&engine);
+  SegmentPart segPart1_ch1(cont_ch1, 10, 5),
+              segPart2_ch1(cont_ch1, 20, 5),
+              segPart1_ch2(cont_ch2, 0, 6);
+  segPart1_ch1.setReversed(true);
+  segPart2_ch1.setStride(2);
+  segPart1_ch2.setOffset(2);
+  seg.addSegmentPart(segPart1_ch1);
+  seg.addSegmentPart(segPart2_ch1);
+  seg.addSegmentPart(segPart1_ch2);
+  test(segPart2_ch1.span(), 9);
+  test(segPart2_ch1.lastLedIdx(), 29);
+  test(seg.size(), 16);
+
+  // actions see logical order
+  for(uint16_t i = 0; i < seg.size(); ++i)
+    *seg[i] = CRGB(i + 1, 0, 0);
+  test(leds_ch1[14].r, 1);
+  test(leds_ch1[10].r, 5);
+  test(leds_ch1[20].r, 6);
+  test(leds_ch1[22].r, 7);
+  test(leds_ch1[21].r, 0);
+  test(leds_ch1[28].r, 10);
+  test(leds_ch2[2].r, 11);
+  test(leds_ch2[5].r, 14);
+  test(leds_ch2[0].r, 15);
+  test(leds_ch2[1].r, 16);
+  test((uint32_t)segPart1_ch1[0], (uint32_t)&leds_ch1[14]);
+  test((uint32_t)segPart1_ch2[4], (uint32_t)&leds_ch2[0]);
+
+  // bulk paths skips the gaps
+  ActionColor actColor(CRGB::Blue, 0);
+  seg.addAction(actColor);
+  engine.update();
+  for(uint16_t i = 0; i < seg.size(); ++i)
+    testTypeHint(cRgbToUInt(*seg[i]), CRGB::Blue, uint32_t);
+  testTypeHint(cRgbToUInt(leds_ch1[21]), CRGB::Black, uint32_t);
+  testTypeHint(cRgbToUInt(leds_ch1[29]), CRGB::Black, uint32_t);
+  seg.removeAction(actColor);
+
+  // dims only the leds of strided part
+  MemoryPrint sink;
+  FrameRecorder recorder(sink, 4096, 100);
+  engine.setRecorder(&recorder);
+  leds_ch1[21] = CRGB(0x80, 0x80, 0x80);
+  seg.setBrightness(128);
+  engine.update();
+  recorder.flush();
+  RecordingReader reader(sink.buf, sink.len);
+  test(reader.nextFrame(), true);
+  testTypeHint(cRgbToUInt(reader.leds(0)[22]), 0x000080, uint32_t);
+  testTypeHint(cRgbToUInt(reader.leds(0)[21]), 0x808080, uint32_t);
+  testTypeHint(cRgbToUInt(reader.leds(0)[12]), 0x000080, uint32_t);
+  engine.setRecorder(nullptr);
+  seg.setBrightness(255);
+
+  // segment transforms after part transforms
+  seg.setReversed(true);
+  test((uint32_t)seg[0], (uint32_t)&leds_ch2[1]);
+  test((uint32_t)seg[15], (uint32_t)&leds_ch1[14]);
+  test((uint32_t)seg[6], (uint32_t)&leds_ch1[28]);
+  seg.setReversed(false);
+  seg.setOffset(3);
+  test((uint32_t)seg[0], (uint32_t)&leds_ch1[11]);
+  test((uint32_t)seg[1], (uint32_t)&leds_ch1[10]);
+  test((uint32_t)seg[2], (uint32_t)&leds_ch1[20]);
+  test((uint32_t)seg[15], (uint32_t)&leds_ch1[12]);
+  test(seg.size(), 16);
+  test((uint32_t)seg[16], (uint32_t)nullptr);
+  seg.setWrap(true);
+  test((uint32_t)seg[16], (uint32_t)seg[0]);
+  test((uint32_t)seg[35], (uint32_t)seg[3]);
+
+  // layout recompiles when parts change
+  seg.removeSegmentPart(2);
+  test(seg.size(), 10);
+  test((uint32_t)seg[0], (uint32_t)&leds_ch1[11]);
+  segPart1_ch1.setReversed(false);
+  test((uint32_t)seg[0], (uint32_t)&leds_ch1[13]);
+
+  // changes in one instance doesn't recompile segments of another
+  FastLED_Action other;
+  uint32_t generation = other.layoutGeneration();
+  segPart1_ch1.setReversed(true);
+  seg.setOffset(0);
+  test(other.layoutGeneration(), generation);
+  test(engine.layoutGeneration() != generation, true);
+}
+
+struct LineRuns {
+  uint8_t count;
+  uint16_t starts[4];
+  int16_t strides[4];
+  uint16_t sizes[4];
+};
+
+void collectRun(const LedRun &run, uint16_t logicalIdx, void *ctx){
+  LineRuns *runs = static_cast<LineRuns*>(ctx);
+  if (runs->count < 4) {
+    runs->starts[runs->count] = logicalIdx;
+    runs->strides[runs->count] = run.stride;
+    runs->sizes[runs->count] = run.size;
+  }
+  ++runs->count;
+}
+
+void testMatrix(){
+  setAllBlack();
+
+  CLEDController
+    *cont_ch1 = &FastLED.addLeds<UCS1903, OUTPIN_CH1, BRG>(leds_ch1, NUMLEDS_CH1),
+    *cont_ch2 = &FastLED.addLeds<UCS1903, OUTPIN_CH2, BRG>(leds_ch2, NUMLEDS_CH2);
+  FastLED_Action engine;
+  MatrixSegment matrix(4, 3, MatrixSegment::Serpentine, &engine);
+  SegmentPart segPart_ch1(cont_ch1, 0, 12);
+  matrix.addSegmentPart(segPart_ch1);
+  test(matrix.type(), SegmentCommon::T_Matrix);
+  test(matrix.width(), 4);
+  test(matrix.height(), 3);
+  test(matrix.memoryUsage(), 24);
+
+  // every other row goes back
+  test((uint32_t)matrix.xy(0, 0), (uint32_t)&leds_ch1[0]);
+  test((uint32_t)matrix.xy(3, 0), (uint32_t)&leds_ch1[3]);
+  test((uint32_t)matrix.xy(0, 1), (uint32_t)&leds_ch1[7]);
+  test((uint32_t)matrix.xy(3, 1), (uint32_t)&leds_ch1[4]);
+  test((uint32_t)matrix.xy(1, 2), (uint32_t)&leds_ch1[9]);
+  test((uint32_t)matrix.xy(4, 0), (uint32_t)nullptr);
+  test((uint32_t)matrix.xy(0, 3), (uint32_t)nullptr);
+
+  // a backwards row is one run
+  LineRuns runs = {};
+  test(matrix.forEachRow(1, collectRun, &runs), 4);
+  test(runs.count, 1);
+  test(runs.strides[0], -1);
+  test(runs.sizes[0], 4);
+  runs = LineRuns();
+  test(matrix.forEachColumn(0, collectRun, &runs), 3);
+  test(runs.count, 2);
+  test(runs.strides[0], 7);
+  test(runs.starts[1], 2);
+
+  matrix.setWiring(MatrixSegment::Progressive);
+  test((uint32_t)matrix.xy(0, 1), (uint32_t)&leds_ch1[4]);
+  runs = LineRuns();
+  matrix.forEachColumn(1, collectRun, &runs);
+  test(runs.count, 1);
+  test(runs.strides[0], 4);
+  test(runs.sizes[0], 3);
+
+  // rotated a quarter turn clockwise
+  matrix.setRotation(1);
+  test(matrix.width(), 3);
+  test(matrix.height(), 4);
+  test((uint32_t)matrix.xy(2, 0), (uint32_t)&leds_ch1[0]);
+  test((uint32_t)matrix.xy(0, 0), (uint32_t)&leds_ch1[8]);
+  test((uint32_t)matrix.xy(0, 3), (uint32_t)&leds_ch1[11]);
+  matrix.setRotation(2);
+  test((uint32_t)matrix.xy(0, 0), (uint32_t)&leds_ch1[11]);
+  matrix.setRotation(0);
+
+  // panels on different controllers
+  MatrixSegment panels(4, 2, MatrixSegment::Progressive, &engine);
+  SegmentPart panel1(cont_ch1, 20, 4),
+              panel2(cont_ch2, 0, 4);
+  panels.addSegmentPart(panel1);
+  panels.addSegmentPart(panel2);
+  test(panels.setPanels(2, 1), true);
+  // more panels than leds, or panels not dividing size is rejected
+  test(panels.setPanels(5, 1), false);
+  test(panels.setPanels(1, 3), false);
+  test((uint32_t)panels.xy(1, 0), (uint32_t)&leds_ch1[21]);
+  test((uint32_t)panels.xy(0, 1), (uint32_t)&leds_ch1[22]);
+  test((uint32_t)panels.xy(2, 0), (uint32_t)&leds_ch2[0]);
+  test((uint32_t)panels.xy(3, 1), (uint32_t)&leds_ch2[3]);
+  runs = LineRuns();
+  panels.forEachRow(0, collectRun, &runs);
+  test(runs.count, 2);
+  test(runs.starts[1], 2);
+  test(runs.sizes[1], 2);
+
+  // table follows layout changes
+  panel2.setReversed(true);
+  test((uint32_t)panels.xy(2, 0), (uint32_t)&leds_ch2[3]);
+}
+
+// convolve with clamped ends and exact division
+void refConvolve(const CRGB *in, uint16_t n, const int8_t *taps,
+                 uint8_t count, uint16_t divisor, CRGB *out){
+  for(int16_t i = 0; i < n; ++i) {
+    for(uint8_t ch = 0; ch < 3; ++ch) {
+      int32_t sum = divisor / 2;
+      for(int16_t t = 0; t < count; ++t) {
+        int16_t j = i + t - count / 2;
+        j = j < 0 ? 0 : (j >= n ? n -1 : j);
+        sum += taps[t] * in[j].raw[ch];
+      }
+      sum = sum <= 0 ? 0 : sum / divisor;
+      out[i].raw[ch] = sum > 255 ? 255 : sum;
+    }
+  }
+}
+
+void fillNoise(SegmentCommon &seg, CRGB *copy){
+  uint16_t seed = 1234;
+  for(uint16_t i = 0; i < seg.size(); ++i) {
+    for(uint8_t ch = 0; ch < 3; ++ch) {
+      seed = seed * 25173 + 13849;
+      (*seg[i]).raw[ch] = seed >> 8;
+    }
+    copy[i] = *seg[i];
+  }
+}
+
+bool matchesRef(SegmentCommon &seg, const CRGB *in, const int8_t *taps,
+                uint8_t count, uint16_t divisor){
+  CRGB out[100];
+  refConvolve(in, seg.size(), taps, count, divisor, out);
+  for(uint16_t i = 0; i < seg.size(); ++i) {
+    if (cRgbToUInt(*seg[i]) != cRgbToUInt(out[i]))
+      return false;
+  }
+  return true;
+}
+
+void testFilters(){
+  setAllBlack();
+
+  CLEDController
+    *cont_ch1 = &FastLED.addLeds<UCS1903, OUTPIN_CH1, BRG>(leds_ch1, NUMLEDS_CH1),
+    *cont_ch2 = &FastLED.addLeds<UCS1903, OUTPIN_CH2, BRG>(leds_ch2, NUMLEDS_CH2),
+    *cont_ch3 = &FastLED.addLeds<UCS1903, OUTPIN_CH3, BRG>(leds_ch3, NUMLEDS_CH3);
+  FastLED_Action engine;
+
+  // blur crosses parts and controllers
+  Segment seg(&engine);
+  SegmentPart segPart_ch1(cont_ch1, 0, 20),
+              segPart_ch2(cont_ch2, 0, 20);
+  segPart_ch2.setReversed(true);
+  seg.addSegmentPart(segPart_ch1);
+  seg.addSegmentPart(segPart_ch2);
+  leds_ch1[19] = CRGB(200, 0, 0);
+  FilterBlur blur(1);
+  blur.apply(&seg);
+  test(leds_ch1[18].r, 50);
+  test(leds_ch1[19].r, 100);
+  test(leds_ch2[19].r, 50);
+  test(leds_ch2[18].r, 0);
+  test(engine.ledControllerHasChanges(cont_ch2, 19, 1), true);
+
+  // same result on a contiguous and a split segment
+  Segment line(&engine);
+  SegmentPart segPart_ch3(cont_ch3, 0, 100);
+  line.addSegmentPart(segPart_ch3);
+  CRGB in[100];
+  const int8_t gauss2[] = { 1, 4, 6, 4, 1 },
+               box2[] = { 1, 1, 1, 1, 1 },
+               gauss4[] = { 1, 8, 28, 56, 70, 56, 28, 8, 1 },
+               sharpen[] = { -1, 3, -1 },
+               strong[] = { -20, 50, -20 };
+  fillNoise(line, in);
+  FilterBlur(2).apply(&line);
+  test(matchesRef(line, in, gauss2, 5, 16), true);
+  fillNoise(line, in);
+  FilterBlur(2, FilterBlur::Box).apply(&line);
+  test(matchesRef(line, in, box2, 5, 5), true);
+  fillNoise(line, in);
+  FilterBlur(9).apply(&line);
+  test(matchesRef(line, in, gauss4, 9, 256), true);
+  fillNoise(line, in);
+  FilterConvolve(sharpen, 3).apply(&line);
+  test(matchesRef(line, in, sharpen, 3, 1), true);
+  fillNoise(line, in);
+  FilterConvolve(strong, 3, 10).apply(&line);
+  test(matchesRef(line, in, strong, 3, 10), true);
+  fillNoise(seg, in);
+  FilterBlur(2, FilterBlur::Box).apply(&seg);
+  test(matchesRef(seg, in, box2, 5, 5), true);
+  test(FilterLine::memoryUsage(engine), 300);
+  FastLED_Action other;
+  test(FilterLine::memoryUsage(other), 0);
+
+  // shift and rotate
+  for(uint16_t i = 0; i < seg.size(); ++i)
+    *seg[i] = CRGB(i, 0, 0);
+  FilterShift shift(3);
+  shift.apply(&seg);
+  test((*seg[3]).r, 0);
+  test((*seg[0]).r, 37);
+  test((*seg[21]).r, 18);
+  test(leds_ch2[16].r, 20);
+  shift.setSteps(-5);
+  shift.setRotate(false);
+  shift.setFill(CRGB::Blue);
+  shift.apply(&seg);
+  test((*seg[0]).r, 2);
+  test((*seg[34]).r, 36);
+  testTypeHint(cRgbToUInt(*seg[35]), CRGB::Blue, uint32_t);
+  testTypeHint(cRgbToUInt(*seg[39]), CRGB::Blue, uint32_t);
+
+  // as post process, once each update
+  for(uint16_t i = 0; i < seg.size(); ++i)
+    *seg[i] = CRGB(i, 0, 0);
+  FilterShift step(1);
+  test(engine.addPostProcess(filterPostProcess<FilterShift>, &seg, &step), true);
+  engine.update();
+  test((*seg[1]).r, 0);
+  engine.update();
+  test((*seg[2]).r, 0);
+  engine.removePostProcess(&seg, &step);
+  engine.update();
+  test((*seg[2]).r, 0);
+
+  // as action
+  ActionFilter<FilterShift> actShift(FilterShift(1), 10);
+  seg.addAction(actShift);
+  uint32_t time = millis();
+  while(millis() - time < 35) {
+    engine.update();
+    testDelay(1);
+  }
+  test((*seg[2]).r != 0, true);
+  seg.removeAction(actShift);
+}
+
+void testParticles(){
+  setAllBlack();
+
+  CLEDController
+    *cont_ch1 = &FastLED.addLeds<UCS1903, OUTPIN_CH1, BRG>(leds_ch1, NUMLEDS_CH1),
+    *cont_ch2 = &FastLED.addLeds<UCS1903, OUTPIN_CH2, BRG>(leds_ch2, NUMLEDS_CH2);
+  FastLED_Action engine;
+  Segment seg(&engine);
+  SegmentPart segPart_ch1(cont_ch1, 0, 40),
+              segPart_ch2(cont_ch2, 0, 40);
+  segPart_ch2.setReversed(true);
+  seg.addSegmentPart(segPart_ch1);
+  seg.addSegmentPart(segPart_ch2);
+
+  ActionParticles particles(3);
+  test(particles.capacity(), 3);
+  test(particles.emit(5 * 256 + 128, 0, CRGB(200, 0, 0), 1000), true);
+  test(particles.count(), 1);
+
+  // antialiased over 2 leds
+  leds_ch1[30] = CRGB::Green;
+  particles.step(&seg, 10);
+  test(leds_ch1[5].r, 100);
+  test(leds_ch1[6].r, 100);
+  test(leds_ch1[4].r, 0);
+  test(particles.life(0), 990);
+
+  // moves 10 leds/s and clears where it was, leds far away are untouched
+  particles.clear();
+  particles.emit(38 * 256, 10 * 256, CRGB(0, 0, 200), 1000);
+  particles.step(&seg, 100);
+  test(particles.position(0), 39 * 256);
+  test(leds_ch1[5].r, 0);
+  test(leds_ch1[39].b, 200);
+  testTypeHint(cRgbToUInt(leds_ch1[30]), CRGB::Green, uint32_t);
+  particles.step(&seg, 100);
+  test(leds_ch1[39].b, 0);
+  test(leds_ch2[39].b, 200);
+  test(engine.ledControllerHasChanges(cont_ch2, 39, 1), true);
+
+  // trails fade by decay
+  particles.setTrail(128);
+  particles.step(&seg, 100);
+  test(leds_ch2[39].b, 100);
+  test(leds_ch2[38].b, 200);
+  particles.clear();
+  for(uint8_t i = 0; i < 10; ++i)
+    particles.step(&seg, 10);
+  test(leds_ch2[38].b, 0);
+  testTypeHint(cRgbToUInt(leds_ch1[30]), CRGB::Green, uint32_t);
+
+  // dies when life is up or outside, pool stays packed
+  particles.setTrail(0);
+  particles.emit(0, -256, CRGB::Red, 1000);
+  particles.emit(10 * 256, 0, CRGB::Red, 50);
+  particles.emit(20 * 256, 0, CRGB::Red, 1000);
+  test(particles.emit(30 * 256, 0, CRGB::Red, 1000), false);
+  particles.step(&seg, 100);
+  test(particles.count(), 1);
+  test(particles.position(0), 20 * 256);
+
+  // gravity and fade out
+  particles.clear();
+  particles.setAcceleration(-2 * 256);
+  particles.setFadeTime(1000);
+  particles.emit(20 * 256, 0, CRGB(200, 200, 200), 1000);
+  particles.step(&seg, 500);
+  test(particles.velocity(0), -256);
+  test(particles.position(0), 20 * 256 - 128);
+  particles.clear();
+  particles.setAcceleration(0);
+  particles.emit(20 * 256, 0, CRGB(200, 200, 200), 600);
+  particles.step(&seg, 100);
+  test(leds_ch1[20].r, 100);
+
+  // driven as an action
+  particles.clear();
+  particles.setFadeTime(0);
+  particles.emit(50 * 256, 0, CRGB::Blue, 10000);
+  seg.addAction(particles);
+  uint32_t time = millis();
+  while(millis() - time < 50) {
+    engine.update();
+    testDelay(1);
+  }
+  testTypeHint(cRgbToUInt(*seg[50]), CRGB::Blue, uint32_t);
+  seg.removeAction(particles);
+}
+
+bool noiseMatches(ActionNoise &noise, SegmentCommon &seg, uint32_t time){
+  for(uint16_t i = 0; i < seg.size(); ++i) {
+    CRGB expect = ColorFromPalette(noise.palette(), noise.sample(i, 0, time), 255);
+    if (cRgbToUInt(*seg[i]) != cRgbToUInt(expect))
+      return false;
+  }
+  return true;
+}
+
+void testNoise(){
+  setAllBlack();
+
+  CLEDController
+    *cont_ch1 = &FastLED.addLeds<UCS1903, OUTPIN_CH1, BRG>(leds_ch1, NUMLEDS_CH1),
+    *cont_ch2 = &FastLED.addLeds<UCS1903, OUTPIN_CH2, BRG>(leds_ch2, NUMLEDS_CH2);
+  FastLED_Action engine;
+  Segment seg(&engine);
+  SegmentPart segPart_ch1(cont_ch1, 0, 50),
+              segPart_ch2(cont_ch2, 0, 50);
+  segPart_ch2.setReversed(true);
+  seg.addSegmentPart(segPart_ch1);
+  seg.addSegmentPart(segPart_ch2);
+
+  CRGBPalette16 palette;
+  for(uint8_t i = 0; i < 16; ++i)
+    palette[i] = CRGB(i * 16, 255 - i * 16, i);
+  ActionNoise noise(palette, 4, 64, 3);
+  test(noise.octaves(), 3);
+
+  // coherent, neighbours are close but it varies
+  uint8_t maxStep = 0, minVlu = 255, maxVlu = 0;
+  noise.setOctaves(1);
+  for(uint16_t x = 0; x < 200; ++x) {
+    uint8_t a = noise.sample(x, 0, 100), b = noise.sample(x +1, 0, 100);
+    uint8_t step = a > b ? a - b : b - a;
+    maxStep = step > maxStep ? step : maxStep;
+    minVlu = a < minVlu ? a : minVlu;
+    maxVlu = a > maxVlu ? a : maxVlu;
+  }
+  test(maxStep <= 25, true);
+  test(maxVlu - minVlu > 64, true);
+  test(noise.sample(10, 0, 100) != noise.sample(10, 0, 356), true);
+
+  // incremental render gives same as sampled, across controllers
+  noise.setOctaves(3);
+  noise.render(&seg, 0);
+  test(noiseMatches(noise, seg, 0), true);
+  test(noise.cacheRefreshes(), 1);
+  test(noise.memoryUsage(), 100);
+  test(engine.ledControllerHasChanges(cont_ch2, 0, 50), true);
+  noise.render(&seg, 5);
+  test(noise.cacheRefreshes(), 1);
+  test(noiseMatches(noise, seg, 5), true);
+  noise.render(&seg, 40);
+  test(noise.cacheRefreshes(), 2);
+  test(noiseMatches(noise, seg, 40), true);
+  noise.setCachedOctaves(0);
+  noise.render(&seg, 41);
+  test(noiseMatches(noise, seg, 41), true);
+  noise.setCachedOctaves(2);
+  noise.setScale(2);
+  noise.render(&seg, 1000);
+  test(noiseMatches(noise, seg, 1000), true);
+
+  // x and y on a matrix
+  MatrixSegment matrix(8, 4, MatrixSegment::Serpentine, &engine);
+  SegmentPart matrixPart(cont_ch1, 60, 32);
+  matrix.addSegmentPart(matrixPart);
+  noise.render(&matrix, 300);
+  bool same = true;
+  for(uint8_t y = 0; y < 4; ++y) {
+    for(uint8_t x = 0; x < 8; ++x) {
+      CRGB expect = ColorFromPalette(palette, noise.sample(x, y, 300), 255);
+      same = same && cRgbToUInt(*matrix.xy(x, y)) == cRgbToUInt(expect);
+    }
+  }
+  test(same, true);
+  test(noise.sample(3, 0, 300) != noise.sample(3, 3, 300), true);
+
+  // animates as action
+  noise.setBrightness(255);
+  seg.addAction(noise);
+  CRGB before = *seg[10];
+  uint32_t time = millis();
+  while(millis() - time < 600) {
+    engine.update();
+    testDelay(1);
+  }
+  test(cRgbToUInt(*seg[10]) != cRgbToUInt(before), true);
+  seg.removeAction(noise);
+}
+
+// sine bursts of length samples each period, silence between
+class ToneSource : public SampleSource {
+public:
+  uint32_t rate, freq, period, length, pos;
+  int16_t amplitude;
+  ToneSource(uint32_t rate, uint32_t freq, uint32_t period, uint32_t length,
+             int16_t amplitude) :
+    rate(rate), freq(freq), period(period), length(length), pos(0),
+    amplitude(amplitude)
+  {}
+  uint16_t read(int16_t *samples, uint16_t count) {
+    for(uint16_t i = 0; i < count; ++i, ++pos)
+      samples[i] = (pos % period) < length ?
+                     amplitude * sinf(6.2831853f * freq * pos / rate) : 0;
+    return count;
+  }
+};
+
+// loudest band, 0xFF if none at 255
+uint8_t loudestBand(AudioAnalyzer &analyzer){
+  for(uint8_t b = 0; b < analyzer.bandCount(); ++b)
+    if (analyzer.band(b) == 255)
+      return b;
+  return 0xFF;
+}
+
+bool bandHasFrequency(AudioAnalyzer &analyzer, uint8_t band, uint32_t freq){
+  return analyzer.bandFrequency(band) <= freq &&
+         freq < analyzer.bandFrequency(band +1);
+}
+
+void onAudioValue(SegmentCommon *owner, uint8_t value, void *ctx){
+  (void)owner;
+  *static_cast<int16_t*>(ctx) = value;
+}
+
+void testAudio(){
+  setAllBlack();
+
+  static int16_t samples[1024];
+  ToneSource tone(8000, 1000, 1024, 1024, 16000);
+  tone.read(samples, 1024);
+
+  // log spaced bands up to half sample rate
+  MemorySampleSource mem(samples, 1024);
+  AudioAnalyzer analyzer(mem, 8000, 7, 8);
+  test(analyzer.fftSize(), 128);
+  test(analyzer.bandFrequency(0), 62);
+  test(analyzer.bandFrequency(8), 4000);
+  test(analyzer.memoryUsage(), 128 * 12);
+
+  // budget bounds blocks each update, nothing lost when not realtime
+  analyzer.setRealtime(false);
+  test(analyzer.update(2), 2);
+  test(analyzer.blockCount(), 2);
+  uint8_t blocks;
+  while((blocks = analyzer.update(4)) > 0)
+    test(blocks <= 4, true);
+  test(analyzer.blockCount(), 15);
+  test(analyzer.droppedBlocks(), 0);
+  uint8_t loud = loudestBand(analyzer);
+  test(loud < 8 && bandHasFrequency(analyzer, loud, 1000), true);
+  test(analyzer.band(0) < 64, true);
+  test(analyzer.beatCount(), 0);
+
+  // realtime skips to latest
+  MemorySampleSource mem2(samples, 1024);
+  AudioAnalyzer realtime(mem2, 8000, 7, 8);
+  test(realtime.update(1), 1);
+  test(realtime.blockCount(), 1);
+  test(realtime.droppedBlocks(), 14);
+  test(realtime.update(1), 0);
+
+  // a low tone moves the peak down
+  ToneSource low(8000, 200, 8000, 8000, 16000);
+  AudioAnalyzer lowAnalyzer(low, 8000, 7, 8);
+  lowAnalyzer.setRealtime(false);
+  for(uint8_t i = 0; i < 10; ++i)
+    lowAnalyzer.update(1);
+  loud = loudestBand(lowAnalyzer);
+  test(loud < 8 && bandHasFrequency(lowAnalyzer, loud, 200), true);
+
+  // one beat for each bass burst
+  ToneSource bursts(4000, 100, 1000, 200, 20000);
+  AudioAnalyzer beats(bursts, 4000, 6, 8);
+  beats.setRealtime(false);
+  bool pulse = true;
+  for(uint16_t i = 0; i < 240; ++i) { // 2s, ends before 9th burst
+    beats.update(1);
+    if (beats.beat())
+      pulse = pulse && beats.beatPulse() == 255;
+  }
+  test(beats.beatCount(), 8);
+  test(pulse, true);
+
+#ifdef FASTLED_ACTION_HOST
+  // stereo WAV file, then same file through a pipe
+  const char *path = "/tmp/fastled_action_test.wav";
+  FILE *file = fopen(path, "wb");
+  test(file != nullptr, true);
+  if (file) {
+    const uint8_t header[44] = {
+      'R','I','F','F', 0x24, 0x10, 0, 0, 'W','A','V','E',
+      'f','m','t',' ', 16, 0, 0, 0, 1, 0, 2, 0,
+      0x40, 0x1F, 0, 0, 0x00, 0x7D, 0, 0, 4, 0, 16, 0,
+      'd','a','t','a', 0, 16, 0, 0
+    };
+    fwrite(header, 1, sizeof(header), file);
+    for(uint16_t i = 0; i < 1024; ++i) {
+      uint8_t frame[4] = {
+        (uint8_t)(samples[i] & 0xFF), (uint8_t)(samples[i] >> 8),
+        (uint8_t)(samples[i] & 0xFF), (uint8_t)(samples[i] >> 8)
+      };
+      fwrite(frame, 1, 4, file);
+    }
+    fclose(file);
+  }
+  {
+    WavSampleSource wav(path);
+    test(wav.isOpen(), true);
+    test(wav.sampleRate(), 8000);
+    test(wav.channels(), 2);
+    int16_t first[4];
+    test(wav.read(first, 4), 4);
+    test(first[1], samples[1]);
+    test(first[3], samples[3]);
+  }
+  FILE *pipe = popen("cat /tmp/fastled_action_test.wav", "r");
+  test(pipe != nullptr, true);
+  if (pipe) {
+    WavSampleSource wav(pipe);
+    test(wav.sampleRate(), 8000);
+    AudioAnalyzer piped(wav, wav.sampleRate(), 7, 8);
+    piped.setRealtime(false);
+    while(piped.update(4) > 0)
+      ;
+    test(piped.blockCount(), 15);
+    loud = loudestBand(piped);
+    test(loud < 8 && bandHasFrequency(piped, loud, 1000), true);
+    pclose(pipe);
+  }
+  WavSampleSource missing("/tmp/fastled_action_missing.wav");
+  test(missing.isOpen(), false);
+  remove(path);
+#endif
+
+  // action binds brightness, or anything through a callback
+  CLEDController
+    *cont_ch1 = &FastLED.addLeds<UCS1903, OUTPIN_CH1, BRG>(leds_ch1, NUMLEDS_CH1);
+  FastLED_Action engine;
+  Segment seg(&engine);
+  SegmentPart segPart_ch1(cont_ch1, 0, 20);
+  seg.addSegmentPart(segPart_ch1);
+  MemorySampleSource looped(samples, 1024, true);
+  AudioAnalyzer live(looped, 8000, 7, 8);
+  ActionAudio actAudio(live, ActionAudio::Band, loudestBand(analyzer));
+  actAudio.setRange(10, 200);
+  seg.addAction(actAudio);
+  uint32_t time = millis();
+  while(millis() - time < 100) {
+    engine.update();
+    testDelay(1);
+  }
+  test(live.blockCount() > 0, true);
+  test(actAudio.value(), 200);
+  test(seg.brightness(), 200);
+
+  int16_t bound = -1;
+  actAudio.bind(onAudioValue, &bound);
+  actAudio.setRange(0, 100);
+  time = millis();
+  while(millis() - time < 50) {
+    engine.update();
+    testDelay(1);
+  }
+  test(bound, 100);
+  test(seg.brightness(), 200);
+  seg.removeAction(actAudio);
+}
+
+// blocks of 16 leds marked changed in controller
+uint8_t changedBlocks(FastLED_Action &engine, CLEDController *controller){
+  uint8_t cnt = 0;
+  for(uint16_t first = 0; first < controller->size(); first += 16)
+    cnt += engine.ledControllerHasChanges(controller, first, 16);
+  return cnt;
+}
+
+void testTwinkle(){
+  setAllBlack();
+
+  CLEDController
+    *cont_ch1 = &FastLED.addLeds<UCS1903, OUTPIN_CH1, BRG>(leds_ch1, NUMLEDS_CH1),
+    *cont_ch3 = &FastLED.addLeds<UCS1903, OUTPIN_CH3, BRG>(leds_ch3, NUMLEDS_CH3);
+  FastLED_Action engine;
+  Segment seg(&engine);
+  SegmentPart segPart_ch3(cont_ch3, 0, 200);
+  seg.addSegmentPart(segPart_ch3);
+  engine.setPowerLimit(100000);
+
+  // setLed marks only that leds block
+  engine.update();
+  seg.setLed(40, CRGB(1, 2, 3));
+  test(cRgbToUInt(leds_ch3[40]), 0x010203);
+  test(engine.ledControllerHasChanges(cont_ch3, 32, 16), true);
+  test(engine.ledControllerHasChanges(cont_ch3, 0, 32), false);
+  test(engine.ledControllerHasChanges(cont_ch3, 48, 152), false);
+  seg.setLed(199, CRGB(1, 2, 3));
+  test(changedBlocks(engine, cont_ch3), 2);
+  engine.update();
+  test(engine.stats().dirtyBlocks, 2);
+  test(changedBlocks(engine, cont_ch3), 0);
+
+  // through a compound, in same order as operator []
+  Segment seg1(&engine), seg2(&engine);
+  SegmentPart segPart1(cont_ch1, 0, 10),
+              segPart2(cont_ch1, 100, 10);
+  seg1.addSegmentPart(segPart1);
+  seg2.addSegmentPart(segPart2);
+  SegmentCompound comp(&engine);
+  comp.addSegment(seg1);
+  comp.addSegment(seg2);
+  comp.setLed(12, CRGB(4, 5, 6));
+  test(cRgbToUInt(leds_ch1[102]), 0x040506);
+  test(changedBlocks(engine, cont_ch1), 1);
+  test(engine.ledControllerHasChanges(cont_ch1, 96, 16), true);
+  engine.update();
+
+  // only twinkling leds are written and sent
+  ActionTwinkle twinkle(CRGB(0, 0, 255), 2, 400);
+  twinkle.setBackground(CRGB(1, 1, 1));
+  test(twinkle.rate(), 5);
+  test(twinkle.memoryUsage(), 2 * 7);
+  seg.addAction(twinkle);
+  engine.update();
+  test(cRgbToUInt(leds_ch3[150]), 0x010101);
+  test(engine.stats().dirtyBlocks, 13);
+  twinkle.setRate(10);
+  twinkle.step(&seg, 100);
+  test(twinkle.active(), 1);
+  uint16_t first = twinkle.activeIdx(0);
+  test(cRgbToUInt(leds_ch3[first]), 0x010101);
+  test(changedBlocks(engine, cont_ch3), 1);
+  test(engine.ledControllerHasChanges(cont_ch3, first & ~15, 16), true);
+
+  twinkle.step(&seg, 200); // peak
+  test(leds_ch3[first].b >= 250, true);
+  test(twinkle.active(), 2);
+  test(changedBlocks(engine, cont_ch3) <= 2, true);
+  twinkle.step(&seg, 200); // first done
+  test(cRgbToUInt(leds_ch3[first]), 0x010101);
+  test(twinkle.active() <= 2, true);
+
+  // sparse power sums same as a full scan
+  engine.update();
+  uint32_t sparseMa = engine.estimatedMilliamps(cont_ch3);
+  FastLED_Action full;
+  full.setPowerLimit(100000);
+  full.setLedControllerHasChanges(cont_ch3);
+  full.update();
+  test(sparseMa, full.estimatedMilliamps(cont_ch3));
+  seg.removeAction(twinkle);
+
+  // sparkles lasts one tick
+  ActionSparkle sparkle(CRGB::White, 1000, 8);
+  sparkle.step(&seg, 5);
+  uint8_t lit = sparkle.active();
+  test(lit > 0 && lit <= 5, true);
+  uint16_t spark = sparkle.activeIdx(0);
+  test(cRgbToUInt(leds_ch3[spark]), 0xFFFFFF);
+  sparkle.step(&seg, 5);
+  bool again = false;
+  for(uint8_t i = 0; i < sparkle.active(); ++i)
+    again = again || sparkle.activeIdx(i) == spark;
+  test(again || cRgbToUInt(leds_ch3[spark]) == 0, true);
+  test(sparkle.active() <= 5, true);
+
+  // as a action over time, one each tick or so
+  sparkle.setRate(60);
+  seg.addAction(sparkle);
+  uint32_t time = millis();
+  uint32_t maxBlocks = 0;
+  while(millis() - time < 60) { // start fills all
+    engine.update();
+    testDelay(1);
+  }
+  while(millis() - time < 260) {
+    engine.update();
+    if (engine.stats().dirtyBlocks > maxBlocks)
+      maxBlocks = engine.stats().dirtyBlocks;
+    testDelay(1);
+  }
+  test(maxBlocks > 0 && maxBlocks <= 6, true);
+  seg.removeAction(sparkle);
+}
+
+// all leds in seg mixes red and blue
+bool segMixed(Segment &seg){
+  bool mixed = true;
+  for(uint16_t i = 0; i < seg.size(); ++i)
+    mixed = mixed && seg[i]->r > 0 && seg[i]->b > 0;
+  return mixed;
+}
+
+bool segIs(Segment &seg, uint32_t color){
+  bool same = true;
+  for(uint16_t i = 0; i < seg.size(); ++i)
+    same = same && cRgbToUInt(*seg[i]) == color;
+  return same;
+}
+
+void testTransition(){
+  setAllBlack();
+
+  CLEDController
+    *cont_ch1 = &FastLED.addLeds<UCS1903, OUTPIN_CH1, BRG>(leds_ch1, NUMLEDS_CH1),
+    *cont_ch2 = &FastLED.addLeds<UCS1903, OUTPIN_CH2, BRG>(leds_ch2, NUMLEDS_CH2);
+  FastLED_Action engine;
+  Segment seg(&engine);
+  SegmentPart segPart_ch1(cont_ch1, 0, 10),
+              segPart_ch2(cont_ch2, 0, 10),
+              segPart_strided(cont_ch1, 20, 5);
+  segPart_ch2.setReversed(true);
+  segPart_strided.setStride(2);
+  seg.addSegmentPart(segPart_ch1);
+  seg.addSegmentPart(segPart_ch2);
+  seg.addSegmentPart(segPart_strided);
+
+  // slots are reserved up front, transitions never allocates
+  test(engine.transitionMemory(), 0);
+  engine.reserveTransitions(32);
+  uint32_t memory = engine.transitionMemory();
+  test(memory, FastLED_Action::MAX_TRANSITIONS * 32 * 2 * sizeof(CRGB));
+
+  seg.setTransitionTime(100);
+  ActionColor red(CRGB(200, 0, 0), 100),
+              blue(CRGB(0, 0, 200), 300);
+  seg.addAction(red);
+  seg.addAction(blue);
+  uint32_t time = millis();
+  while(seg.currentActionIdx() == 0 && millis() - time < 500) {
+    engine.update();
+    testDelay(1);
+  }
+  test(seg.currentActionIdx(), 1);
+  test(engine.inTransition(&seg), true);
+  test(segIs(seg, 0xC80000), true); // outgoing frame until next update
+
+  // blends over transition time, across reversed and strided parts
+  time = millis();
+  while(millis() - time < 50) {
+    engine.update();
+    testDelay(1);
+  }
+  test(segMixed(seg), true);
+  test(engine.stats().dirtyBlocks > 0, true);
+  while(millis() - time < 120) {
+    engine.update();
+    testDelay(1);
+  }
+  test(engine.inTransition(&seg), false);
+  test(segIs(seg, 0x0000C8), true);
+  test(leds_ch1[21].b, 0); // between strided leds
+  test(engine.transitionMemory(), memory);
+
+  // action overrides owner, switches at once
+  red.setTransitionTime(0);
+  while(seg.currentActionIdx() == 1 && millis() - time < 600) {
+    engine.update();
+    testDelay(1);
+  }
+  test(seg.currentActionIdx(), 0);
+  test(engine.inTransition(&seg), false);
+  engine.update();
+  test(segIs(seg, 0xC80000), true);
+  seg.removeAction(blue);
+  seg.removeAction(red);
+}
+
+void testEmitChanges(){
+  setAllBlack();
+
+  CLEDController
+    *cont_ch1 = &FastLED.addLeds<UCS1903, OUTPIN_CH1, BRG>(leds_ch1, NUMLEDS_CH1);
+  FastLED_Action engine;
+  Segment seg(&engine);
+  SegmentPart segPart_ch1(cont_ch1, 0, 20);
+  seg.addSegmentPart(segPart_ch1);
+
+  LastEmit emit;
+  test(emit.changed(5), true);
+  test(emit.changed(5), false);
+  test(emit.changed(6), true);
+  emit.invalidate();
+  test(emit.changed(6), true);
+
+  // slow fade between close colors only renders visible steps
+  ActionGotoColor slowFade(CRGB(10, 10, 10), CRGB(13, 13, 13), 400);
+  seg.addAction(slowFade);
+  engine.update();
+  test(cRgbToUInt(leds_ch1[0]), 0x0A0A0A);
+  engine.resetStats();
+  uint32_t time = millis();
+  while(millis() - time < 390) {
+    engine.update();
+    testDelay(1);
+  }
+  test(engine.stats().frames <= 3, true);
+  test(leds_ch1[5].r >= 12, true);
+  seg.removeAction(slowFade);
+
+  // same for eased tweens, from current color
+  ActionEaseInOut ease(CRGB(10, 10, 12), 0, 400);
+  seg.addAction(ease);
+  engine.update();
+  engine.resetStats();
+  time = millis();
+  while(millis() - time < 390) {
+    engine.update();
+    testDelay(1);
+  }
+  test(engine.stats().frames <= 4, true);
+  seg.removeAction(ease);
+
+  // a restarted tween writes again, even same color
+  ActionGotoColor same(CRGB(1, 2, 3), CRGB(1, 2, 3), 100);
+  seg.addAction(same);
+  engine.update();
+  test(cRgbToUInt(leds_ch1[3]), 0x010203);
+  leds_ch1[3] = CRGB::Black;
+  same.reset();
+  engine.update();
+  test(cRgbToUInt(leds_ch1[3]), 0x010203);
+  seg.removeAction(same);
+}
+
+// counts applies, value changes every 64 progress steps
+struct TweenSteps {
+  uint16_t applies;
+  TweenSteps() : applies(0) {}
+  void begin(SegmentCommon *owner) { (void)owner; }
+  void apply(SegmentCommon *owner, fract8 progress) {
+    (void)owner; (void)progress;
+    ++applies;
+  }
+  uint32_t value(fract8 progress) const { return progress >> 6; }
+};
+
+void testTickSchedule(){
+  setAllBlack();
+
+  CLEDController
+    *cont_ch1 = &FastLED.addLeds<UCS1903, OUTPIN_CH1, BRG>(leds_ch1, NUMLEDS_CH1);
+  FastLED_Action engine;
+  Segment seg(&engine);
+  SegmentPart segPart_ch1(cont_ch1, 0, 40);
+  seg.addSegmentPart(segPart_ch1);
+  test(engine.frameTime(), 10);
+
+  // ticks only when value changes, 3 times in between
+  ActionTween<TweenSteps> steps(TweenSteps(), 600);
+  seg.addAction(steps);
+  engine.update();
+  test(steps.interp().applies, 1);
+  // next change is at progress 64
+  uint32_t wake = steps.nextTickTime() - steps.startTime();
+  test(wake >= 150 && wake <= 152, true);
+  uint32_t time = millis();
+  while(millis() - time < 580) {
+    engine.update();
+    testDelay(1);
+  }
+  test(steps.interp().applies >= 3 && steps.interp().applies <= 4, true);
+  seg.removeAction(steps);
+
+  // close colors, wakes at next visible step, not each 30ms
+  ActionGotoColor fade(CRGB(10, 10, 10), CRGB(12, 12, 12), 3000);
+  seg.addAction(fade);
+  engine.update();
+  wake = fade.nextTickTime() - fade.startTime();
+  test(wake > 1000, true);
+  seg.removeAction(fade);
+
+  // never sooner than frame time
+  ActionGotoColor fast(CRGB::Black, CRGB::White, 100);
+  seg.addAction(fast);
+  engine.update();
+  test(fast.nextTickTime() - millis() >= engine.frameTime(), true);
+  seg.removeAction(fast);
+
+  // frame time is per instance
+  FastLED_Action slow;
+  slow.setFrameTime(50);
+  test(engine.frameTime(), 10);
+  Segment slowSeg(&slow);
+  SegmentPart slowPart_ch1(cont_ch1, 45, 5);
+  slowSeg.addSegmentPart(slowPart_ch1);
+  ActionGotoColor slowFast(CRGB::Black, CRGB::White, 100);
+  slowSeg.addAction(slowFast);
+  slow.update();
+  test(slowFast.nextTickTime() - millis() >= 50, true);
+  slowSeg.removeAction(slowFast);
+
+  // fast snake, 40 leds in 100ms, lands on each led in time and leaves
+  // no trail when it passes several leds each frame
+  ActionSnake snake(CRGB::Black, CRGB::Red, false, false, 100);
+  snake.setSingleShot(true);
+  seg.addAction(snake);
+  engine.update();
+  test(cRgbToUInt(leds_ch1[0]), 0xFF0000);
+  time = millis();
+  bool trail = false;
+  while(millis() - time < 80) {
+    engine.update();
+    uint8_t lit = 0;
+    for (uint8_t i = 0; i < 40; ++i)
+      lit += leds_ch1[i].r > 0;
+    trail |= lit != 1;
+    testDelay(1);
+  }
+  test(trail, false);
+  uint16_t at = 0;
+  for (uint8_t i = 0; i < 40; ++i)
+    if (leds_ch1[i].r > 0) at = i;
+  uint32_t expected = (millis() - snake.startTime()) * 39 / 100;
+  test(at + 4 >= expected && at <= expected, true);
+
+  // reversed, no division by zero on a single led
+  Segment one(&engine);
+  SegmentPart onePart(cont_ch1, 45, 1);
+  one.addSegmentPart(onePart);
+  ActionSnake tiny(CRGB::Black, CRGB::Blue, true, false, 50);
+  one.addAction(tiny);
+  engine.update();
+  test(cRgbToUInt(leds_ch1[45]), 0x0000FF);
+  one.removeAction(tiny);
+
+  // ladder on a single led is left color, rounded steps otherwise
+  ActionColorLadder oneLadder(CRGB::Red, CRGB::Blue, 0);
+  one.addAction(oneLadder);
+  engine.update();
+  test(cRgbToUInt(leds_ch1[45]), 0xFF0000);
+  one.removeAction(oneLadder);
+  seg.removeAction(snake);
+  ActionColorLadder ladder(CRGB::Black, CRGB(0xFF, 0x80, 0), 0);
+  seg.addAction(ladder);
+  engine.update();
+  test(cRgbToUInt(leds_ch1[0]), 0x000000);
+  test(cRgbToUInt(leds_ch1[13]), 0x552B00); // 85, 42.7 rounds up
+  test(cRgbToUInt(leds_ch1[39]), 0xFF8000);
+  seg.removeAction(ladder);
+}
+
+void testMemory(){
+  setAllBlack();
+
+  CLEDController
+    *cont_ch1 = &FastLED.addLeds<UCS1903, OUTPIN_CH1, BRG>(leds_ch1, NUMLEDS_CH1);
+  uint32_t before[MemoryStats::PoolCount];
+  for (uint8_t i = 0; i < MemoryStats::PoolCount; ++i)
+    before[i] = MemoryStats::current((MemoryStats::Pool)i);
+  uint32_t allocations = MemoryStats::allocations();
+  MemoryStats::resetHighWater();
+  test(MemoryStats::totalHighWater(), MemoryStats::total());
+
+  {
+    FastLED_Action engine;
+    Segment seg(&engine);
+    SegmentPart part1(cont_ch1, 0, 20), part2(cont_ch1, 30, 20);
+    seg.addSegmentPart(part1);
+    seg.addSegmentPart(part2);
+    // engine list and parts list
+    test(MemoryStats::current(MemoryStats::Lists) - before[MemoryStats::Lists],
+         3 * MemoryStats::LIST_NODE);
+
+    ActionParticles particles(10);
+    test(MemoryStats::current(MemoryStats::Actions) - before[MemoryStats::Actions],
+         10 * (2 * sizeof(int32_t) + sizeof(CRGB) + sizeof(uint16_t)));
+    seg.addAction(particles);
+    test(MemoryStats::current(MemoryStats::Lists) - before[MemoryStats::Lists],
+         4 * MemoryStats::LIST_NODE);
+
+    seg.setLed(3, CRGB::Red); // compiles layout, allocates dirty blocks
+    engine.update();
+    test(MemoryStats::current(MemoryStats::Layout) > before[MemoryStats::Layout], true);
+    test(MemoryStats::current(MemoryStats::Engine) > before[MemoryStats::Engine], true);
+
+    engine.reserveTransitions(40);
+    test(MemoryStats::current(MemoryStats::Frames) - before[MemoryStats::Frames],
+         engine.transitionMemory());
+
+    {
+      int16_t samples[64] = { 0 };
+      MemorySampleSource mem(samples, 64);
+      AudioAnalyzer analyzer(mem, 8000, 7, 8);
+      test(MemoryStats::current(MemoryStats::Audio) - before[MemoryStats::Audio],
+           analyzer.memoryUsage());
+    }
+    test(MemoryStats::current(MemoryStats::Audio), before[MemoryStats::Audio]);
+    // still counted as high water
+    test(MemoryStats::highWater(MemoryStats::Audio) > before[MemoryStats::Audio], true);
+
+    seg.removeAction(particles);
+    test(MemoryStats::current(MemoryStats::Lists) - before[MemoryStats::Lists],
+         3 * MemoryStats::LIST_NODE);
+    MemoryStats::dump(Serial);
+  }
+
+  // everything freed again
+  for (uint8_t i = 0; i < MemoryStats::PoolCount; ++i)
+    test(MemoryStats::current((MemoryStats::Pool)i), before[i]);
+  test(MemoryStats::totalHighWater() > MemoryStats::total(), true);
+  test(MemoryStats::allocations() > allocations, true);
+  test(MemoryStats::frees() > 0, true);
+  MemoryStats::resetHighWater();
+  test(MemoryStats::highWater(MemoryStats::Frames), before[MemoryStats::Frames]);
+  test(strcmp(MemoryStats::name(MemoryStats::Layout), "layout"), 0);
+  MemoryStats::dumpSizes(Serial);
+}
+
+void testChurn(){
+  FastLED_Action engine;
+  Segment seg(&engine);
+  ActionWait wait1(1000), wait2(1000), wait3(1000);
+
+  // action added twice is removed both times, next one not skipped
+  seg.addAction(wait1);
+  seg.addAction(wait2);
+  seg.addAction(wait2);
+  seg.addAction(wait3);
+  seg.setCurrentActionIdx(3);
+  seg.removeAction(wait2);
+  test(seg.actionsSize(), 2);
+  test(seg.currentAction() == &wait3, true);
+  test(seg.currentActionIdx(), 1);
+  // not in list, nothing happens
+  seg.removeAction(wait2);
+  test(seg.actionsSize(), 2);
+  seg.removeAction(wait1);
+  test(seg.actionsSize(), 1);
+  test(seg.currentAction() == &wait3, true);
+  seg.removeActionByIdx(5);
+  test(seg.actionsSize(), 1);
+  seg.removeAction(wait3);
+  test(seg.actionsSize(), 0);
+  test(seg.currentAction() == nullptr, true);
+
+  // compound gives all its segments back to engine
+  Segment seg1(&engine), seg2(&engine), seg3(&engine);
+  {
+    SegmentCompound comp(&engine);
+    comp.addSegment(seg1);
+    comp.addSegment(seg2);
+    comp.addSegment(seg3);
+    test(engine.isAttached(&seg2), false);
+    comp.removeSegment(seg2);
+    test(comp.segmentSize(), 2);
+    test(engine.isAttached(&seg2), true);
+  }
+  test(engine.isAttached(&seg1), true);
+  test(engine.isAttached(&seg3), true);
+}
+
+struct GatherWalk {
+  CRGB *leds[62];
+  uint8_t runs;
+};
+
+void collectLeds(const LedRun &run, uint16_t logicalIdx, void *ctx){
+  GatherWalk *walk = static_cast<GatherWalk*>(ctx);
+  ++walk->runs;
+  for (uint16_t i = 0; i < run.size && logicalIdx + i < 62; ++i)
+    walk->leds[logicalIdx + i] = &run[i];
+}
+
+void testGather(){
+  setAllBlack();
+
+  CLEDController
+    *cont_ch1 = &FastLED.addLeds<UCS1903, OUTPIN_CH1, BRG>(leds_ch1, NUMLEDS_CH1),
+    *cont_ch2 = &FastLED.addLeds<UCS1903, OUTPIN_CH2, BRG>(leds_ch2, NUMLEDS_CH2);
+  uint32_t layoutBefore = MemoryStats::current(MemoryStats::Layout);
+  FastLED_Action engine;
+  {
+    // every third led is one run
+    GatherSegment seg(&engine);
+    test(seg.type(), SegmentCommon::T_Gather);
+    test(seg.isSegment(), true);
+    test(seg.addRange(cont_ch1, 0, 50, 3), true);
+    test(seg.rangeCount(), 1);
+    test(seg.size(), 50);
+    test(seg[1] == &leds_ch1[3], true);
+    test(seg[49] == &leds_ch1[147], true);
+    test(seg[50] == nullptr, true);
+    uint8_t runs = 0;
+    seg.forEachRun([](const LedRun &run, uint16_t, void *ctx) {
+      ++*static_cast<uint8_t*>(ctx);
+      run.fill(CRGB::Red);
+    }, &runs);
+    test(runs, 1);
+    test(cRgbToUInt(leds_ch1[3]), 0xFF0000);
+    test(cRgbToUInt(leds_ch1[4]), 0);
+
+    // arbitrary points are a list of deltas, outside is skipped
+    uint16_t points[] = { 5, 9, 20, 21, 22, 40, 7, 500 };
+    test(seg.addIndices(cont_ch2, points, 8), true);
+    test(seg.rangeCount(), 1);
+    test(seg.listCount(), 1);
+    test(seg.size(), 57);
+    test(seg[50] == &leds_ch2[5], true);
+    test(seg[51] == &leds_ch2[9], true);
+    test(seg[54] == &leds_ch2[22], true);
+    test(seg[56] == &leds_ch2[7], true);
+    test(seg.memoryUsage() > 0 && seg.memoryUsage() <= 32, true);
+    test(seg.addIndices(nullptr, points, 8), false);
+
+    // actions and setLed marks only gathered leds changed
+    ActionColor color(CRGB::Blue, 0);
+    seg.addAction(color);
+    engine.update();
+    test(cRgbToUInt(leds_ch2[21]), 0x0000FF);
+    test(cRgbToUInt(leds_ch2[23]), 0);
+    test(cRgbToUInt(leds_ch1[6]), 0x0000FF);
+    seg.removeAction(color);
+    engine.update();
+    engine.resetStats();
+    seg.setLed(56, CRGB::Green);
+    test(engine.ledControllerHasChanges(cont_ch2, 0, 16), true);
+    test(engine.ledControllerHasChanges(cont_ch2, 32, 16), false);
+    engine.update();
+    test(cRgbToUInt(leds_ch2[7]), 0x008000);
+
+    // far leds are escaped, runs and seg[] agree however segment is read
+    uint16_t far[] = { 149, 2, 3, 4, 5 };
+    uint16_t before = seg.memoryUsage();
+    test(seg.addIndices(cont_ch1, far, 5), true);
+    test(seg.listCount(), 2);
+    test(seg.size(), 62);
+    test(seg[57] == &leds_ch1[149], true);
+    test(seg[58] == &leds_ch1[2], true);
+    test(seg[61] == &leds_ch1[5], true);
+    test(seg.memoryUsage() - before < 30, true);
+    for (uint8_t mode = 0; mode < 4; ++mode) {
+      seg.setReversed(mode & 1);
+      seg.setOffset(mode & 2 ? 55 : 0);
+      GatherWalk walk = GatherWalk();
+      test(seg.forEachRun(collectLeds, &walk), 62);
+      if (mode == 0)
+        test(walk.runs, 6); // range, 5 9, 20 21 22, 40 7, 149 2, 3 4 5
+      for (uint16_t i = 0; i < 62; ++i)
+        test(seg[i] == walk.leds[i], true);
+      for (uint16_t i = 62; i > 0; --i)
+        test(seg[i -1] == walk.leds[i -1], true);
+    }
+    seg.setOffset(0);
+
+    // reversed and parts, parts comes first
+    seg.setReversed(true);
+    test(seg[0] == &leds_ch1[5], true);
+    seg.setReversed(false);
+    SegmentPart part(cont_ch2, 50, 5);
+    seg.addSegmentPart(part);
+    test(seg.size(), 67);
+    test(seg[0] == &leds_ch2[50], true);
+    test(seg[5] == &leds_ch1[0], true);
+    test(MemoryStats::current(MemoryStats::Layout) > layoutBefore, true);
+
+    seg.clear();
+    test(seg.size(), 5);
+    test(seg.rangeCount(), 0);
+  }
+  test(MemoryStats::current(MemoryStats::Layout), layoutBefore);
+}
+
 void runTests(){
   testBegin();
 
@@ -516,6 +2752,31 @@ void runTests(){
   testSegmentManyChannels();
   testCompound();
   testActions();
+  testEngineInstances();
+  testTween();
+  testEasing();
+  testTimeline();
+  testPlayback();
+  testRecorder();
+  testNetworkStream();
+  testOutputCorrection();
+  testBrightness();
+  testPowerLimit();
+  testIndexed();
+  testMirror();
+  testLayout();
+  testMatrix();
+  testFilters();
+  testParticles();
+  testNoise();
+  testAudio();
+  testTwinkle();
+  testTransition();
+  testEmitChanges();
+  testTickSchedule();
+  testMemory();
+  testChurn();
+  testGather();
   testEnd();
 }
 